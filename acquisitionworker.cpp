@@ -0,0 +1,320 @@
+#include "acquisitionworker.h"
+#include <chrono>
+
+AcquisitionWorker::AcquisitionWorker(std::size_t queueCapacity) :
+    frames(queueCapacity),
+    stream(StreamCapacity)
+{
+}
+
+AcquisitionWorker::~AcquisitionWorker() {
+    stop();
+}
+
+void AcquisitionWorker::start(SpectrometerDevice* spectrometer, FramesReadyCallback framesReady,
+                              FrameRecorder* frameRecorder) {
+    stop();
+
+    device = spectrometer;
+    recorder = frameRecorder;
+    framesReadyCallback = std::move(framesReady);
+    stream.clear();
+    synchronizer.reset();
+    nextSequence = 0;
+    accountedDiscardedBytes = 0;
+    timing.reset();
+    {
+        std::lock_guard<std::mutex> lock(timingMutex);
+        publishedTiming = FrameTimingStats{};
+    }
+    framesLost.store(0, std::memory_order_relaxed);
+    framesShed.store(0, std::memory_order_relaxed);
+    framesBacklogged.store(0, std::memory_order_relaxed);
+    framesDropped.store(0, std::memory_order_relaxed);
+    framesParsed.store(0, std::memory_order_relaxed);
+    framesDiscardedPastLimit.store(0, std::memory_order_relaxed);
+    readBytes.store(0, std::memory_order_relaxed);
+    notifyPending.store(false, std::memory_order_relaxed);
+    limitReached.store(false, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+    if (backlog) {
+        while (backlog->front() != nullptr) {
+            backlog->popFront();
+        }
+    }
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&AcquisitionWorker::run, this);
+}
+
+void AcquisitionWorker::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    stopRequested.store(true, std::memory_order_release);
+    device->cancelWait();
+    thread.join();
+
+    running.store(false, std::memory_order_release);
+}
+
+void AcquisitionWorker::setExposureTime(uint32_t exposureTime) {
+    std::lock_guard<std::mutex> lock(exposureMutex);
+    exposureChangePending.store(false, std::memory_order_relaxed);
+    currentExposure.store(exposureTime, std::memory_order_relaxed);
+}
+
+void AcquisitionWorker::changeExposureTime(uint32_t exposureTime, int64_t appliedAtNs) {
+    std::lock_guard<std::mutex> lock(exposureMutex);
+    pendingExposure = exposureTime;
+    pendingExposureFromNs = appliedAtNs + static_cast<int64_t>(exposureTime) * 1000;
+    exposureChangePending.store(true, std::memory_order_release);
+}
+
+uint32_t AcquisitionWorker::exposureFor(int64_t timestampNs) {
+    if (exposureChangePending.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(exposureMutex);
+        if (exposureChangePending.load(std::memory_order_relaxed) && timestampNs >= pendingExposureFromNs) {
+            currentExposure.store(pendingExposure, std::memory_order_relaxed);
+            exposureChangePending.store(false, std::memory_order_relaxed);
+        }
+    }
+    return currentExposure.load(std::memory_order_relaxed);
+}
+
+const char* AcquisitionWorker::overloadPolicyName(OverloadPolicy policy) {
+    switch (policy) {
+    case OverloadPolicy::Lossless: return "lossless";
+    case OverloadPolicy::LatestOnly: return "latest only";
+    case OverloadPolicy::BoundedLatency: return "bounded latency";
+    }
+    return "unknown";
+}
+
+void AcquisitionWorker::setOverloadPolicy(OverloadPolicy overloadPolicy) {
+    policy.store(static_cast<int>(overloadPolicy), std::memory_order_relaxed);
+}
+
+AcquisitionWorker::OverloadPolicy AcquisitionWorker::overloadPolicy() const {
+    return static_cast<OverloadPolicy>(policy.load(std::memory_order_relaxed));
+}
+
+void AcquisitionWorker::setLatencyBudgetMs(int milliseconds) {
+    latencyBudgetNs.store(static_cast<int64_t>(milliseconds) * 1000000, std::memory_order_relaxed);
+}
+
+int AcquisitionWorker::latencyBudgetMs() const {
+    return static_cast<int>(latencyBudgetNs.load(std::memory_order_relaxed) / 1000000);
+}
+
+FrameTimingStats AcquisitionWorker::timingStats() const {
+    std::lock_guard<std::mutex> lock(timingMutex);
+    return publishedTiming;
+}
+
+void AcquisitionWorker::clearFrames() {
+    while (frames.front() != nullptr) {
+        frames.popFront();
+    }
+    // The backlog belongs to the worker until it has joined
+    if (!isRunning() && backlog) {
+        while (backlog->front() != nullptr) {
+            backlog->popFront();
+        }
+    }
+}
+
+void AcquisitionWorker::drainFrames(const FrameConsumer& ingest, const FrameConsumer& present) {
+    // Only frames already queued count, so the newest is known up front. The
+    // worker has joined once it is no longer running, so what it held back is
+    // safe to read and follows the queue.
+    const std::size_t queued = frames.size();
+    const std::size_t held = !isRunning() && backlog ? backlog->size() : 0;
+    const OverloadPolicy current = overloadPolicy();
+    const int64_t budgetNs = latencyBudgetNs.load(std::memory_order_relaxed);
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    uint64_t shed = 0;
+    const auto drain = [&](SpscQueue<SpectrumFrame>& queue, std::size_t count, bool last) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const SpectrumFrame* frame = queue.front();
+            if (frame == nullptr) {
+                break;
+            }
+            if (ingest) {
+                ingest(*frame);
+            }
+            if (present) {
+                const bool newest = last && i + 1 == count;
+                const bool keep = newest || current == OverloadPolicy::Lossless ||
+                                  (current == OverloadPolicy::BoundedLatency && nowNs - frame->timestampNs <= budgetNs);
+                if (keep) {
+                    present(*frame);
+                } else {
+                    ++shed;
+                }
+            }
+            queue.popFront();
+        }
+    };
+    drain(frames, queued, held == 0);
+    if (held > 0) {
+        drain(*backlog, held, true);
+    }
+    if (shed > 0) {
+        framesShed.fetch_add(shed, std::memory_order_relaxed);
+    }
+}
+
+void AcquisitionWorker::run() {
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        // Sleeps in the driver while the sensor is idle
+        const uint32_t bytesAvailable = device->waitForData(WaitTimeoutMs);
+        if (bytesAvailable == 0) {
+            // The backlog still moves while the sensor is idle
+            if (flushBacklog()) {
+                notifyConsumer();
+            }
+            continue;
+        }
+
+        // Read straight into the ring; parsing after each chunk frees the
+        // space the next chunk needs
+        uint32_t remaining = bytesAvailable;
+        while (remaining > 0) {
+            std::size_t contiguous = 0;
+            uint8_t* destination = stream.writeRegion(contiguous);
+            const auto chunk = static_cast<uint32_t>(std::min<std::size_t>(remaining, contiguous));
+            uint32_t bytesRead = 0;
+            if (chunk == 0 || !device->readData(destination, chunk, bytesRead) || bytesRead == 0) {
+                break;
+            }
+            stream.commitWrite(bytesRead);
+            readBytes.fetch_add(bytesRead, std::memory_order_relaxed);
+            remaining -= bytesRead;
+            parseFrames();
+        }
+    }
+}
+
+void AcquisitionWorker::parseFrames() {
+    bool locatedFrames = false;
+    bool pushedFrames = flushBacklog();
+
+    while (synchronizer.locateFrame(stream)) {
+        if (frameLimit > 0 && framesParsed.load(std::memory_order_relaxed) >= frameLimit) {
+            limitReached.store(true, std::memory_order_release);
+            framesDiscardedPastLimit.fetch_add(1, std::memory_order_relaxed);
+            stream.consume(SpectrumFrame::FrameBytes);
+            continue;
+        }
+        locatedFrames = true;
+
+        // Bytes skipped to regain the lock held frames that never arrived
+        // whole; skipping their sequence numbers leaves a gap where they were.
+        // Whatever precedes the first frame is just where the stream began.
+        const uint64_t discarded = synchronizer.bytesDiscarded() - accountedDiscardedBytes;
+        accountedDiscardedBytes += discarded;
+        if (discarded > 0 && nextSequence > 0) {
+            const uint64_t lost = (discarded + SpectrumFrame::FrameBytes / 2) / SpectrumFrame::FrameBytes;
+            nextSequence += lost;
+            framesLost.fetch_add(lost, std::memory_order_relaxed);
+        }
+
+        const int64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        timing.record(nextSequence, timestampNs);
+
+        // Decode in place from the ring into the consumer's slot, into the
+        // backlog when the queue is full under the lossless policy, or into a
+        // scratch frame when only the recorder will see it. Frames only join
+        // the queue behind the backlog, so they stay in order.
+        SpectrumFrame* slot = nullptr;
+        SpectrumFrame* held = nullptr;
+        if (framesReadyCallback) {
+            if (!backlog || backlog->front() == nullptr) {
+                slot = frames.beginPush();
+            }
+            if (slot == nullptr && overloadPolicy() == OverloadPolicy::Lossless) {
+                if (!backlog) {
+                    backlog = std::make_unique<SpscQueue<SpectrumFrame>>(BacklogCapacity);
+                }
+                held = backlog->beginPush();
+            }
+        }
+        SpectrumFrame* frame = slot != nullptr ? slot : held;
+        if (frame == nullptr && recorder != nullptr) {
+            frame = &recordOnlyFrame;
+        }
+        if (frame != nullptr) {
+            const SampleRange range = decodeFramePixels(stream.span(0, SpectrumFrame::FrameBytes), frame->pixels.data());
+            frame->minimum = range.minimum;
+            frame->maximum = range.maximum;
+            frame->sequence = nextSequence;
+            frame->timestampNs = timestampNs;
+            frame->exposureTime = exposureFor(timestampNs);
+            if (recorder != nullptr) {
+                recorder->submit(*frame);
+            }
+        }
+
+        framesParsed.fetch_add(1, std::memory_order_relaxed);
+        if (slot != nullptr) {
+            frames.commitPush();
+            pushedFrames = true;
+        } else if (held != nullptr) {
+            backlog->commitPush();
+            framesBacklogged.fetch_add(1, std::memory_order_relaxed);
+        } else if (framesReadyCallback) {
+            framesDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++nextSequence;
+        stream.consume(SpectrumFrame::FrameBytes);
+    }
+
+    if (locatedFrames) {
+        std::lock_guard<std::mutex> lock(timingMutex);
+        publishedTiming = timing.stats();
+    }
+
+    if (pushedFrames) {
+        notifyConsumer();
+    }
+}
+
+bool AcquisitionWorker::flushBacklog() {
+    if (!backlog || backlog->front() == nullptr) {
+        return false;
+    }
+
+    // Leaving the lossless policy lets go of the frames held back
+    if (overloadPolicy() != OverloadPolicy::Lossless) {
+        uint64_t dropped = 0;
+        for (; backlog->front() != nullptr; ++dropped) {
+            backlog->popFront();
+        }
+        framesDropped.fetch_add(dropped, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool moved = false;
+    while (const SpectrumFrame* held = backlog->front()) {
+        SpectrumFrame* slot = frames.beginPush();
+        if (slot == nullptr) {
+            break;
+        }
+        *slot = *held;
+        frames.commitPush();
+        backlog->popFront();
+        moved = true;
+    }
+    return moved;
+}
+
+void AcquisitionWorker::notifyConsumer() {
+    if (framesReadyCallback && !notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        framesReadyCallback();
+    }
+}
@@ -0,0 +1,170 @@
+#ifndef ACQUISITIONWORKER_H
+#define ACQUISITIONWORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "bytering.h"
+#include "framerecorder.h"
+#include "framesync.h"
+#include "frametiming.h"
+#include "spectrometerdevice.h"
+#include "spectrumframe.h"
+#include "spscqueue.h"
+
+// Drains a spectrometer's data channel on its own thread. The worker sleeps in
+// SpectrometerDevice::waitForData() while the sensor is idle, owns the byte
+// stream and frame parsing, and hands decoded frames to the GUI through a
+// single-producer/single-consumer queue.
+//
+// The consumer ingests every frame it takes off the queue; the overload
+// policy only decides which of them it also presents when it falls behind:
+//  - Lossless: every frame is presented. When the queue is full the worker
+//    holds frames back in a backlog of its own and moves them over as the
+//    consumer frees room, so reading the device never waits for the GUI.
+//  - LatestOnly: only the newest frame of each batch is presented, for live
+//    monitoring.
+//  - BoundedLatency: frames that have waited longer than the latency budget
+//    are shed from presentation, oldest first; the newest frame is always
+//    presented.
+// Under the last two a full queue drops the incoming frame, which the
+// consumer then never sees. The recorder sees every frame under all three.
+class AcquisitionWorker
+{
+public:
+    using FramesReadyCallback = std::function<void()>;
+    using FrameConsumer = std::function<void(const SpectrumFrame&)>;
+
+    enum class OverloadPolicy { Lossless, LatestOnly, BoundedLatency };
+
+    static constexpr int DefaultLatencyBudgetMs = 100;
+
+    static const char* overloadPolicyName(OverloadPolicy policy);
+
+    explicit AcquisitionWorker(std::size_t queueCapacity = 512);
+    ~AcquisitionWorker();
+
+    AcquisitionWorker(const AcquisitionWorker&) = delete;
+    AcquisitionWorker& operator=(const AcquisitionWorker&) = delete;
+
+    // framesReady is invoked from the worker thread when frames become
+    // available; it is not invoked again until the consumer has called
+    // acknowledgeFrames(), so at most one notification is in flight. When a
+    // recorder is given, every parsed frame is also submitted to it from the
+    // worker thread, including frames the GUI queue had no room for. Without
+    // a framesReady callback there is no consumer and the queue is bypassed.
+    void start(SpectrometerDevice* spectrometer, FramesReadyCallback framesReady,
+               FrameRecorder* frameRecorder = nullptr);
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Frames after the first `frames` of an acquisition are discarded
+    // unparsed; 0 means no limit. Takes effect at the next start().
+    void setFrameLimit(uint64_t frames) { frameLimit = frames; }
+    bool frameLimitReached() const { return limitReached.load(std::memory_order_acquire); }
+
+    // Exposure recorded with every frame parsed from now on
+    void setExposureTime(uint32_t exposureTime);
+
+    // The sensor acknowledged a new exposure at appliedAtNs (steady clock)
+    // while streaming. Frames parsed within one new exposure of that were
+    // already integrating under the old setting, so they keep its tag.
+    void changeExposureTime(uint32_t exposureTime, int64_t appliedAtNs);
+
+    // Both may change while acquiring
+    void setOverloadPolicy(OverloadPolicy policy);
+    OverloadPolicy overloadPolicy() const;
+    void setLatencyBudgetMs(int milliseconds);
+    int latencyBudgetMs() const;
+
+    // Consumer side, called from a single thread only.
+    void acknowledgeFrames() { notifyPending.store(false, std::memory_order_release); }
+    const SpectrumFrame* frontFrame() { return frames.front(); }
+    void popFrame() { frames.popFront(); }
+    // Also empties the backlog once the worker has stopped
+    void clearFrames();
+
+    // Hands every queued frame to `ingest` and the ones the overload policy
+    // keeps to `present`, oldest first, and pops them all; either may be
+    // empty. Frames pushed meanwhile wait for the next call. Once the worker
+    // has stopped, the frames it still held back follow.
+    void drainFrames(const FrameConsumer& ingest, const FrameConsumer& present);
+
+    uint64_t droppedFrames() const { return framesDropped.load(std::memory_order_relaxed); }
+    // Queued frames the consumer did not present under the overload policy
+    uint64_t shedFrames() const { return framesShed.load(std::memory_order_relaxed); }
+    // Frames held back while the queue was full under the lossless policy
+    uint64_t backlogFrames() const { return framesBacklogged.load(std::memory_order_relaxed); }
+    // Every frame located in the stream up to the frame limit, whether or not
+    // the queue took it; those after the limit are counted apart
+    uint64_t parsedFrames() const { return framesParsed.load(std::memory_order_relaxed); }
+    uint64_t framesPastLimit() const { return framesDiscardedPastLimit.load(std::memory_order_relaxed); }
+    uint64_t bytesRead() const { return readBytes.load(std::memory_order_relaxed); }
+    std::size_t queueDepth() const { return frames.size(); }
+    std::size_t queueCapacity() const { return frames.capacity(); }
+    const FrameSynchronizer& frameSync() const { return synchronizer; }
+
+    // Frames known to be lost in the stream: bytes discarded while regaining
+    // the sync lock, rounded to whole frames. Their sequence numbers are
+    // skipped, so the loss also shows in the frames themselves.
+    uint64_t lostFrames() const { return framesLost.load(std::memory_order_relaxed); }
+
+    // Rate, jitter and gaps of every frame parsed, whether or not the GUI
+    // queue had room for it; updated after each read from the device
+    FrameTimingStats timingStats() const;
+
+private:
+    void run();
+    void parseFrames();
+    bool flushBacklog();
+    void notifyConsumer();
+    uint32_t exposureFor(int64_t timestampNs);
+
+    static constexpr int WaitTimeoutMs = 100;
+    static constexpr std::size_t StreamCapacity = 1 << 20;
+    static constexpr std::size_t BacklogCapacity = 16384;
+
+    SpectrometerDevice* device = nullptr;
+    FrameRecorder* recorder = nullptr;
+    FramesReadyCallback framesReadyCallback;
+    std::thread thread;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> running{false};
+    std::atomic<bool> notifyPending{false};
+    std::atomic<bool> limitReached{false};
+    uint64_t frameLimit = 0;
+    std::atomic<uint64_t> framesDropped{0};
+    std::atomic<uint64_t> framesParsed{0};
+    std::atomic<uint64_t> framesDiscardedPastLimit{0};
+    std::atomic<uint64_t> readBytes{0};
+    std::atomic<uint64_t> framesLost{0};
+    std::atomic<uint64_t> framesShed{0};
+    std::atomic<uint64_t> framesBacklogged{0};
+    std::atomic<int> policy{static_cast<int>(OverloadPolicy::Lossless)};
+    std::atomic<int64_t> latencyBudgetNs{DefaultLatencyBudgetMs * 1000000LL};
+    std::atomic<uint32_t> currentExposure{0};
+
+    // Exposure change waiting for its first frame; the flag keeps the lock
+    // off the per-frame path when there is none
+    std::atomic<bool> exposureChangePending{false};
+    std::mutex exposureMutex;
+    uint32_t pendingExposure = 0;
+    int64_t pendingExposureFromNs = 0;
+    uint64_t nextSequence = 0;
+    uint64_t accountedDiscardedBytes = 0;
+    FrameTiming timing;
+    mutable std::mutex timingMutex;
+    FrameTimingStats publishedTiming;
+
+    SpscQueue<SpectrumFrame> frames;
+    SpectrumFrame recordOnlyFrame;
+    // Worker side only while running; allocated on the first full queue
+    std::unique_ptr<SpscQueue<SpectrumFrame>> backlog;
+    ByteRing stream;
+    FrameSynchronizer synchronizer;
+};
+
+#endif // ACQUISITIONWORKER_H
@@ -0,0 +1,34 @@
+#include "autorange.h"
+#include <algorithm>
+
+bool AutoRange::update(double minimum, double maximum) {
+    // A flat signal still gets a visible band around it
+    const double padding = std::max((maximum - minimum) * Margin, 1.0);
+    const double targetLower = minimum - padding;
+    const double targetUpper = maximum + padding;
+
+    bool resize = !valid || minimum < rangeLower || maximum > rangeUpper;
+    if (resize) {
+        framesBelowShrink = 0;
+    } else if (targetUpper - targetLower < (rangeUpper - rangeLower) * ShrinkFraction) {
+        resize = ++framesBelowShrink >= ShrinkFrames;
+    } else {
+        framesBelowShrink = 0;
+    }
+
+    if (!resize) {
+        return false;
+    }
+    valid = true;
+    rangeLower = targetLower;
+    rangeUpper = targetUpper;
+    framesBelowShrink = 0;
+    return true;
+}
+
+void AutoRange::reset() {
+    valid = false;
+    rangeLower = 0.0;
+    rangeUpper = 1.0;
+    framesBelowShrink = 0;
+}
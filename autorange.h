@@ -0,0 +1,30 @@
+#ifndef AUTORANGE_H
+#define AUTORANGE_H
+
+// Automatic axis range with hysteresis. The range grows as soon as the
+// signal leaves it, but only shrinks once the signal has used less than
+// ShrinkFraction of it for ShrinkFrames frames in a row, so a noisy trace
+// does not rescale the axis (and force a relayout) on every frame.
+class AutoRange
+{
+public:
+    static constexpr double Margin = 0.15;          // Padding added on each side, as a fraction of the signal span
+    static constexpr double ShrinkFraction = 0.5;
+    static constexpr int ShrinkFrames = 30;
+
+    // Returns true when lower() or upper() changed
+    bool update(double minimum, double maximum);
+    void reset();
+
+    bool isValid() const { return valid; }
+    double lower() const { return rangeLower; }
+    double upper() const { return rangeUpper; }
+
+private:
+    bool valid = false;
+    double rangeLower = 0.0;
+    double rangeUpper = 1.0;
+    int framesBelowShrink = 0;
+};
+
+#endif // AUTORANGE_H
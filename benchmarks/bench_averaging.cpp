@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <vector>
+#include "frameaverager.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+
+namespace {
+
+// What the average view used to do per frame: keep the last N point
+// vectors and re-add all of them for every pixel
+void BM_AverageLegacy(benchmark::State& state) {
+    const auto window = static_cast<std::size_t>(state.range(0));
+    const auto frames = SyntheticFrameGenerator(5).frames(64);
+    std::deque<std::vector<double>> lastFrames;
+    std::vector<double> average(SpectrumFrame::PixelCount);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        const auto& frame = frames[next++ % frames.size()];
+        if (lastFrames.size() >= window) {
+            lastFrames.pop_front();
+        }
+        lastFrames.emplace_back(frame.pixels.begin(), frame.pixels.end());
+        for (std::size_t i = 0; i < average.size(); ++i) {
+            double sum = 0;
+            for (const auto& stored : lastFrames) {
+                sum += stored[i];
+            }
+            average[i] = sum / static_cast<double>(lastFrames.size());
+        }
+        benchmark::DoNotOptimize(average.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AverageLegacy)->Arg(10)->Arg(100)->Arg(1000);
+
+// Add one frame and read the average back, as the average view does
+void BM_AverageSliding(benchmark::State& state) {
+    FrameAverager averager(static_cast<std::size_t>(state.range(0)));
+    const auto frames = SyntheticFrameGenerator(5).frames(64);
+    std::vector<float> average(SpectrumFrame::PixelCount);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        averager.add(frames[next++ % frames.size()]);
+        averager.average(average.data());
+        benchmark::DoNotOptimize(average.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AverageSliding)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+void BM_AverageExponential(benchmark::State& state) {
+    FrameAverager averager(static_cast<std::size_t>(state.range(0)), FrameAverager::Mode::Exponential);
+    const auto frames = SyntheticFrameGenerator(5).frames(64);
+    std::vector<float> average(SpectrumFrame::PixelCount);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        averager.add(frames[next++ % frames.size()]);
+        averager.average(average.data());
+        benchmark::DoNotOptimize(average.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AverageExponential)->Arg(10)->Arg(1000);
+
+} // namespace
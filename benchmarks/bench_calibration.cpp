@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "syntheticframes.h"
+#include "wavelengthcalibration.h"
+
+namespace {
+
+// Third-order calibration of a typical visible-range grating
+const std::vector<double> Coefficients{400.0, 0.3, -2.0e-5, 1.0e-9};
+
+struct AxisPoint {
+    double x;
+    double y;
+};
+
+// The x of every point from the calibration table, as the display builds them
+void BM_AxisFromTable(benchmark::State& state) {
+    const std::vector<float> values = SyntheticFrameGenerator(5).values();
+    WavelengthCalibration calibration;
+    calibration.setCoefficients(Coefficients);
+    std::vector<AxisPoint> points(values.size());
+    for (auto _ : state) {
+        const double* wavelengths = calibration.table(SpectralUnit::Wavelength);
+        for (std::size_t pixel = 0; pixel < values.size(); ++pixel) {
+            points[pixel] = {wavelengths[pixel], values[pixel]};
+        }
+        benchmark::DoNotOptimize(points.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AxisFromTable);
+
+// The same with the polynomial evaluated per pixel and frame, which the
+// table replaces
+void BM_AxisFromPolynomial(benchmark::State& state) {
+    const std::vector<float> values = SyntheticFrameGenerator(5).values();
+    std::vector<AxisPoint> points(values.size());
+    for (auto _ : state) {
+        for (std::size_t pixel = 0; pixel < values.size(); ++pixel) {
+            double wavelength = 0.0;
+            for (auto c = Coefficients.rbegin(); c != Coefficients.rend(); ++c) {
+                wavelength = wavelength * static_cast<double>(pixel) + *c;
+            }
+            points[pixel] = {wavelength, values[pixel]};
+        }
+        benchmark::DoNotOptimize(points.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AxisFromPolynomial);
+
+// A range given in Raman shift mapped back to pixels
+void BM_RamanShiftToPixel(benchmark::State& state) {
+    WavelengthCalibration calibration;
+    calibration.setCoefficients(Coefficients);
+    calibration.setLaserWavelength(405.0);
+    double shift = 100.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calibration.pixelAt(shift, SpectralUnit::RamanShift));
+        shift = shift < 9000.0 ? shift + 37.0 : 100.0;
+    }
+}
+BENCHMARK(BM_RamanShiftToPixel);
+
+} // namespace
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <utility>
+#include <vector>
+#include "spectrumcorrection.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+
+namespace {
+
+// The decode loop processFrame() used to run: two bytes at a time into a
+// double, a saturation check, a bounds-checked background lookup and a
+// point appended per pixel
+void BM_DecodeLegacy(benchmark::State& state) {
+    const auto wire = SyntheticFrameGenerator(11).wireFrame();
+    std::vector<std::pair<double, double>> background(SpectrumFrame::PixelCount, {0.0, 100.0});
+    std::vector<std::pair<double, double>> points;
+    for (auto _ : state) {
+        points.clear();
+        points.reserve(1024);
+        bool isSaturating = false;
+        for (int i = SpectrumFrame::HeaderBytes; i < SpectrumFrame::FrameBytes; i += 2) {
+            double value = (wire[i] << 8) | wire[i + 1];
+            if (value >= 65535) {
+                isSaturating = true;
+            }
+            value -= background.at((i / 2) - 2).second;
+            points.emplace_back((i / 2) - 2, value);
+        }
+        benchmark::DoNotOptimize(points.data());
+        benchmark::DoNotOptimize(isSaturating);
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DecodeLegacy);
+
+void BM_DecodeSamplesScalar(benchmark::State& state) {
+    const auto wire = SyntheticFrameGenerator(11).wireFrame();
+    SpectrumFrame frame;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeSamplesScalar(wire.data() + SpectrumFrame::HeaderBytes,
+                                                     SpectrumFrame::PixelCount, frame.pixels.data()));
+        benchmark::ClobberMemory();
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DecodeSamplesScalar);
+
+void BM_DecodeSamplesSimd(benchmark::State& state) {
+    const auto wire = SyntheticFrameGenerator(11).wireFrame();
+    SpectrumFrame frame;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeSamples(wire.data() + SpectrumFrame::HeaderBytes,
+                                               SpectrumFrame::PixelCount, frame.pixels.data()));
+        benchmark::ClobberMemory();
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DecodeSamplesSimd);
+
+// Both halves of the new path: decode with range on the acquisition thread,
+// then conversion and background subtraction for display
+void BM_DecodeAndCorrect(benchmark::State& state) {
+    const auto wire = SyntheticFrameGenerator(11).wireFrame();
+    const std::vector<float> background(SpectrumFrame::PixelCount, 100.0f);
+    SpectrumFrame frame;
+    std::vector<float> values(SpectrumFrame::PixelCount);
+    const bool scalar = state.range(0) == 0;
+    for (auto _ : state) {
+        if (scalar) {
+            decodeSamplesScalar(wire.data() + SpectrumFrame::HeaderBytes, SpectrumFrame::PixelCount, frame.pixels.data());
+            benchmark::DoNotOptimize(correctSpectrumScalar(frame.pixels.data(), background.data(), values.data(), values.size()));
+        } else {
+            decodeSamples(wire.data() + SpectrumFrame::HeaderBytes, SpectrumFrame::PixelCount, frame.pixels.data());
+            benchmark::DoNotOptimize(correctSpectrum(frame.pixels.data(), background.data(), values.data(), values.size()));
+        }
+        benchmark::ClobberMemory();
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DecodeAndCorrect)->ArgName("simd")->Arg(0)->Arg(1);
+
+} // namespace
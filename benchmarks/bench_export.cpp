@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <sstream>
+#include "dataexport.h"
+#include "framestore.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+
+namespace {
+
+constexpr std::size_t FramesPerExport = 256;
+
+const FrameStore& recording() {
+    static const FrameStore frames = [] {
+        FrameStore store;
+        SyntheticFrameGenerator generator(4);
+        for (std::size_t i = 0; i < FramesPerExport; ++i) {
+            store.append() = generator.frame();
+        }
+        return store;
+    }();
+    return frames;
+}
+
+void setExportCounters(benchmark::State& state, int64_t bytes) {
+    setPerFrameCounters(state, FramesPerExport);
+    state.SetBytesProcessed(bytes);
+}
+
+// Stream formatting, as the GUI thread used to do through QTextStream
+void BM_ExportCsvLegacy(benchmark::State& state) {
+    const FrameStore& frames = recording();
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        std::ostringstream out;
+        out << "Frame,Pixel,Intensity\n";
+        for (std::size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex) {
+            const SpectrumFrame& frame = frames[frameIndex];
+            for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+                out << frameIndex << "," << pixel << "," << frame.pixels[pixel] << "\n";
+            }
+        }
+        bytes += static_cast<int64_t>(out.tellp());
+        benchmark::DoNotOptimize(out);
+    }
+    setExportCounters(state, bytes);
+}
+BENCHMARK(BM_ExportCsvLegacy)->Unit(benchmark::kMillisecond);
+
+// The export job end to end, into /dev/null so the disk is left out
+void BM_Export(benchmark::State& state, ExportFormat format) {
+    ExportRequest request;
+    request.format = format;
+    request.includeSummary = false;
+    request.frames = &recording();
+    request.frameCount = FramesPerExport;
+    ExportJob job;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        job.start("/dev/null", request);
+        if (!job.wait()) {
+            state.SkipWithError(job.errorMessage().c_str());
+            break;
+        }
+        bytes += static_cast<int64_t>(job.bytesWritten());
+    }
+    setExportCounters(state, bytes);
+}
+BENCHMARK_CAPTURE(BM_Export, Csv, ExportFormat::Csv)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_Export, Json, ExportFormat::Json)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_Export, JsonColumnar, ExportFormat::JsonColumnar)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// .npy writes three files, so it goes to a real temporary file; with the
+// output in the page cache this is the memory-to-file copy rate
+void BM_ExportNpy(benchmark::State& state) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "lsv_bench_export.npy";
+    ExportRequest request;
+    request.format = ExportFormat::Npy;
+    request.frames = &recording();
+    request.frameCount = FramesPerExport;
+    ExportJob job;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        job.start(path, request);
+        if (!job.wait()) {
+            state.SkipWithError(job.errorMessage().c_str());
+            break;
+        }
+        bytes += static_cast<int64_t>(job.bytesWritten());
+    }
+    setExportCounters(state, bytes);
+
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    std::filesystem::remove(npySidecarPath(path, "timestamps"), ignored);
+    std::filesystem::remove(npySidecarPath(path, "exposure"), ignored);
+}
+BENCHMARK(BM_ExportNpy)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
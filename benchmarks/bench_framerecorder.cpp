@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <thread>
+#include "framerecorder.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+
+namespace {
+
+// Sustained throughput of the recording path: frames are submitted as fast
+// as the writer accepts them and the file is closed (final index block
+// written) inside the timed region
+void BM_FrameRecorder(benchmark::State& state) {
+    const auto frameCount = static_cast<uint64_t>(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() / "lsv_bench_recording.lsvrec";
+
+    SpectrumFrame frame = SyntheticFrameGenerator(8).frame();
+
+    FrameRecorder recorder;
+    uint64_t bytesWritten = 0;
+    for (auto _ : state) {
+        recorder.open(path);
+        for (uint64_t i = 0; i < frameCount; ++i) {
+            frame.sequence = i;
+            frame.timestampNs = static_cast<int64_t>(i) * 1000000;
+            while (!recorder.submit(frame)) {
+                std::this_thread::yield();
+            }
+        }
+        if (!recorder.close()) {
+            state.SkipWithError(recorder.errorMessage().c_str());
+            break;
+        }
+        bytesWritten += recorder.bytesWritten();
+    }
+
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(static_cast<int64_t>(bytesWritten));
+    setPerFrameCounters(state, static_cast<int64_t>(frameCount));
+}
+BENCHMARK(BM_FrameRecorder)->Arg(20000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
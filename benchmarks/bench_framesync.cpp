@@ -0,0 +1,131 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "framesync.h"
+#include "simulateddevice.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+
+namespace {
+
+// Payload-like bytes without a sync header anywhere, so every search scans
+// the whole buffer
+std::vector<uint8_t> makeHeaderFreeBytes(std::size_t size) {
+    std::vector<uint8_t> bytes(size);
+    std::minstd_rand rng(7);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(rng() % 4 == 0 ? 0 : rng());
+        if (byte == 1) {
+            byte = 2;
+        }
+    }
+    return bytes;
+}
+
+// Raw data-channel bytes from the simulated sensor, optionally corrupted
+std::vector<uint8_t> makeStream(int frames, double byteLossRate, double misalignmentRate) {
+    SimulationSettings settings;
+    settings.frameRate = 0.0;
+    settings.byteLossRate = byteLossRate;
+    settings.misalignmentRate = misalignmentRate;
+    SimulatedDevice device(settings);
+    device.open();
+    uint32_t triggerOn = 2;
+    device.writeCommand(&triggerOn, sizeof(triggerOn));
+
+    std::vector<uint8_t> stream;
+    stream.reserve(static_cast<std::size_t>(frames) * SpectrumFrame::FrameBytes * 11 / 10);
+    while (device.framesGenerated() < static_cast<uint64_t>(frames)) {
+        const uint32_t available = device.waitForData(100);
+        const std::size_t offset = stream.size();
+        stream.resize(offset + available);
+        uint32_t bytesRead = 0;
+        device.readData(stream.data() + offset, available, bytesRead);
+        stream.resize(offset + bytesRead);
+    }
+    return stream;
+}
+
+void BM_FindSyncPatternScalar(benchmark::State& state) {
+    const auto bytes = makeHeaderFreeBytes(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(findSyncPatternScalar(bytes.data(), bytes.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FindSyncPatternScalar)->Arg(SpectrumFrame::FrameBytes)->Arg(1 << 20);
+
+void BM_FindSyncPatternSimd(benchmark::State& state) {
+    const auto bytes = makeHeaderFreeBytes(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(findSyncPattern(bytes.data(), bytes.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FindSyncPatternSimd)->Arg(SpectrumFrame::FrameBytes)->Arg(1 << 20);
+
+// Feeds a recorded stream through the ring in USB-sized chunks and locks onto
+// every frame. Arguments are the injected byte loss and misalignment rates in
+// percent per frame.
+void BM_FrameSynchronizer(benchmark::State& state) {
+    constexpr int Frames = 2000;
+    constexpr std::size_t ChunkBytes = 64 * 1024;
+    const auto stream = makeStream(Frames, state.range(0) / 100.0, state.range(1) / 100.0);
+
+    ByteRing ring(1 << 20);
+    uint64_t framesLocated = 0;
+    uint64_t resyncs = 0;
+
+    for (auto _ : state) {
+        FrameSynchronizer synchronizer;
+        ring.clear();
+        std::size_t position = 0;
+        while (position < stream.size()) {
+            std::size_t contiguous = 0;
+            uint8_t* destination = ring.writeRegion(contiguous);
+            const std::size_t chunk = std::min({contiguous, ChunkBytes, stream.size() - position});
+            std::copy_n(stream.data() + position, chunk, destination);
+            ring.commitWrite(chunk);
+            position += chunk;
+
+            while (synchronizer.locateFrame(ring)) {
+                ring.consume(SpectrumFrame::FrameBytes);
+                ++framesLocated;
+            }
+        }
+        resyncs += synchronizer.resyncs();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+    setPerFrameCounters(state, static_cast<int64_t>(framesLocated / state.iterations()));
+    state.counters["resyncs"] = benchmark::Counter(static_cast<double>(resyncs), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FrameSynchronizer)->Args({0, 0})->Args({1, 1})->Args({10, 10});
+
+// The acquisition thread's per-frame work on a clean stream: lock onto each
+// frame in the ring and decode it in place
+void BM_SyncAndDecode(benchmark::State& state) {
+    constexpr std::size_t Frames = 256;
+    const auto stream = SyntheticFrameGenerator(6).wireStream(Frames);
+    ByteRing ring(1 << 20);
+    SpectrumFrame frame;
+
+    for (auto _ : state) {
+        FrameSynchronizer synchronizer;
+        ring.clear();
+        std::size_t contiguous = 0;
+        std::copy_n(stream.data(), stream.size(), ring.writeRegion(contiguous));
+        ring.commitWrite(stream.size());
+        while (synchronizer.locateFrame(ring)) {
+            benchmark::DoNotOptimize(decodeFramePixels(ring.span(0, SpectrumFrame::FrameBytes), frame.pixels.data()));
+            ring.consume(SpectrumFrame::FrameBytes);
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+    setPerFrameCounters(state, Frames);
+}
+BENCHMARK(BM_SyncAndDecode);
+
+} // namespace
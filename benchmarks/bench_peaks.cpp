@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "peakdetection.h"
+#include "syntheticframes.h"
+
+namespace {
+
+void BM_DetectPeaksRaw(benchmark::State& state) {
+    SyntheticFrameGenerator generator(5);
+    const std::vector<SpectrumFrame> frames = generator.frames(64);
+    const PeakDetectionSettings settings;
+    std::vector<SpectrumPeak> peaks;
+    std::size_t next = 0;
+    for (auto _ : state) {
+        const SpectrumFrame& frame = frames[next++ % frames.size()];
+        detectPeaks(frame.pixels.data(), frame.pixels.size(), 0, settings, peaks);
+        benchmark::DoNotOptimize(peaks.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DetectPeaksRaw);
+
+// Background-corrected values as the display analyses them, with centroids
+void BM_DetectPeaksCentroid(benchmark::State& state) {
+    const std::vector<float> values = SyntheticFrameGenerator(5).values();
+    PeakDetectionSettings settings;
+    settings.centre = PeakCentre::Centroid;
+    std::vector<SpectrumPeak> peaks;
+    for (auto _ : state) {
+        detectPeaks(values.data(), values.size(), 0, settings, peaks);
+        benchmark::DoNotOptimize(peaks.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DetectPeaksCentroid);
+
+} // namespace
@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <utility>
+#include <vector>
+#include "autorange.h"
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+#include "tracedecimation.h"
+
+namespace {
+
+// Full sensor onto a plot `columns` wide
+void BM_DecimateMinMax(benchmark::State& state) {
+    const auto values = SyntheticFrameGenerator(9).values();
+    const auto columns = static_cast<std::size_t>(state.range(0));
+    std::vector<float> minimums(columns);
+    std::vector<float> maximums(columns);
+    for (auto _ : state) {
+        decimateMinMax(values.data(), values.size(), 0.0, 0.0, static_cast<double>(values.size() - 1), columns,
+                       minimums.data(), maximums.data());
+        benchmark::DoNotOptimize(minimums.data());
+        benchmark::DoNotOptimize(maximums.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_DecimateMinMax)->Arg(320)->Arg(800);
+
+// (pixel, value) points standing in for the QPointF trace the view filters
+std::vector<std::pair<double, double>> makePoints() {
+    const auto values = SyntheticFrameGenerator(9).values();
+    std::vector<std::pair<double, double>> points(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        points[i] = {static_cast<double>(i), values[i]};
+    }
+    return points;
+}
+
+// What filterPointsByRange() used to do: test every point and append the
+// ones inside the range. Argument is the width of the range in pixels.
+void BM_RangeFilterLegacy(benchmark::State& state) {
+    const auto points = makePoints();
+    const double minimum = 100.0;
+    const double maximum = minimum + static_cast<double>(state.range(0));
+    std::vector<std::pair<double, double>> filtered;
+    for (auto _ : state) {
+        filtered = {};
+        for (const auto& point : points) {
+            if (point.first >= minimum && point.first <= maximum) {
+                filtered.push_back(point);
+            }
+        }
+        benchmark::DoNotOptimize(filtered.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_RangeFilterLegacy)->Arg(100)->Arg(900);
+
+// The range as one slice of the consecutive pixels
+void BM_RangeFilter(benchmark::State& state) {
+    const auto points = makePoints();
+    const double minimum = 100.0;
+    const double maximum = minimum + static_cast<double>(state.range(0));
+    std::vector<std::pair<double, double>> filtered;
+    for (auto _ : state) {
+        const SampleSpan span = visibleSamples(points.size(), points.front().first, minimum, maximum);
+        filtered.assign(points.begin() + static_cast<std::ptrdiff_t>(span.first),
+                        points.begin() + static_cast<std::ptrdiff_t>(span.first + span.count));
+        benchmark::DoNotOptimize(filtered.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_RangeFilter)->Arg(100)->Arg(900);
+
+// Noisy signal: the range should settle and stop changing
+void BM_AutoRange(benchmark::State& state) {
+    AutoRange range;
+    std::minstd_rand rng(2);
+    int64_t changes = 0;
+    for (auto _ : state) {
+        const double noise = rng() % 200;
+        changes += range.update(1000 + noise, 31000 - noise);
+    }
+    state.counters["changes"] = static_cast<double>(changes);
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_AutoRange);
+
+} // namespace
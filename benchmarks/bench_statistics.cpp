@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <vector>
+#include "spectrumframe.h"
+#include "spectrumstatistics.h"
+#include "syntheticframes.h"
+
+namespace {
+
+// What the display used to do per frame: three min/max/peak scans, then a
+// filtered copy, mean, variance and a full sort for the median
+void BM_StatisticsLegacy(benchmark::State& state) {
+    const auto samples = SyntheticFrameGenerator(3).samples();
+    const std::vector<double> values(samples.begin(), samples.end());
+    for (auto _ : state) {
+        for (int scan = 0; scan < 3; ++scan) {
+            double peak = 0;
+            double minimum = values[0];
+            double maximum = values[0];
+            for (double value : values) {
+                peak = std::max(peak, value);
+                minimum = std::min(minimum, value);
+                maximum = std::max(maximum, value);
+            }
+            benchmark::DoNotOptimize(peak + minimum + maximum);
+        }
+        std::vector<double> copy(values);
+        double sum = 0;
+        for (double value : copy) {
+            sum += value;
+        }
+        const double mean = sum / static_cast<double>(copy.size());
+        double squared = 0;
+        for (double value : copy) {
+            squared += (value - mean) * (value - mean);
+        }
+        std::sort(copy.begin(), copy.end());
+        benchmark::DoNotOptimize(squared + copy[copy.size() / 2]);
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_StatisticsLegacy);
+
+void BM_StatisticsFloat(benchmark::State& state) {
+    const auto samples = SyntheticFrameGenerator(3).samples();
+    const std::vector<float> values(samples.begin(), samples.end());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(computeStatistics(values.data(), values.size()));
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_StatisticsFloat);
+
+void BM_StatisticsRaw(benchmark::State& state) {
+    const auto samples = SyntheticFrameGenerator(3).samples();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(computeStatistics(samples.data(), samples.size()));
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_StatisticsRaw);
+
+} // namespace
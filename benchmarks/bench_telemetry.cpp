@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "pipelinetelemetry.h"
+
+namespace {
+
+// Latencies spread over several octaves, like the display path sees them
+std::vector<int64_t> makeLatencies() {
+    std::vector<int64_t> latencies(4096);
+    std::minstd_rand rng(5);
+    std::exponential_distribution<double> distribution(1.0 / 4e6);
+    for (auto& latency : latencies) {
+        latency = static_cast<int64_t>(distribution(rng));
+    }
+    return latencies;
+}
+
+// The per-frame cost of leaving the histogram on
+void BM_LatencyHistogramRecord(benchmark::State& state) {
+    const auto latencies = makeLatencies();
+    LatencyHistogram histogram;
+    std::size_t next = 0;
+    for (auto _ : state) {
+        histogram.record(latencies[next]);
+        next = (next + 1) & (latencies.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LatencyHistogramRecord);
+
+// What the GUI pays twice a second to refresh the panel
+void BM_TelemetryReport(benchmark::State& state) {
+    LatencyHistogram histogram;
+    for (int64_t latency : makeLatencies()) {
+        histogram.record(latency);
+    }
+    TelemetrySnapshot previous;
+    TelemetrySnapshot current;
+    current.timeNs = 500000000;
+    current.bytesRead = 1044000;
+    current.framesParsed = 500;
+    current.displayLatency = histogram.snapshot();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(formatTelemetryReport(current, &previous));
+    }
+}
+BENCHMARK(BM_TelemetryReport)->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "spectrumframe.h"
+#include "syntheticframes.h"
+#include "waterfallimage.h"
+
+namespace {
+
+// One colour-mapped row per frame; the cost must not depend on the depth
+void BM_WaterfallAddFrame(benchmark::State& state) {
+    WaterfallImage waterfall(static_cast<std::size_t>(state.range(0)));
+    const auto samples = SyntheticFrameGenerator(1).samples();
+    for (auto _ : state) {
+        waterfall.addFrame(samples.data());
+        benchmark::DoNotOptimize(waterfall.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_WaterfallAddFrame)->Arg(600)->Arg(8192);
+
+void BM_WaterfallAddFrameBackground(benchmark::State& state) {
+    WaterfallImage waterfall;
+    const auto samples = SyntheticFrameGenerator(1).samples();
+    const auto background = SyntheticFrameGenerator(2).samples();
+    for (auto _ : state) {
+        waterfall.addFrame(samples.data(), background.data());
+        benchmark::DoNotOptimize(waterfall.data());
+    }
+    setPerFrameCounters(state);
+}
+BENCHMARK(BM_WaterfallAddFrameBackground);
+
+void BM_WaterfallSetLevels(benchmark::State& state) {
+    WaterfallImage waterfall;
+    uint16_t black = 0;
+    for (auto _ : state) {
+        waterfall.setLevels(black, 40000);
+        black = static_cast<uint16_t>((black + 1) % 1000);
+    }
+}
+BENCHMARK(BM_WaterfallSetLevels);
+
+} // namespace
@@ -0,0 +1,134 @@
+#include "syntheticframes.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+struct EmissionLine {
+    double centre;     // Pixel
+    double amplitude;  // Counts above the baseline
+    double width;      // Standard deviation, pixels
+};
+
+constexpr EmissionLine Lines[] = {
+    {96.0, 1800.0, 6.0},
+    {231.5, 12000.0, 2.5},
+    {418.0, 4200.0, 12.0},
+    {520.3, 30000.0, 3.2},
+    {523.9, 9000.0, 2.8},
+    {767.0, 2500.0, 4.0},
+    {941.2, 16000.0, 1.8},
+};
+
+constexpr EmissionLine SaturatingLine{655.0, 90000.0, 3.0};
+
+constexpr double Baseline = 1000.0;
+constexpr double BaselineTilt = 300.0;  // Rise across the sensor
+constexpr double ReadNoise = 12.0;      // Counts rms
+constexpr double Gain = 4.0;            // Counts per photoelectron, for shot noise
+
+void addLine(std::vector<double>& profile, const EmissionLine& line) {
+    for (std::size_t pixel = 0; pixel < profile.size(); ++pixel) {
+        const double distance = (static_cast<double>(pixel) - line.centre) / line.width;
+        profile[pixel] += line.amplitude * std::exp(-0.5 * distance * distance);
+    }
+}
+
+} // namespace
+
+SyntheticFrameGenerator::SyntheticFrameGenerator(uint32_t seed) :
+    rng(seed),
+    profile(SpectrumFrame::PixelCount)
+{
+    setSaturating(false);
+}
+
+void SyntheticFrameGenerator::setSaturating(bool saturate) {
+    saturating = saturate;
+    for (std::size_t pixel = 0; pixel < profile.size(); ++pixel) {
+        profile[pixel] = Baseline + BaselineTilt * static_cast<double>(pixel) / static_cast<double>(profile.size());
+    }
+    for (const EmissionLine& line : Lines) {
+        addLine(profile, line);
+    }
+    if (saturating) {
+        addLine(profile, SaturatingLine);
+    }
+}
+
+void SyntheticFrameGenerator::fillSamples(uint16_t* pixels) {
+    std::normal_distribution<double> unit(0.0, 1.0);
+    for (std::size_t pixel = 0; pixel < profile.size(); ++pixel) {
+        const double signal = profile[pixel] - Baseline;
+        const double sigma = std::sqrt(ReadNoise * ReadNoise + Gain * std::max(0.0, signal));
+        const double value = std::round(profile[pixel] + sigma * unit(rng));
+        pixels[pixel] = static_cast<uint16_t>(std::clamp(value, 0.0, 65535.0));
+    }
+}
+
+std::vector<uint16_t> SyntheticFrameGenerator::samples() {
+    std::vector<uint16_t> pixels(SpectrumFrame::PixelCount);
+    fillSamples(pixels.data());
+    return pixels;
+}
+
+std::vector<float> SyntheticFrameGenerator::values() {
+    const std::vector<uint16_t> pixels = samples();
+    return std::vector<float>(pixels.begin(), pixels.end());
+}
+
+SpectrumFrame SyntheticFrameGenerator::frame() {
+    SpectrumFrame frame;
+    fillSamples(frame.pixels.data());
+    const SampleRange range = measureSampleRange(frame.pixels.data(), frame.pixels.size());
+    frame.minimum = range.minimum;
+    frame.maximum = range.maximum;
+    frame.sequence = nextSequence;
+    frame.timestampNs = static_cast<int64_t>(nextSequence * 1e9 / ReferenceFrameRate);
+    frame.exposureTime = 1000;
+    ++nextSequence;
+    return frame;
+}
+
+std::vector<SpectrumFrame> SyntheticFrameGenerator::frames(std::size_t count) {
+    std::vector<SpectrumFrame> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        result.push_back(frame());
+    }
+    return result;
+}
+
+std::vector<uint8_t> SyntheticFrameGenerator::wireFrame() {
+    std::vector<uint8_t> bytes;
+    appendWireFrame(bytes);
+    return bytes;
+}
+
+std::vector<uint8_t> SyntheticFrameGenerator::wireStream(std::size_t count) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(count * SpectrumFrame::FrameBytes);
+    for (std::size_t i = 0; i < count; ++i) {
+        appendWireFrame(bytes);
+    }
+    return bytes;
+}
+
+void SyntheticFrameGenerator::appendWireFrame(std::vector<uint8_t>& bytes) {
+    std::array<uint16_t, SpectrumFrame::PixelCount> pixels;
+    fillSamples(pixels.data());
+    bytes.insert(bytes.end(), {0x00, 0x00, 0x00, 0x01});
+    for (const uint16_t sample : pixels) {
+        bytes.push_back(static_cast<uint8_t>(sample >> 8));
+        bytes.push_back(static_cast<uint8_t>(sample & 0xFF));
+    }
+}
+
+void setPerFrameCounters(benchmark::State& state, int64_t framesPerIteration) {
+    const auto frames = static_cast<double>(state.iterations() * framesPerIteration);
+    state.counters["frames/s"] = benchmark::Counter(frames, benchmark::Counter::kIsRate);
+    state.counters["ns/frame"] = benchmark::Counter(frames, benchmark::Counter::kIsRate | benchmark::Counter::kInvert,
+                                                    benchmark::Counter::kIs1000);
+    state.counters["headroom"] = benchmark::Counter(frames / ReferenceFrameRate, benchmark::Counter::kIsRate);
+}
@@ -0,0 +1,53 @@
+#ifndef SYNTHETICFRAMES_H
+#define SYNTHETICFRAMES_H
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "spectrumframe.h"
+
+// Sensor data for the benchmarks: a dark baseline with a slow tilt, a few
+// Gaussian emission lines of different widths, shot noise on the signal and
+// read noise on every pixel. Each frame is a fresh noise realisation of the
+// same spectrum, so value-dependent code (peak search, sorting, saturation
+// checks) sees input shaped like a real acquisition.
+class SyntheticFrameGenerator
+{
+public:
+    explicit SyntheticFrameGenerator(uint32_t seed = 1);
+
+    // Adds one line that clips at full scale, for saturation paths
+    void setSaturating(bool saturating);
+
+    void fillSamples(uint16_t* pixels);
+    std::vector<uint16_t> samples();
+    std::vector<float> values();
+
+    // Decoded, with sequence, timestamp and sample range filled in
+    SpectrumFrame frame();
+    std::vector<SpectrumFrame> frames(std::size_t count);
+
+    // 2088 bytes as the data channel delivers them: the sync header and
+    // big-endian samples; a stream is frames back to back
+    std::vector<uint8_t> wireFrame();
+    std::vector<uint8_t> wireStream(std::size_t count);
+
+private:
+    void appendWireFrame(std::vector<uint8_t>& bytes);
+
+    std::mt19937 rng;
+    std::vector<double> profile;
+    bool saturating = false;
+    uint64_t nextSequence = 0;
+};
+
+// Sensor rate the headroom counter is measured against, frames/s
+constexpr double ReferenceFrameRate = 1000.0;
+
+// Reports ns/frame, frames/s and headroom, the seconds of sensor output at
+// ReferenceFrameRate the stage gets through per second, for
+// framesPerIteration frames per iteration
+void setPerFrameCounters(benchmark::State& state, int64_t framesPerIteration = 1);
+
+#endif // SYNTHETICFRAMES_H
@@ -0,0 +1,76 @@
+#include "bufferedfilewriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+BufferedFileWriter::BufferedFileWriter() :
+    buffer(new char[BufferBytes])
+{
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+    // Errors can't be reported from here; close() explicitly to see them
+    if (file.is_open()) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+void BufferedFileWriter::open(const std::filesystem::path& path) {
+    if (file.is_open()) {
+        close();
+    }
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+    used = 0;
+    flushedBytes = 0;
+}
+
+void BufferedFileWriter::close() {
+    flush();
+    file.close();
+    if (file.fail()) {
+        throw std::runtime_error("Closing the export file failed");
+    }
+}
+
+void BufferedFileWriter::write(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        if (used == BufferBytes) {
+            flush();
+        }
+        const std::size_t chunk = std::min(size, BufferBytes - used);
+        std::memcpy(buffer.get() + used, bytes, chunk);
+        used += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+}
+
+void BufferedFileWriter::writeNumber(double value) {
+    if (std::isfinite(value) && value == std::trunc(value) && std::fabs(value) < 9.0e15) {
+        writeInteger(static_cast<int64_t>(value));
+    } else {
+        writeFormatted(value);
+    }
+}
+
+void BufferedFileWriter::flush() {
+    if (used == 0) {
+        return;
+    }
+    file.write(buffer.get(), static_cast<std::streamsize>(used));
+    if (!file) {
+        used = 0;
+        throw std::runtime_error("Writing the export file failed (disk full?)");
+    }
+    flushedBytes += used;
+    used = 0;
+}
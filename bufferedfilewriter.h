@@ -0,0 +1,73 @@
+#ifndef BUFFEREDFILEWRITER_H
+#define BUFFEREDFILEWRITER_H
+
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string_view>
+
+// Text and binary output through one large buffer, for exports. Numbers are
+// formatted with std::to_chars straight into the buffer, with no locale or
+// stream state involved, and the file sees only BufferBytes-sized writes.
+class BufferedFileWriter
+{
+public:
+    static constexpr std::size_t BufferBytes = 4 * 1024 * 1024;
+
+    BufferedFileWriter();
+    ~BufferedFileWriter();
+
+    BufferedFileWriter(const BufferedFileWriter&) = delete;
+    BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+    // Both throw std::runtime_error on failure
+    void open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    void write(const void* data, std::size_t size);
+    void write(std::string_view text) { write(text.data(), text.size()); }
+    void write(char c)
+    {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    void writeInteger(int64_t value) { writeFormatted(value); }
+    void writeUnsigned(uint64_t value) { writeFormatted(value); }
+
+    // Integral values are written without a fractional part; anything else
+    // in the shortest form that reads back to the same double
+    void writeNumber(double value);
+
+    // Bytes handed to the writer so far, including those still buffered
+    uint64_t bytesWritten() const { return flushedBytes + used; }
+
+private:
+    static constexpr std::size_t MaxNumberChars = 32;
+
+    template <typename T>
+    void writeFormatted(T value)
+    {
+        reserve(MaxNumberChars);
+        char* end = std::to_chars(buffer.get() + used, buffer.get() + BufferBytes, value).ptr;
+        used = static_cast<std::size_t>(end - buffer.get());
+    }
+
+    void reserve(std::size_t size)
+    {
+        if (BufferBytes - used < size) {
+            flush();
+        }
+    }
+    void flush();
+
+    std::unique_ptr<char[]> buffer;
+    std::size_t used = 0;
+    uint64_t flushedBytes = 0;
+    std::ofstream file;
+};
+
+#endif // BUFFEREDFILEWRITER_H
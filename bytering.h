@@ -0,0 +1,83 @@
+#ifndef BYTERING_H
+#define BYTERING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// View of up to two contiguous pieces of a ByteRing. The second piece is
+// empty unless the viewed range wraps past the end of the ring's storage.
+struct RingSpan {
+    const uint8_t* first = nullptr;
+    std::size_t firstSize = 0;
+    const uint8_t* second = nullptr;
+    std::size_t secondSize = 0;
+
+    std::size_t size() const { return firstSize + secondSize; }
+    bool isContiguous() const { return secondSize == 0; }
+    uint8_t operator[](std::size_t index) const
+    {
+        return index < firstSize ? first[index] : second[index - firstSize];
+    }
+};
+
+// Fixed-capacity byte ring for the raw USB stream. The device reads straight
+// into writeRegion(), and frames are parsed in place through span() until
+// they are consume()d; nothing is shifted or reallocated after construction.
+// Not thread-safe: the acquisition thread owns both ends.
+class ByteRing
+{
+public:
+    explicit ByteRing(std::size_t minCapacity)
+    {
+        std::size_t capacity = 1;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        storage = std::make_unique<uint8_t[]>(capacity);
+        mask = capacity - 1;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+    std::size_t size() const { return writeCount - readCount; }
+    std::size_t freeSpace() const { return capacity() - size(); }
+    bool isEmpty() const { return writeCount == readCount; }
+
+    // Largest contiguous free block starting at the write position
+    uint8_t* writeRegion(std::size_t& contiguous)
+    {
+        const std::size_t writePos = writeCount & mask;
+        contiguous = std::min(freeSpace(), capacity() - writePos);
+        return storage.get() + writePos;
+    }
+
+    void commitWrite(std::size_t count) { writeCount += count; }
+
+    uint8_t at(std::size_t offset) const { return storage[(readCount + offset) & mask]; }
+
+    // Bytes [offset, offset + length) past the read position, without copying
+    RingSpan span(std::size_t offset, std::size_t length) const
+    {
+        RingSpan view;
+        const std::size_t start = (readCount + offset) & mask;
+        const std::size_t untilEnd = capacity() - start;
+        view.first = storage.get() + start;
+        view.firstSize = std::min(length, untilEnd);
+        view.second = storage.get();
+        view.secondSize = length - view.firstSize;
+        return view;
+    }
+
+    void consume(std::size_t count) { readCount += count; }
+
+    void clear() { readCount = writeCount = 0; }
+
+private:
+    std::unique_ptr<uint8_t[]> storage;
+    std::size_t mask = 0;
+    std::size_t readCount = 0;
+    std::size_t writeCount = 0;
+};
+
+#endif // BYTERING_H
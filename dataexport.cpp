@@ -0,0 +1,476 @@
+#include "dataexport.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// NumPy records the byte order; samples are written as they sit in memory
+char nativeByteOrder() {
+    const uint16_t one = 1;
+    uint8_t firstByte;
+    std::memcpy(&firstByte, &one, 1);
+    return firstByte == 1 ? '<' : '>';
+}
+
+// Version 1.0 .npy header, padded so the array data starts 64-byte aligned
+std::string npyHeader(const char* type, const std::string& shape) {
+    constexpr std::size_t PreambleBytes = 10;  // Magic, version and header length
+    std::string dictionary = std::string("{'descr': '") + nativeByteOrder() + type +
+                             "', 'fortran_order': False, 'shape': " + shape + ", }";
+    const std::size_t total = (PreambleBytes + dictionary.size() + 1 + 63) / 64 * 64;
+    dictionary.append(total - PreambleBytes - dictionary.size() - 1, ' ');
+    dictionary += '\n';
+
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header += static_cast<char>(dictionary.size() & 0xFF);
+    header += static_cast<char>(dictionary.size() >> 8);
+    return header + dictionary;
+}
+
+// What BufferedFileWriter::writeNumber() writes, for columns formatted once
+std::string numberText(double value) {
+    char text[32];
+    char* end;
+    if (std::isfinite(value) && value == std::trunc(value) && std::fabs(value) < 9.0e15) {
+        end = std::to_chars(text, text + sizeof(text), static_cast<int64_t>(value)).ptr;
+    } else {
+        end = std::to_chars(text, text + sizeof(text), value).ptr;
+    }
+    return std::string(text, end);
+}
+
+} // namespace
+
+std::filesystem::path npySidecarPath(const std::filesystem::path& path, const std::string& name) {
+    std::filesystem::path sidecar = path;
+    sidecar.replace_filename(path.stem().string() + "_" + name + ".npy");
+    return sidecar;
+}
+
+ExportJob::~ExportJob() {
+    cancel();
+    wait();
+}
+
+void ExportJob::start(const std::filesystem::path& path, ExportRequest request) {
+    if (isRunning()) {
+        throw std::runtime_error("An export is already running");
+    }
+    wait();
+
+    output.open(path);
+    filePath = path;
+    sidecarPaths.clear();
+    sidecarBaseBytes = 0;
+    job = std::move(request);
+    cancelRequested.store(false, std::memory_order_relaxed);
+    cancelled.store(false, std::memory_order_relaxed);
+    failed.store(false, std::memory_order_relaxed);
+    framesDone.store(0, std::memory_order_relaxed);
+    writtenBytes.store(0, std::memory_order_relaxed);
+    startNs.store(nowNs(), std::memory_order_relaxed);
+    endNs.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError.clear();
+    }
+
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&ExportJob::run, this);
+}
+
+bool ExportJob::wait() {
+    if (writer.joinable()) {
+        writer.join();
+    }
+    return !failed.load(std::memory_order_relaxed) && !cancelled.load(std::memory_order_relaxed);
+}
+
+double ExportJob::progress() const {
+    const uint64_t total = job.frames != nullptr ? job.frameCount : 0;
+    if (total == 0) {
+        return isRunning() ? 0.0 : 1.0;
+    }
+    return static_cast<double>(framesDone.load(std::memory_order_relaxed)) / static_cast<double>(total);
+}
+
+double ExportJob::elapsedSeconds() const {
+    const int64_t end = endNs.load(std::memory_order_relaxed);
+    return static_cast<double>((end != 0 ? end : nowNs()) - startNs.load(std::memory_order_relaxed)) / 1e9;
+}
+
+double ExportJob::megabytesPerSecond() const {
+    const double seconds = elapsedSeconds();
+    return seconds > 0.0 ? static_cast<double>(bytesWritten()) / 1e6 / seconds : 0.0;
+}
+
+std::string ExportJob::errorMessage() const {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return lastError;
+}
+
+void ExportJob::run() {
+    try {
+        switch (job.format) {
+        case ExportFormat::Csv:
+        case ExportFormat::Txt:
+            writeText();
+            break;
+        case ExportFormat::Json:
+            writeJson();
+            break;
+        case ExportFormat::JsonColumnar:
+            writeJsonColumnar();
+            break;
+        case ExportFormat::Npy:
+            writeNpy();
+            break;
+        }
+        output.close();
+        writtenBytes.store(sidecarBaseBytes + output.bytesWritten(), std::memory_order_relaxed);
+    } catch (const Cancelled&) {
+        cancelled.store(true, std::memory_order_relaxed);
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError = e.what();
+        failed.store(true, std::memory_order_relaxed);
+    }
+
+    // Don't leave a truncated file that looks like a complete export
+    if (cancelled.load(std::memory_order_relaxed) || failed.load(std::memory_order_relaxed)) {
+        try {
+            output.close();
+        } catch (...) {
+        }
+        std::error_code ignored;
+        std::filesystem::remove(filePath, ignored);
+        for (const std::filesystem::path& sidecar : sidecarPaths) {
+            std::filesystem::remove(sidecar, ignored);
+        }
+    }
+
+    endNs.store(nowNs(), std::memory_order_relaxed);
+    running.store(false, std::memory_order_release);
+}
+
+void ExportJob::finishFrame() {
+    framesDone.fetch_add(1, std::memory_order_relaxed);
+    writtenBytes.store(sidecarBaseBytes + output.bytesWritten(), std::memory_order_relaxed);
+    if (cancelRequested.load(std::memory_order_relaxed)) {
+        throw Cancelled{};
+    }
+}
+
+double ExportJob::axisValue(double pixel) const {
+    const auto index = static_cast<std::ptrdiff_t>(std::lround(pixel));
+    return job.axisValues[static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(index, 0, job.axisValues.size() - 1))];
+}
+
+void ExportJob::writeText() {
+    const char separator = job.format == ExportFormat::Csv ? ',' : '\t';
+    const std::string axisColumn = hasAxis() ? separator + std::string(spectralUnitTitle(job.axisUnit)) : std::string();
+
+    if (job.includeSummary) {
+        const SpectrumStatistics& stats = job.statistics;
+        output.write("Statistics:\n");
+        output.write("Mean");
+        output.write(separator);
+        output.writeNumber(stats.mean);
+        output.write("\nMedian");
+        output.write(separator);
+        output.writeNumber(stats.median);
+        output.write("\nVariance");
+        output.write(separator);
+        output.writeNumber(stats.variance);
+        output.write("\nStandard Deviation");
+        output.write(separator);
+        output.writeNumber(stats.stdDev);
+        output.write("\n\n");
+
+        output.write("Current Series Data:\nPixel");
+        output.write(axisColumn);
+        output.write(separator);
+        output.write("Intensity\n");
+        for (const ExportRequest::Point& point : job.currentSeries) {
+            output.writeNumber(point.pixel);
+            output.write(separator);
+            if (hasAxis()) {
+                output.writeNumber(axisValue(point.pixel));
+                output.write(separator);
+            }
+            output.writeNumber(point.intensity);
+            output.write('\n');
+        }
+    }
+
+    if (job.frames != nullptr && job.frameCount > 0) {
+        if (job.includeSummary) {
+            output.write("\nAll Recorded Frames:\n");
+        }
+        output.write("Frame");
+        output.write(separator);
+        output.write("Pixel");
+        output.write(axisColumn);
+        output.write(separator);
+        output.write("Intensity\n");
+        // Only the intensity changes from line to line within a frame, so
+        // the pixel and axis columns are formatted once up front
+        std::vector<std::string> pixelColumns(SpectrumFrame::PixelCount);
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            pixelColumns[pixel] = separator + std::to_string(pixel) + separator;
+            if (hasAxis()) {
+                pixelColumns[pixel] += numberText(job.axisValues[pixel]) + separator;
+            }
+        }
+        for (std::size_t frameIndex = 0; frameIndex < job.frameCount; ++frameIndex) {
+            const SpectrumFrame& frame = (*job.frames)[frameIndex];
+            const std::string frameColumn = std::to_string(frameIndex);
+            for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+                output.write(frameColumn);
+                output.write(pixelColumns[pixel]);
+                output.writeUnsigned(frame.pixels[pixel]);
+                output.write('\n');
+            }
+            finishFrame();
+        }
+    } else if (job.hasLastFrame) {
+        output.write("\nLast Recorded Frame:\nPixel");
+        output.write(axisColumn);
+        output.write(separator);
+        output.write("Intensity\n");
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            output.writeUnsigned(static_cast<uint64_t>(pixel));
+            output.write(separator);
+            if (hasAxis()) {
+                output.writeNumber(job.axisValues[pixel]);
+                output.write(separator);
+            }
+            output.writeUnsigned(job.lastFrame.pixels[pixel]);
+            output.write('\n');
+        }
+    }
+}
+
+void ExportJob::writeJsonNumber(double value) {
+    // JSON has no NaN or infinity
+    if (std::isfinite(value)) {
+        output.writeNumber(value);
+    } else {
+        output.write("null");
+    }
+}
+
+void ExportJob::writeJsonStatistics() {
+    const SpectrumStatistics& stats = job.statistics;
+    output.write("\"statistics\": {\"mean\": ");
+    writeJsonNumber(stats.mean);
+    output.write(", \"median\": ");
+    writeJsonNumber(stats.median);
+    output.write(", \"standardDeviation\": ");
+    writeJsonNumber(stats.stdDev);
+    output.write(", \"variance\": ");
+    writeJsonNumber(stats.variance);
+    output.write('}');
+}
+
+void ExportJob::writeJson() {
+    // Keys in the order QJsonDocument wrote them (sorted), one frame per
+    // line; the axis key sorts after "pixel" and is formatted once up front
+    std::vector<std::string> pixelKeys(SpectrumFrame::PixelCount);
+    const std::string axisKey = hasAxis() ? ", \"" + std::string(spectralUnitKey(job.axisUnit)) + "\": " : std::string();
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        pixelKeys[pixel] = ", \"pixel\": " + std::to_string(pixel);
+        if (hasAxis()) {
+            pixelKeys[pixel] += axisKey + numberText(job.axisValues[pixel]);
+        }
+        pixelKeys[pixel] += '}';
+    }
+    const auto writeFrame = [this, &pixelKeys](const SpectrumFrame& frame) {
+        output.write('[');
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            output.write(pixel == 0 ? "{\"intensity\": " : ", {\"intensity\": ");
+            output.writeUnsigned(frame.pixels[pixel]);
+            output.write(pixelKeys[pixel]);
+        }
+        output.write(']');
+    };
+
+    output.write('{');
+    if (job.frames != nullptr && job.frameCount > 0) {
+        output.write("\n\"allRecordedFrames\": [");
+        for (std::size_t frameIndex = 0; frameIndex < job.frameCount; ++frameIndex) {
+            output.write(frameIndex == 0 ? "\n" : ",\n");
+            writeFrame((*job.frames)[frameIndex]);
+            finishFrame();
+        }
+        output.write("\n],");
+    }
+
+    output.write("\n\"currentSeriesData\": [");
+    for (std::size_t i = 0; i < job.currentSeries.size(); ++i) {
+        output.write(i == 0 ? "{\"intensity\": " : ", {\"intensity\": ");
+        writeJsonNumber(job.currentSeries[i].intensity);
+        output.write(", \"pixel\": ");
+        writeJsonNumber(job.currentSeries[i].pixel);
+        if (hasAxis()) {
+            output.write(axisKey);
+            writeJsonNumber(axisValue(job.currentSeries[i].pixel));
+        }
+        output.write('}');
+    }
+    output.write("],");
+
+    if ((job.frames == nullptr || job.frameCount == 0) && job.hasLastFrame) {
+        output.write("\n\"lastRecordedFrame\": ");
+        writeFrame(job.lastFrame);
+        output.write(',');
+    }
+
+    output.write('\n');
+    writeJsonStatistics();
+    output.write("\n}\n");
+}
+
+void ExportJob::writeJsonColumnar() {
+    const auto writeSamples = [this](const SpectrumFrame& frame) {
+        output.write('[');
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            if (pixel > 0) {
+                output.write(',');
+            }
+            output.writeUnsigned(frame.pixels[pixel]);
+        }
+        output.write(']');
+    };
+
+    output.write("{\n\"layout\": \"columnar\",\n");
+    writeJsonStatistics();
+
+    output.write(",\n\"currentSeriesData\": {\"pixel\": [");
+    for (std::size_t i = 0; i < job.currentSeries.size(); ++i) {
+        if (i > 0) {
+            output.write(',');
+        }
+        writeJsonNumber(job.currentSeries[i].pixel);
+    }
+    if (hasAxis()) {
+        output.write("], \"");
+        output.write(spectralUnitKey(job.axisUnit));
+        output.write("\": [");
+        for (std::size_t i = 0; i < job.currentSeries.size(); ++i) {
+            if (i > 0) {
+                output.write(',');
+            }
+            writeJsonNumber(axisValue(job.currentSeries[i].pixel));
+        }
+    }
+    output.write("], \"intensity\": [");
+    for (std::size_t i = 0; i < job.currentSeries.size(); ++i) {
+        if (i > 0) {
+            output.write(',');
+        }
+        writeJsonNumber(job.currentSeries[i].intensity);
+    }
+    output.write("]}");
+
+    // Frames share one pixel axis: frames[f][i] is the intensity of pixel[i]
+    output.write(",\n\"pixel\": [");
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        if (pixel > 0) {
+            output.write(',');
+        }
+        output.writeUnsigned(static_cast<uint64_t>(pixel));
+    }
+    output.write(']');
+    if (hasAxis()) {
+        output.write(",\n\"");
+        output.write(spectralUnitKey(job.axisUnit));
+        output.write("\": [");
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            if (pixel > 0) {
+                output.write(',');
+            }
+            writeJsonNumber(job.axisValues[pixel]);
+        }
+        output.write(']');
+    }
+
+    if (job.frames != nullptr && job.frameCount > 0) {
+        output.write(",\n\"sequence\": [");
+        for (std::size_t frameIndex = 0; frameIndex < job.frameCount; ++frameIndex) {
+            if (frameIndex > 0) {
+                output.write(',');
+            }
+            output.writeUnsigned((*job.frames)[frameIndex].sequence);
+        }
+        output.write("],\n\"exposureTime\": [");
+        for (std::size_t frameIndex = 0; frameIndex < job.frameCount; ++frameIndex) {
+            if (frameIndex > 0) {
+                output.write(',');
+            }
+            output.writeUnsigned((*job.frames)[frameIndex].exposureTime);
+        }
+        output.write("],\n\"frames\": [");
+        for (std::size_t frameIndex = 0; frameIndex < job.frameCount; ++frameIndex) {
+            output.write(frameIndex == 0 ? "\n" : ",\n");
+            writeSamples((*job.frames)[frameIndex]);
+            finishFrame();
+        }
+        output.write("\n]");
+    } else if (job.hasLastFrame) {
+        output.write(",\n\"lastRecordedFrame\": ");
+        writeSamples(job.lastFrame);
+    }
+    output.write("\n}\n");
+}
+
+void ExportJob::startSidecar(const std::filesystem::path& path) {
+    output.close();
+    sidecarBaseBytes += output.bytesWritten();
+    sidecarPaths.push_back(path);
+    output.open(path);
+}
+
+void ExportJob::writeNpy() {
+    const bool allFrames = job.frames != nullptr && job.frameCount > 0;
+    const std::size_t frameCount = allFrames ? job.frameCount : (job.hasLastFrame ? 1 : 0);
+    const auto frameAt = [this, allFrames](std::size_t index) -> const SpectrumFrame& {
+        return allFrames ? (*job.frames)[index] : job.lastFrame;
+    };
+    const std::string rows = std::to_string(frameCount);
+
+    // Each row is a frame's pixel array copied as is, with no conversion
+    output.write(npyHeader("u2", "(" + rows + ", " + std::to_string(SpectrumFrame::PixelCount) + ")"));
+    for (std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        const SpectrumFrame& frame = frameAt(frameIndex);
+        output.write(frame.pixels.data(), sizeof(frame.pixels));
+        finishFrame();
+    }
+
+    startSidecar(npySidecarPath(filePath, "timestamps"));
+    output.write(npyHeader("i8", "(" + rows + ",)"));
+    for (std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        output.write(&frameAt(frameIndex).timestampNs, sizeof(int64_t));
+    }
+
+    startSidecar(npySidecarPath(filePath, "exposure"));
+    output.write(npyHeader("u4", "(" + rows + ",)"));
+    for (std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+        output.write(&frameAt(frameIndex).exposureTime, sizeof(uint32_t));
+    }
+
+    if (hasAxis()) {
+        startSidecar(npySidecarPath(filePath, spectralUnitKey(job.axisUnit)));
+        output.write(npyHeader("f8", "(" + std::to_string(job.axisValues.size()) + ",)"));
+        output.write(job.axisValues.data(), job.axisValues.size() * sizeof(double));
+    }
+}
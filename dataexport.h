@@ -0,0 +1,122 @@
+#ifndef DATAEXPORT_H
+#define DATAEXPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bufferedfilewriter.h"
+#include "framestore.h"
+#include "spectrumframe.h"
+#include "spectrumstatistics.h"
+#include "wavelengthcalibration.h"
+
+// Json matches the layout of the original QJsonDocument export: objects of
+// pixel and intensity per point. JsonColumnar stores the pixel axis once and
+// each frame as a bare array of intensities. Npy writes the frames as a
+// frames x pixels uint16 NumPy array, with their timestamps (int64, ns) and
+// exposure times (uint32, us) in sidecar .npy files named by
+// npySidecarPath(); all three load with numpy.load(mmap_mode='r'). With a
+// spectral axis, every format also carries each pixel's wavelength or Raman
+// shift: an extra column or key, or a further sidecar named after the unit.
+enum class ExportFormat { Csv, Txt, Json, JsonColumnar, Npy };
+
+// "run.npy" and "timestamps" give "run_timestamps.npy"
+std::filesystem::path npySidecarPath(const std::filesystem::path& path, const std::string& name);
+
+// What an export contains. Everything but the recorded frames is copied in,
+// so the GUI can keep changing while the export runs; the frame store must
+// not be modified until the job has finished.
+struct ExportRequest {
+    struct Point {
+        double pixel;
+        double intensity;
+    };
+
+    ExportFormat format = ExportFormat::Csv;
+
+    // Statistics and the displayed trace, written ahead of the frames
+    bool includeSummary = true;
+    SpectrumStatistics statistics;
+    std::vector<Point> currentSeries;
+
+    // Value of every pixel in axisUnit, from the calibration table; left
+    // empty, only pixel indices are written
+    SpectralUnit axisUnit = SpectralUnit::Pixel;
+    std::vector<double> axisValues;
+
+    // Either frames [0, frameCount) of `frames`, or the single lastFrame
+    const FrameStore* frames = nullptr;
+    std::size_t frameCount = 0;
+    bool hasLastFrame = false;
+    SpectrumFrame lastFrame;
+};
+
+// Writes an export on its own thread, streaming it straight from the frames
+// so memory use does not depend on the recording length. The GUI polls progress() and
+// bytesWritten() and may cancel(); a cancelled or failed export removes
+// its partial file.
+class ExportJob
+{
+public:
+    ExportJob() = default;
+    ~ExportJob();
+
+    ExportJob(const ExportJob&) = delete;
+    ExportJob& operator=(const ExportJob&) = delete;
+
+    // Creates the file and starts writing; throws std::runtime_error when
+    // the file cannot be created or a job is already running.
+    void start(const std::filesystem::path& path, ExportRequest request);
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+
+    // True until the writer thread has finished; then wait() collects it
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+    // Joins the writer; returns true if the file was written completely
+    bool wait();
+
+    double progress() const;
+    uint64_t bytesWritten() const { return writtenBytes.load(std::memory_order_relaxed); }
+    double elapsedSeconds() const;
+    double megabytesPerSecond() const;
+    bool wasCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    std::string errorMessage() const;
+
+private:
+    void run();
+    void writeText();
+    void writeJson();
+    void writeJsonColumnar();
+    void writeJsonNumber(double value);
+    void writeJsonStatistics();
+    void writeNpy();
+    bool hasAxis() const { return !job.axisValues.empty(); }
+    double axisValue(double pixel) const;
+    void startSidecar(const std::filesystem::path& path);
+    void finishFrame();  // Publishes progress; throws Cancelled when asked to stop
+
+    struct Cancelled {};
+
+    std::filesystem::path filePath;
+    std::vector<std::filesystem::path> sidecarPaths;
+    uint64_t sidecarBaseBytes = 0;  // Bytes in the files finished before the current one
+    ExportRequest job;
+    BufferedFileWriter output;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> framesDone{0};
+    std::atomic<uint64_t> writtenBytes{0};
+    std::atomic<int64_t> startNs{0};
+    std::atomic<int64_t> endNs{0};
+
+    mutable std::mutex errorMutex;
+    std::string lastError;
+};
+
+#endif // DATAEXPORT_H
@@ -0,0 +1,204 @@
+#include "devicecommandqueue.h"
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t toNs(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+DeviceCommand DeviceCommand::setExposure(uint32_t exposureTime) {
+    DeviceCommand command;
+    command.kind = Kind::SetExposure;
+    command.exposureTime = exposureTime;
+    return command;
+}
+
+DeviceCommand DeviceCommand::triggerOn() {
+    DeviceCommand command;
+    command.kind = Kind::TriggerOn;
+    return command;
+}
+
+DeviceCommand DeviceCommand::triggerOff() {
+    DeviceCommand command;
+    command.kind = Kind::TriggerOff;
+    return command;
+}
+
+uint32_t DeviceCommand::word() const {
+    // 2 and 3 switch the trigger; any other word is an exposure time
+    switch (kind) {
+    case Kind::TriggerOn:
+        return 2;
+    case Kind::TriggerOff:
+        return 3;
+    case Kind::SetExposure:
+        break;
+    }
+    return exposureTime;
+}
+
+bool DeviceCommand::isAcknowledgement(char response) const {
+    if (kind == Kind::SetExposure) {
+        return response == 'A';
+    }
+    return response == 't' || response == 'T';
+}
+
+const char* DeviceCommand::name() const {
+    switch (kind) {
+    case Kind::TriggerOn:
+        return "trigger on";
+    case Kind::TriggerOff:
+        return "trigger off";
+    case Kind::SetExposure:
+        break;
+    }
+    return "set exposure";
+}
+
+DeviceCommandQueue::~DeviceCommandQueue() {
+    stop();
+}
+
+void DeviceCommandQueue::start(SpectrometerDevice* spectrometer) {
+    stop();
+
+    device = spectrometer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        commands.clear();
+        stopRequested = false;
+    }
+    worker = std::thread(&DeviceCommandQueue::run, this);
+}
+
+void DeviceCommandQueue::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+        commands.clear();
+    }
+    commandReady.notify_one();
+    worker.join();
+}
+
+void DeviceCommandQueue::submit(const DeviceCommand& command, Completion completion) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        commands.push_back({command, std::move(completion)});
+    }
+    commandReady.notify_one();
+}
+
+std::size_t DeviceCommandQueue::pendingCommands() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return commands.size();
+}
+
+double DeviceCommandQueue::meanRoundTripMs() const {
+    const uint64_t count = roundTrips.load(std::memory_order_relaxed);
+    return count > 0 ? totalRoundTripNs.load(std::memory_order_relaxed) / 1e6 / static_cast<double>(count) : 0.0;
+}
+
+void DeviceCommandQueue::run() {
+    while (true) {
+        Pending next;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            commandReady.wait(lock, [this]() { return stopRequested || !commands.empty(); });
+            if (stopRequested) {
+                return;
+            }
+            next = std::move(commands.front());
+            commands.pop_front();
+        }
+
+        const DeviceCommandResult result = execute(next.command);
+        if (result.succeeded) {
+            completed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (next.completion) {
+            next.completion(result);
+        }
+    }
+}
+
+DeviceCommandResult DeviceCommandQueue::execute(const DeviceCommand& command) {
+    DeviceCommandResult result;
+    result.command = command;
+
+    if (command.delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(command.delayMs));
+    }
+
+    const uint32_t word = command.word();
+    for (int attempt = 1; attempt <= command.maxAttempts; ++attempt) {
+        result.attempts = attempt;
+        if (attempt > 1) {
+            retryCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // A late acknowledgement from a timed-out attempt must not be
+        // taken for this one's
+        device->purgeCommandChannel();
+
+        const Clock::time_point sent = Clock::now();
+        if (!device->writeCommand(&word, sizeof(word))) {
+            result.error = std::string("Failed to write ") + command.name() + " command";
+            continue;
+        }
+
+        char response = 0;
+        if (!waitForResponse(command.timeoutMs, response)) {
+            result.error = std::string("No response to ") + command.name() + " command";
+            continue;
+        }
+        const Clock::time_point acknowledged = Clock::now();
+
+        if (!command.isAcknowledgement(response)) {
+            result.error = std::string("Unexpected response ") + std::to_string(static_cast<int>(response)) +
+                           " to " + command.name() + " command";
+            continue;
+        }
+
+        result.succeeded = true;
+        result.error.clear();
+        result.roundTripNs = std::chrono::duration_cast<std::chrono::nanoseconds>(acknowledged - sent).count();
+        result.acknowledgedNs = toNs(acknowledged);
+        recordRoundTrip(result.roundTripNs);
+        return result;
+    }
+    return result;
+}
+
+bool DeviceCommandQueue::waitForResponse(int timeoutMs, char& response) {
+    // The acknowledgement is a single byte, a few milliseconds away at 9600 baud
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!device->readCommandResponse(response)) {
+        if (Clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(ResponsePollMs));
+    }
+    return true;
+}
+
+void DeviceCommandQueue::recordRoundTrip(int64_t roundTripNs) {
+    roundTrips.fetch_add(1, std::memory_order_relaxed);
+    totalRoundTripNs.fetch_add(roundTripNs, std::memory_order_relaxed);
+    lastRoundTripNs.store(roundTripNs, std::memory_order_relaxed);
+    if (roundTripNs > maxRoundTripNs.load(std::memory_order_relaxed)) {
+        maxRoundTripNs.store(roundTripNs, std::memory_order_relaxed);
+    }
+}
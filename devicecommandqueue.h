@@ -0,0 +1,106 @@
+#ifndef DEVICECOMMANDQUEUE_H
+#define DEVICECOMMANDQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "spectrometerdevice.h"
+
+// One UART command and how hard to try it. Each attempt writes the 4-byte
+// command word and waits up to timeoutMs for the acknowledgement byte.
+struct DeviceCommand {
+    enum class Kind { SetExposure, TriggerOn, TriggerOff };
+
+    static constexpr int DefaultTimeoutMs = 100;
+    static constexpr int DefaultAttempts = 5;
+
+    Kind kind = Kind::TriggerOff;
+    uint32_t exposureTime = 0;  // Microseconds, for SetExposure
+    int timeoutMs = DefaultTimeoutMs;
+    int maxAttempts = DefaultAttempts;
+    int delayMs = 0;            // Wait before the first attempt, e.g. to let a setting settle
+
+    static DeviceCommand setExposure(uint32_t exposureTime);
+    static DeviceCommand triggerOn();
+    static DeviceCommand triggerOff();
+
+    uint32_t word() const;
+    bool isAcknowledgement(char response) const;
+    const char* name() const;
+};
+
+struct DeviceCommandResult {
+    DeviceCommand command;
+    bool succeeded = false;
+    int attempts = 0;
+    int64_t roundTripNs = 0;     // Write to acknowledgement of the successful attempt
+    int64_t acknowledgedNs = 0;  // Steady-clock time of the acknowledgement, as frame timestamps
+    std::string error;
+};
+
+// Runs spectrometer commands on their own thread, one at a time and in
+// submission order, so the GUI never waits on the 9600 baud UART. Only the
+// command channel is touched; the data channel stays with the acquisition
+// thread. Completions are invoked on the command thread.
+class DeviceCommandQueue
+{
+public:
+    using Completion = std::function<void(const DeviceCommandResult&)>;
+
+    DeviceCommandQueue() = default;
+    ~DeviceCommandQueue();
+
+    DeviceCommandQueue(const DeviceCommandQueue&) = delete;
+    DeviceCommandQueue& operator=(const DeviceCommandQueue&) = delete;
+
+    void start(SpectrometerDevice* spectrometer);
+    // Finishes the command in progress; queued ones are dropped without
+    // their completions being called
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+
+    void submit(const DeviceCommand& command, Completion completion = {});
+    std::size_t pendingCommands() const;
+
+    uint64_t commandsCompleted() const { return completed.load(std::memory_order_relaxed); }
+    uint64_t commandsFailed() const { return failures.load(std::memory_order_relaxed); }
+    uint64_t retries() const { return retryCount.load(std::memory_order_relaxed); }
+    double lastRoundTripMs() const { return lastRoundTripNs.load(std::memory_order_relaxed) / 1e6; }
+    double maxRoundTripMs() const { return maxRoundTripNs.load(std::memory_order_relaxed) / 1e6; }
+    double meanRoundTripMs() const;
+
+private:
+    struct Pending {
+        DeviceCommand command;
+        Completion completion;
+    };
+
+    void run();
+    DeviceCommandResult execute(const DeviceCommand& command);
+    bool waitForResponse(int timeoutMs, char& response);
+    void recordRoundTrip(int64_t roundTripNs);
+
+    static constexpr int ResponsePollMs = 1;
+
+    SpectrometerDevice* device = nullptr;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable commandReady;
+    std::deque<Pending> commands;
+    bool stopRequested = false;
+
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> retryCount{0};
+    std::atomic<uint64_t> roundTrips{0};
+    std::atomic<int64_t> totalRoundTripNs{0};
+    std::atomic<int64_t> lastRoundTripNs{0};
+    std::atomic<int64_t> maxRoundTripNs{0};
+};
+
+#endif // DEVICECOMMANDQUEUE_H
@@ -0,0 +1,153 @@
+#include "devicespectraview.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+
+DeviceSpectraView::DeviceSpectraView(const std::vector<std::string>& serialNumbers, QWidget* parent) :
+    QWidget(parent),
+    traces(static_cast<qsizetype>(serialNumbers.size())),
+    yRanges(serialNumbers.size())
+{
+    arrangementComboBox = new QComboBox(this);
+    arrangementComboBox->addItem("Overlay", static_cast<int>(Arrangement::Overlay));
+    arrangementComboBox->addItem("Tiles", static_cast<int>(Arrangement::Tiles));
+    arrangementComboBox->setToolTip("Draw every spectrometer in one plot or each in its own");
+    arrangementComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+
+    auto headerLayout = new QHBoxLayout();
+    auto titleLabel = new QLabel("Spectrometers:", this);
+    titleLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    headerLayout->addWidget(titleLabel);
+    headerLayout->addWidget(arrangementComboBox);
+
+    // The legend doubles as the list of heads in use
+    for (std::size_t device = 0; device < serialNumbers.size(); ++device) {
+        const QColor color = deviceColor(device);
+        colors.append(color);
+        auto legendLabel = new QLabel(QString::fromStdString(serialNumbers[device]), this);
+        legendLabel->setStyleSheet(QString("color: %1; font-weight: 500; font-size: 14px;").arg(color.name()));
+        headerLayout->addWidget(legendLabel);
+    }
+    headerLayout->addStretch();
+
+    overlayPlot = new SpectrumPlotWidget(this);
+    overlayPlot->setMinimumHeight(320);
+    overlayPlot->setTitle("All Spectrometers");
+    overlayPlot->setAxisTitles("Pixel", "Intensity");
+
+    // Roughly square grid, filled row by row
+    tileContainer = new QWidget(this);
+    auto tileLayout = new QGridLayout(tileContainer);
+    tileLayout->setContentsMargins(0, 0, 0, 0);
+    tileLayout->setSpacing(2);
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(serialNumbers.size())))));
+    for (std::size_t device = 0; device < serialNumbers.size(); ++device) {
+        auto plot = new SpectrumPlotWidget(tileContainer);
+        plot->setMinimumSize(320, 200);
+        plot->setTitle(QString::fromStdString(serialNumbers[device]));
+        plot->setAxisTitles("Pixel", "Intensity");
+        plot->setTraceColor(colors[static_cast<qsizetype>(device)]);
+        tileLayout->addWidget(plot, static_cast<int>(device) / columns, static_cast<int>(device) % columns);
+        tilePlots.push_back(plot);
+    }
+    tileContainer->setVisible(false);
+
+    auto layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(headerLayout);
+    layout->addWidget(overlayPlot);
+    layout->addWidget(tileContainer);
+
+    connect(arrangementComboBox, &QComboBox::currentIndexChanged, this, [this](int index) {
+        setArrangement(static_cast<Arrangement>(arrangementComboBox->itemData(index).toInt()));
+    });
+}
+
+QColor DeviceSpectraView::deviceColor(std::size_t device) {
+    // The first head keeps the main plot's blue; the golden angle keeps the
+    // following hues apart however many heads there are
+    return QColor::fromHsv(static_cast<int>((240 + device * 137) % 360), 255, 220);
+}
+
+void DeviceSpectraView::setArrangement(Arrangement arrangement) {
+    currentArrangement = arrangement;
+    overlayPlot->setVisible(arrangement == Arrangement::Overlay);
+    tileContainer->setVisible(arrangement == Arrangement::Tiles);
+
+    // The hidden plots were not kept up to date
+    if (arrangement == Arrangement::Overlay) {
+        overlayPlot->setOverlayTraces(traces, colors);
+    } else {
+        for (std::size_t device = 0; device < tilePlots.size(); ++device) {
+            tilePlots[device]->setTrace(traces[static_cast<qsizetype>(device)]);
+        }
+    }
+    updateYRanges();
+}
+
+void DeviceSpectraView::setSpectrum(std::size_t device, const SpectrumFrame& frame) {
+    if (device >= tilePlots.size()) return;
+
+    QVector<QPointF>& points = traces[static_cast<qsizetype>(device)];
+    points.resize(SpectrumFrame::PixelCount);
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        points[pixel] = QPointF(pixel, frame.pixels[pixel]);
+    }
+
+    if (yRanges[device].update(frame.minimum, frame.maximum)) {
+        updateYRanges();
+    }
+    if (currentArrangement == Arrangement::Overlay) {
+        overlayPlot->setOverlayTraces(traces, colors);
+    } else {
+        tilePlots[device]->setTrace(points);
+    }
+}
+
+void DeviceSpectraView::setXRange(double minimum, double maximum) {
+    overlayPlot->setXRange(minimum, maximum);
+    for (SpectrumPlotWidget* plot : tilePlots) {
+        plot->setXRange(minimum, maximum);
+    }
+}
+
+void DeviceSpectraView::clear() {
+    for (QVector<QPointF>& points : traces) {
+        points.clear();
+    }
+    for (AutoRange& range : yRanges) {
+        range.reset();
+    }
+    overlayPlot->setOverlayTraces(traces, colors);
+    for (SpectrumPlotWidget* plot : tilePlots) {
+        plot->setTrace({});
+        plot->setYRange(0, 65535);
+    }
+    overlayPlot->setYRange(0, 65535);
+}
+
+void DeviceSpectraView::updateYRanges() {
+    double lower = 0.0;
+    double upper = 0.0;
+    bool valid = false;
+    for (std::size_t device = 0; device < yRanges.size(); ++device) {
+        const AutoRange& range = yRanges[device];
+        if (!range.isValid()) continue;
+        tilePlots[device]->setYRange(range.lower(), range.upper());
+        lower = valid ? std::min(lower, range.lower()) : range.lower();
+        upper = valid ? std::max(upper, range.upper()) : range.upper();
+        valid = true;
+    }
+    if (valid) {
+        overlayPlot->setYRange(lower, upper);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef DEVICESPECTRAVIEW_H
+#define DEVICESPECTRAVIEW_H
+
+#include <QColor>
+#include <QComboBox>
+#include <QGridLayout>
+#include <QPointF>
+#include <QVector>
+#include <QWidget>
+#include <string>
+#include <vector>
+#include "autorange.h"
+#include "spectrumframe.h"
+#include "spectrumplotwidget.h"
+
+// The newest raw spectrum of every spectrometer head, either overlaid in one
+// plot or tiled in a grid with one plot per head. Each head has its own
+// colour, and its own auto Y range in the tiles; the overlay spans them all.
+// Frames only replace a trace and schedule a repaint, so heads that deliver
+// faster than the display refreshes cost one conversion per frame handed in.
+class DeviceSpectraView final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum class Arrangement { Overlay, Tiles };
+
+    explicit DeviceSpectraView(const std::vector<std::string>& serialNumbers, QWidget* parent = nullptr);
+
+    void setArrangement(Arrangement arrangement);
+    void setSpectrum(std::size_t device, const SpectrumFrame& frame);
+    void setXRange(double minimum, double maximum);
+    void clear();
+
+    static QColor deviceColor(std::size_t device);
+
+private:
+    void updateYRanges();
+
+    QComboBox* arrangementComboBox = nullptr;
+    SpectrumPlotWidget* overlayPlot = nullptr;
+    QWidget* tileContainer = nullptr;
+    std::vector<SpectrumPlotWidget*> tilePlots;
+
+    Arrangement currentArrangement = Arrangement::Overlay;
+    QVector<QVector<QPointF>> traces;  // Per head, at consecutive pixels
+    QVector<QColor> colors;
+    std::vector<AutoRange> yRanges;
+};
+
+#endif // DEVICESPECTRAVIEW_H
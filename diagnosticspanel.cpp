@@ -0,0 +1,41 @@
+#include "diagnosticspanel.h"
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+DiagnosticsPanel::DiagnosticsPanel(QWidget* parent) :
+    QWidget(parent, Qt::Tool)
+{
+    setWindowTitle("Diagnostics");
+    resize(520, 640);
+
+    reportView = new QPlainTextEdit(this);
+    reportView->setReadOnly(true);
+    reportView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    reportView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    saveButton = new QPushButton("Save Report...", this);
+    saveButton->setToolTip("Write the current counters and latency histogram to a text file");
+    resetLatencyButton = new QPushButton("Reset Latency", this);
+    resetLatencyButton->setToolTip("Start the read-to-display latency histogram afresh");
+
+    auto buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(resetLatencyButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(saveButton);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(reportView);
+    layout->addLayout(buttonLayout);
+
+    connect(saveButton, &QPushButton::clicked, this, &DiagnosticsPanel::saveRequested);
+    connect(resetLatencyButton, &QPushButton::clicked, this, &DiagnosticsPanel::resetLatencyRequested);
+}
+
+void DiagnosticsPanel::showReport(const QString& report) {
+    // Keep the scroll position across refreshes
+    const int scrollPosition = reportView->verticalScrollBar()->value();
+    reportView->setPlainText(report);
+    reportView->verticalScrollBar()->setValue(scrollPosition);
+}
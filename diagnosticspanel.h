@@ -0,0 +1,30 @@
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QString>
+#include <QWidget>
+
+// Tool window showing the pipeline telemetry report. The owner refreshes it
+// while it is visible and handles saving and resetting.
+class DiagnosticsPanel final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsPanel(QWidget* parent = nullptr);
+
+    void showReport(const QString& report);
+
+signals:
+    void saveRequested();
+    void resetLatencyRequested();
+
+private:
+    QPlainTextEdit* reportView = nullptr;
+    QPushButton* saveButton = nullptr;
+    QPushButton* resetLatencyButton = nullptr;
+};
+
+#endif // DIAGNOSTICSPANEL_H
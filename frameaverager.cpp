@@ -0,0 +1,85 @@
+#include "frameaverager.h"
+#include <algorithm>
+#include <cstring>
+
+FrameAverager::FrameAverager(std::size_t window, Mode mode) :
+    averagingMode(mode),
+    windowSize(std::clamp<std::size_t>(window, 1, MaxWindow))
+{
+    clear();
+}
+
+void FrameAverager::setWindow(std::size_t window) {
+    windowSize = std::clamp<std::size_t>(window, 1, MaxWindow);
+    clear();
+}
+
+void FrameAverager::setMode(Mode mode) {
+    averagingMode = mode;
+    clear();
+}
+
+void FrameAverager::clear() {
+    count = 0;
+    oldest = 0;
+    if (averagingMode == Mode::Sliding) {
+        history.assign(windowSize * PixelCount, 0);
+        sums.assign(PixelCount, 0);
+        smoothed.clear();
+        smoothed.shrink_to_fit();
+    } else {
+        smoothed.assign(PixelCount, 0.0f);
+        alpha = 2.0f / (static_cast<float>(windowSize) + 1.0f);
+        history.clear();
+        history.shrink_to_fit();
+        sums.clear();
+    }
+}
+
+void FrameAverager::add(const SpectrumFrame& frame) {
+    const uint16_t* pixels = frame.pixels.data();
+
+    if (averagingMode == Mode::Exponential) {
+        // The first frame seeds the average instead of being weighted against zero
+        if (count == 0) {
+            std::copy(pixels, pixels + PixelCount, smoothed.begin());
+            count = 1;
+            return;
+        }
+        for (std::size_t i = 0; i < PixelCount; ++i) {
+            smoothed[i] += alpha * (static_cast<float>(pixels[i]) - smoothed[i]);
+        }
+        count = std::min(count + 1, windowSize);
+        return;
+    }
+
+    // Write the new frame over the slot of the one leaving the window
+    uint16_t* slot = history.data() + oldest * PixelCount;
+    if (count == windowSize) {
+        for (std::size_t i = 0; i < PixelCount; ++i) {
+            sums[i] += static_cast<uint32_t>(pixels[i]) - slot[i];
+        }
+    } else {
+        for (std::size_t i = 0; i < PixelCount; ++i) {
+            sums[i] += pixels[i];
+        }
+        ++count;
+    }
+    std::memcpy(slot, pixels, PixelCount * sizeof(uint16_t));
+    oldest = (oldest + 1) % windowSize;
+}
+
+void FrameAverager::average(float* values) const {
+    if (count == 0) {
+        std::fill(values, values + PixelCount, 0.0f);
+        return;
+    }
+    if (averagingMode == Mode::Exponential) {
+        std::copy(smoothed.begin(), smoothed.end(), values);
+        return;
+    }
+    const float scale = 1.0f / static_cast<float>(count);
+    for (std::size_t i = 0; i < PixelCount; ++i) {
+        values[i] = static_cast<float>(sums[i]) * scale;
+    }
+}
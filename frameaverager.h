@@ -0,0 +1,58 @@
+#ifndef FRAMEAVERAGER_H
+#define FRAMEAVERAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "spectrumframe.h"
+
+// Running average of raw frames. The sliding mode keeps the last `window`
+// frames in a ring next to per-pixel integer sums: adding a frame subtracts
+// the one it evicts and adds the new one, so the cost per frame is one pass
+// over the pixels whatever the window. The exponential mode keeps a single
+// float per pixel, weighted like a window of the same length
+// (alpha = 2 / (window + 1)).
+class FrameAverager
+{
+public:
+    enum class Mode { Sliding, Exponential };
+
+    static constexpr std::size_t MaxWindow = 10000;
+
+    explicit FrameAverager(std::size_t window = 10, Mode mode = Mode::Sliding);
+
+    // Both discard the frames averaged so far
+    void setWindow(std::size_t window);
+    void setMode(Mode mode);
+    std::size_t window() const { return windowSize; }
+    Mode mode() const { return averagingMode; }
+
+    void add(const SpectrumFrame& frame);
+    void clear();
+
+    // Frames currently contributing to the average
+    std::size_t frameCount() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    // Writes the average of every pixel to values (PixelCount floats)
+    void average(float* values) const;
+
+private:
+    static constexpr std::size_t PixelCount = SpectrumFrame::PixelCount;
+
+    Mode averagingMode;
+    std::size_t windowSize;
+    std::size_t count = 0;
+    std::size_t oldest = 0;
+
+    // Sliding: `windowSize` frames of history and their sums. 10000 frames
+    // of 65535 still fit in 32 bits.
+    std::vector<uint16_t> history;
+    std::vector<uint32_t> sums;
+
+    // Exponential
+    std::vector<float> smoothed;
+    float alpha = 1.0f;
+};
+
+#endif // FRAMEAVERAGER_H
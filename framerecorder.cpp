@@ -0,0 +1,193 @@
+#include "framerecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+FrameRecorder::FrameRecorder(std::size_t queueCapacity) :
+    queue(queueCapacity),
+    writeBuffer(new (std::align_val_t{WriteAlignment}) uint8_t[WriteBufferBytes])
+{
+    blockIndex.reserve(RecordingFormat::IndexInterval);
+}
+
+FrameRecorder::~FrameRecorder() {
+    close();
+}
+
+void FrameRecorder::open(const std::filesystem::path& path) {
+    close();
+
+    // Unbuffered: the staging buffer already batches writes, and this way
+    // each flush() is a single large write to the OS
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create recording file " + path.string());
+    }
+
+    while (queue.front() != nullptr) {
+        queue.popFront();
+    }
+    bufferedBytes = 0;
+    blockIndex.clear();
+    blockFirstFrame = 0;
+    stopRequested.store(false, std::memory_order_relaxed);
+    failed.store(false, std::memory_order_relaxed);
+    writtenFrames.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    writtenBytes.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError.clear();
+    }
+
+    RecordingFormat::RecordingHeader header{};
+    std::memcpy(header.magic, RecordingFormat::Magic, sizeof(header.magic));
+    header.version = RecordingFormat::Version;
+    header.headerBytes = sizeof(header);
+    header.pixelCount = SpectrumFrame::PixelCount;
+    header.bitsPerSample = 16;
+    header.frameRecordBytes = static_cast<uint32_t>(RecordingFormat::frameRecordBytes(SpectrumFrame::PixelCount));
+    header.indexInterval = RecordingFormat::IndexInterval;
+    header.startTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header.startTimestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    append(&header, sizeof(header));
+    flush();
+
+    writer = std::thread(&FrameRecorder::run, this);
+}
+
+bool FrameRecorder::close() {
+    if (!writer.joinable()) {
+        return !failed.load(std::memory_order_relaxed);
+    }
+
+    stopRequested.store(true, std::memory_order_release);
+    writer.join();
+
+    // The writer has drained the queue; finish the last block
+    if (!blockIndex.empty()) {
+        writeIndexBlock();
+    }
+    flush();
+    file.close();
+    return !failed.load(std::memory_order_relaxed);
+}
+
+bool FrameRecorder::submit(const SpectrumFrame& frame) {
+    if (!queue.tryPush(frame)) {
+        droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+std::string FrameRecorder::errorMessage() const {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return lastError;
+}
+
+void FrameRecorder::run() {
+    using Clock = std::chrono::steady_clock;
+    auto lastFlush = Clock::now();
+
+    while (true) {
+        // Read the flag before draining so nothing submitted before close()
+        // is left behind
+        const bool stopping = stopRequested.load(std::memory_order_acquire);
+
+        bool wroteFrames = false;
+        while (const SpectrumFrame* frame = queue.front()) {
+            writeFrame(*frame);
+            queue.popFront();
+            wroteFrames = true;
+        }
+
+        if (stopping) {
+            return;
+        }
+
+        if (bufferedBytes > 0 && Clock::now() - lastFlush >= std::chrono::milliseconds(FlushIntervalMs)) {
+            flush();
+            lastFlush = Clock::now();
+        }
+
+        if (!wroteFrames) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(IdleSleepMs));
+        }
+    }
+}
+
+void FrameRecorder::writeFrame(const SpectrumFrame& frame) {
+    if (blockIndex.empty()) {
+        blockFirstFrame = writtenFrames.load(std::memory_order_relaxed);
+    }
+
+    RecordingFormat::FrameRecordHeader record{};
+    record.magic = RecordingFormat::FrameMagic;
+    record.exposureTime = frame.exposureTime;
+    record.sequence = frame.sequence;
+    record.timestampNs = frame.timestampNs;
+    append(&record, sizeof(record));
+    append(frame.pixels.data(), sizeof(frame.pixels));
+
+    blockIndex.push_back({frame.sequence, frame.timestampNs});
+    writtenFrames.fetch_add(1, std::memory_order_relaxed);
+
+    if (blockIndex.size() == RecordingFormat::IndexInterval) {
+        writeIndexBlock();
+    }
+}
+
+void FrameRecorder::writeIndexBlock() {
+    RecordingFormat::IndexBlockHeader index{};
+    index.magic = RecordingFormat::IndexMagic;
+    index.frameCount = static_cast<uint32_t>(blockIndex.size());
+    index.firstFrame = blockFirstFrame;
+    append(&index, sizeof(index));
+    append(blockIndex.data(), blockIndex.size() * sizeof(RecordingFormat::IndexEntry));
+    blockIndex.clear();
+}
+
+void FrameRecorder::append(const void* data, std::size_t size) {
+    // Records may straddle the staging buffer, so every write but the
+    // periodic and final ones is exactly WriteBufferBytes
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const std::size_t chunk = std::min(size, WriteBufferBytes - bufferedBytes);
+        std::memcpy(writeBuffer.get() + bufferedBytes, bytes, chunk);
+        bufferedBytes += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (bufferedBytes == WriteBufferBytes) {
+            flush();
+        }
+    }
+}
+
+void FrameRecorder::flush() {
+    if (bufferedBytes == 0) {
+        return;
+    }
+    if (!failed.load(std::memory_order_relaxed)) {
+        file.write(reinterpret_cast<const char*>(writeBuffer.get()), static_cast<std::streamsize>(bufferedBytes));
+        file.flush();
+        if (!file) {
+            fail("Writing the recording file failed (disk full?)");
+        } else {
+            writtenBytes.fetch_add(bufferedBytes, std::memory_order_relaxed);
+        }
+    }
+    bufferedBytes = 0;
+}
+
+void FrameRecorder::fail(const std::string& message) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (lastError.empty()) {
+        lastError = message;
+    }
+    failed.store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+#ifndef FRAMERECORDER_H
+#define FRAMERECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "recordingformat.h"
+#include "spectrumframe.h"
+#include "spscqueue.h"
+
+// Streams frames to a .lsvrec file (see recordingformat.h) while they are
+// acquired. submit() only copies the frame into a queue; a writer thread
+// packs records into an aligned staging buffer and writes it out in large
+// blocks, so recording length is bounded by the disk rather than by RAM.
+// The buffer is also written out at least every FlushIntervalMs, which
+// bounds what an application crash can lose.
+class FrameRecorder
+{
+public:
+    explicit FrameRecorder(std::size_t queueCapacity = 4096);
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Creates the file and starts the writer thread; throws std::runtime_error
+    // when the file cannot be created.
+    void open(const std::filesystem::path& path);
+
+    // Writes everything submitted so far plus the final index block and
+    // closes the file. Returns false if any write failed.
+    bool close();
+    bool isOpen() const { return writer.joinable(); }
+
+    // Producer side, called from a single thread only. Returns false and
+    // counts the frame as dropped when the writer has fallen behind.
+    bool submit(const SpectrumFrame& frame);
+
+    uint64_t framesWritten() const { return writtenFrames.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return droppedFrames.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return writtenBytes.load(std::memory_order_relaxed); }
+    std::size_t queueDepth() const { return queue.size(); }
+    std::size_t queueCapacity() const { return queue.capacity(); }
+    std::string errorMessage() const;
+
+private:
+    void run();
+    void writeFrame(const SpectrumFrame& frame);
+    void writeIndexBlock();
+    void append(const void* data, std::size_t size);
+    void flush();
+    void fail(const std::string& message);
+
+    static constexpr std::size_t WriteBufferBytes = 4 * 1024 * 1024;
+    static constexpr std::size_t WriteAlignment = 4096;
+    static constexpr int FlushIntervalMs = 500;
+    static constexpr int IdleSleepMs = 2;
+
+    struct AlignedDelete {
+        void operator()(uint8_t* p) const { ::operator delete[](p, std::align_val_t{WriteAlignment}); }
+    };
+
+    SpscQueue<SpectrumFrame> queue;
+    std::unique_ptr<uint8_t[], AlignedDelete> writeBuffer;
+    std::size_t bufferedBytes = 0;
+    std::ofstream file;
+    std::thread writer;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> writtenFrames{0};
+    std::atomic<uint64_t> droppedFrames{0};
+    std::atomic<uint64_t> writtenBytes{0};
+
+    // Index entries of the block being written
+    std::vector<RecordingFormat::IndexEntry> blockIndex;
+    uint64_t blockFirstFrame = 0;
+
+    mutable std::mutex errorMutex;
+    std::string lastError;
+};
+
+#endif // FRAMERECORDER_H
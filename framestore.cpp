@@ -0,0 +1,21 @@
+#include "framestore.h"
+
+FrameStore::FrameStore(std::size_t framesPerChunk) :
+    framesPerChunk(framesPerChunk)
+{
+}
+
+SpectrumFrame& FrameStore::append() {
+    const std::size_t chunk = count / framesPerChunk;
+    if (chunk == chunks.size()) {
+        chunks.push_back(std::make_unique<SpectrumFrame[]>(framesPerChunk));
+    }
+    return chunks[chunk][count++ % framesPerChunk];
+}
+
+void FrameStore::clear() {
+    if (chunks.size() > 1) {
+        chunks.resize(1);
+    }
+    count = 0;
+}
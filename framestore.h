@@ -0,0 +1,40 @@
+#ifndef FRAMESTORE_H
+#define FRAMESTORE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "spectrumframe.h"
+
+// Append-only arena of recorded frames. Frames are stored contiguously in
+// fixed-size chunks, so appending allocates once per chunk rather than once
+// per frame, and references stay valid while the store grows.
+class FrameStore
+{
+public:
+    explicit FrameStore(std::size_t framesPerChunk = 512);
+
+    // Returns the slot for the next frame, to be filled in place
+    SpectrumFrame& append();
+    void append(const SpectrumFrame& frame) { append() = frame; }
+
+    const SpectrumFrame& operator[](std::size_t index) const
+    {
+        return chunks[index / framesPerChunk][index % framesPerChunk];
+    }
+    const SpectrumFrame& last() const { return (*this)[count - 1]; }
+
+    std::size_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    std::size_t memoryUsage() const { return chunks.size() * framesPerChunk * sizeof(SpectrumFrame); }
+
+    // Forgets all frames; the first chunk is kept for the next recording
+    void clear();
+
+private:
+    std::size_t framesPerChunk;
+    std::size_t count = 0;
+    std::vector<std::unique_ptr<SpectrumFrame[]>> chunks;
+};
+
+#endif // FRAMESTORE_H
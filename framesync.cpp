@@ -0,0 +1,217 @@
+#include "framesync.h"
+#include <algorithm>
+#include "simdsupport.h"
+#include "spectrumframe.h"
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t HeaderSize = 4;
+
+inline bool isHeader(const uint8_t* p) {
+    return p[0] == 0x00 && p[1] == 0x00 && p[2] == 0x00 && p[3] == 0x01;
+}
+
+#ifdef LSV_SIMD_SSE2
+inline unsigned lowestSetBit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Compares 16 candidate positions at once: byte i, i+1, i+2 must be zero and
+// byte i+3 must be one, so four shifted loads are and-ed together.
+std::size_t findSyncSse2(const uint8_t* data, std::size_t size, std::size_t from) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    std::size_t i = from;
+    for (; i + 16 + HeaderSize - 1 <= size; i += 16) {
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+        const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 3));
+        const __m128i match = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+            _mm_and_si128(_mm_cmpeq_epi8(b2, zero), _mm_cmpeq_epi8(b3, one)));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+        if (mask != 0) {
+            return i + lowestSetBit(mask);
+        }
+    }
+    return findSyncPatternScalar(data, size, i);
+}
+#endif
+
+#ifdef LSV_SIMD_AVX2
+LSV_AVX2_TARGET
+std::size_t findSyncAvx2(const uint8_t* data, std::size_t size, std::size_t from) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    std::size_t i = from;
+    for (; i + 32 + HeaderSize - 1 <= size; i += 32) {
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+        const __m256i b3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 3));
+        const __m256i match = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+            _mm256_and_si256(_mm256_cmpeq_epi8(b2, zero), _mm256_cmpeq_epi8(b3, one)));
+        const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(match));
+        if (mask != 0) {
+            return i + lowestSetBit(mask);
+        }
+    }
+    return findSyncSse2(data, size, i);
+}
+#endif
+
+using SyncScanner = std::size_t (*)(const uint8_t*, std::size_t, std::size_t);
+
+SyncScanner selectScanner() {
+#if defined(LSV_SIMD_AVX2)
+    if (cpuHasAvx2()) {
+        return findSyncAvx2;
+    }
+    return findSyncSse2;
+#elif defined(LSV_SIMD_SSE2)
+    return findSyncSse2;
+#else
+    return findSyncPatternScalar;
+#endif
+}
+
+const SyncScanner scanner = selectScanner();
+
+bool isHeaderAt(const ByteRing& stream, std::size_t offset) {
+    return stream.at(offset) == 0x00 && stream.at(offset + 1) == 0x00 &&
+           stream.at(offset + 2) == 0x00 && stream.at(offset + 3) == 0x01;
+}
+
+} // namespace
+
+std::size_t findSyncPatternScalar(const uint8_t* data, std::size_t size, std::size_t from) {
+    for (std::size_t i = from; i + HeaderSize <= size; ++i) {
+        if (isHeader(data + i)) {
+            return i;
+        }
+    }
+    return size;
+}
+
+std::size_t findSyncPattern(const uint8_t* data, std::size_t size, std::size_t from) {
+    if (from + HeaderSize > size) {
+        return size;
+    }
+    return scanner(data, size, from);
+}
+
+std::size_t findSyncPattern(const RingSpan& data, std::size_t from) {
+    const std::size_t size = data.size();
+    if (data.isContiguous()) {
+        return findSyncPattern(data.first, data.firstSize, from);
+    }
+
+    // Headers wholly inside the first piece
+    if (from < data.firstSize) {
+        const std::size_t position = findSyncPattern(data.first, data.firstSize, from);
+        if (position < data.firstSize) {
+            return position;
+        }
+    }
+
+    // Headers straddling the wrap point
+    const std::size_t straddleStart = std::max(from, data.firstSize >= HeaderSize - 1 ? data.firstSize - (HeaderSize - 1) : 0);
+    for (std::size_t i = straddleStart; i < data.firstSize && i + HeaderSize <= size; ++i) {
+        if (data[i] == 0x00 && data[i + 1] == 0x00 && data[i + 2] == 0x00 && data[i + 3] == 0x01) {
+            return i;
+        }
+    }
+
+    // Headers wholly inside the second piece
+    const std::size_t secondFrom = from > data.firstSize ? from - data.firstSize : 0;
+    const std::size_t position = findSyncPattern(data.second, data.secondSize, secondFrom);
+    return position < data.secondSize ? data.firstSize + position : size;
+}
+
+bool FrameSynchronizer::locateFrame(ByteRing& stream) {
+    constexpr std::size_t FrameBytes = SpectrumFrame::FrameBytes;
+
+    while (true) {
+        const std::size_t available = stream.size();
+
+        if (currentState == State::Locked) {
+            if (available < FrameBytes) {
+                return false;
+            }
+            if (isHeaderAt(stream, 0)) {
+                // Accept as soon as the frame is complete; if the following
+                // bytes are already here they should be the next header
+                if (available < FrameBytes + HeaderSize || isHeaderAt(stream, FrameBytes)) {
+                    return true;
+                }
+
+                // A header inside the frame means bytes were lost from it;
+                // otherwise stray bytes follow an intact frame
+                currentState = State::Searching;
+                increment(resyncCount);
+                if (findSyncPattern(stream.span(1, FrameBytes + HeaderSize - 2)) == FrameBytes + HeaderSize - 2) {
+                    return true;
+                }
+                increment(rejectedFrames);
+                discard(stream, 1);
+                continue;
+            }
+            currentState = State::Searching;
+            increment(resyncCount);
+            continue;
+        }
+
+        if (available < HeaderSize) {
+            return false;
+        }
+
+        const std::size_t candidate = findSyncPattern(stream.span(0, available));
+        if (candidate == available) {
+            // Keep the last three bytes, they may begin a header
+            discard(stream, available - (HeaderSize - 1));
+            return false;
+        }
+        discard(stream, candidate);
+
+        // Validate against the following header before trusting the candidate
+        if (stream.size() < FrameBytes + HeaderSize) {
+            return false;
+        }
+        if (isHeaderAt(stream, FrameBytes)) {
+            currentState = State::Locked;
+            return true;
+        }
+        discard(stream, 1);
+    }
+}
+
+void FrameSynchronizer::reset() {
+    currentState = State::Searching;
+    resyncCount.store(0, std::memory_order_relaxed);
+    discardedBytes.store(0, std::memory_order_relaxed);
+    rejectedFrames.store(0, std::memory_order_relaxed);
+}
+
+void FrameSynchronizer::discard(ByteRing& stream, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    stream.consume(count);
+    increment(discardedBytes, count);
+}
+
+void FrameSynchronizer::increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+    // Single writer, so a relaxed load/store pair is enough
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+#ifndef FRAMESYNC_H
+#define FRAMESYNC_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "bytering.h"
+
+// Offset of the first 00 00 00 01 sync header at or after `from`, or `size`
+// when there is none. Uses AVX2 or SSE2 where available.
+std::size_t findSyncPattern(const uint8_t* data, std::size_t size, std::size_t from = 0);
+
+// Byte-at-a-time reference implementation of findSyncPattern().
+std::size_t findSyncPatternScalar(const uint8_t* data, std::size_t size, std::size_t from = 0);
+
+// Same search over a ring view, including headers that straddle the wrap point.
+std::size_t findSyncPattern(const RingSpan& data, std::size_t from = 0);
+
+// Locks onto the frame stream and keeps it locked. While searching, a header
+// candidate is only accepted once a second header sits exactly one frame
+// later. While locked, the lock is dropped as soon as the bytes after a frame
+// are not the next header; the frame itself is rejected if it contains a
+// header (bytes were lost from it) and kept otherwise (stray bytes follow
+// it). Skipped bytes are consumed, so nothing is ever scanned twice.
+//
+// Counters are written by the parsing thread only and may be read anywhere.
+class FrameSynchronizer
+{
+public:
+    enum class State { Searching, Locked };
+
+    // Discards bytes until a validated frame starts at the read position of
+    // `stream`. Returns false when more data is needed; the caller consumes
+    // the frame once it has been decoded.
+    bool locateFrame(ByteRing& stream);
+
+    void reset();
+
+    State state() const { return currentState; }
+    uint64_t resyncs() const { return resyncCount.load(std::memory_order_relaxed); }
+    uint64_t bytesDiscarded() const { return discardedBytes.load(std::memory_order_relaxed); }
+    uint64_t framesRejected() const { return rejectedFrames.load(std::memory_order_relaxed); }
+
+private:
+    void discard(ByteRing& stream, std::size_t count);
+    static void increment(std::atomic<uint64_t>& counter, uint64_t amount = 1);
+
+    State currentState = State::Searching;
+    std::atomic<uint64_t> resyncCount{0};
+    std::atomic<uint64_t> discardedBytes{0};
+    std::atomic<uint64_t> rejectedFrames{0};
+};
+
+#endif // FRAMESYNC_H
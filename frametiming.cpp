@@ -0,0 +1,51 @@
+#include "frametiming.h"
+#include <algorithm>
+#include <cmath>
+
+void FrameTiming::record(uint64_t sequence, int64_t timestampNs) {
+    if (current.frames++ == 0) {
+        lastSequence = sequence;
+        lastTimestampNs = timestampNs;
+        return;
+    }
+
+    // Sequence numbers only grow; anything else is a new stream
+    if (sequence <= lastSequence) {
+        lastSequence = sequence;
+        lastTimestampNs = timestampNs;
+        return;
+    }
+
+    const uint64_t skipped = sequence - lastSequence - 1;
+    if (skipped > 0) {
+        current.missingFrames += skipped;
+        ++current.gaps;
+    }
+    const double interval = static_cast<double>(timestampNs - lastTimestampNs) / static_cast<double>(skipped + 1);
+    lastSequence = sequence;
+    lastTimestampNs = timestampNs;
+
+    ++intervals;
+    const double delta = interval - current.meanIntervalNs;
+    current.meanIntervalNs += delta / static_cast<double>(intervals);
+    intervalSquares += delta * (interval - current.meanIntervalNs);
+    current.jitterNs = intervals > 1 ? std::sqrt(intervalSquares / static_cast<double>(intervals - 1)) : 0.0;
+
+    if (intervals == 1) {
+        current.minIntervalNs = interval;
+        current.maxIntervalNs = interval;
+        current.recentIntervalNs = interval;
+    } else {
+        current.minIntervalNs = std::min(current.minIntervalNs, interval);
+        current.maxIntervalNs = std::max(current.maxIntervalNs, interval);
+        current.recentIntervalNs += (interval - current.recentIntervalNs) / RecentFrames;
+    }
+}
+
+void FrameTiming::reset() {
+    current = FrameTimingStats{};
+    lastSequence = 0;
+    lastTimestampNs = 0;
+    intervals = 0;
+    intervalSquares = 0.0;
+}
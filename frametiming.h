@@ -0,0 +1,45 @@
+#ifndef FRAMETIMING_H
+#define FRAMETIMING_H
+
+#include <cstdint>
+
+struct FrameTimingStats {
+    uint64_t frames = 0;         // Frames seen
+    uint64_t missingFrames = 0;  // Sequence numbers skipped between them
+    uint64_t gaps = 0;           // Places where at least one was skipped
+    double meanIntervalNs = 0.0;
+    double jitterNs = 0.0;       // Standard deviation of the interval
+    double minIntervalNs = 0.0;
+    double maxIntervalNs = 0.0;
+    double recentIntervalNs = 0.0;  // Moving average over roughly the last RecentFrames frames
+
+    double frameRate() const { return meanIntervalNs > 0.0 ? 1e9 / meanIntervalNs : 0.0; }
+    double recentFrameRate() const { return recentIntervalNs > 0.0 ? 1e9 / recentIntervalNs : 0.0; }
+    bool isLossless() const { return missingFrames == 0; }
+};
+
+// Frame rate, jitter and losses of a stream, worked out from the sequence
+// numbers and timestamps the frames carry, so live acquisitions and
+// recordings are judged the same way. A gap of n sequence numbers counts n
+// missing frames, and its interval is spread over the n + 1 frame periods
+// it covers so the losses don't inflate the jitter. Interval statistics are
+// kept with Welford's update, which stays accurate over long runs.
+class FrameTiming
+{
+public:
+    static constexpr int RecentFrames = 64;
+
+    void record(uint64_t sequence, int64_t timestampNs);
+    void reset();
+
+    const FrameTimingStats& stats() const { return current; }
+
+private:
+    FrameTimingStats current;
+    uint64_t lastSequence = 0;
+    int64_t lastTimestampNs = 0;
+    uint64_t intervals = 0;
+    double intervalSquares = 0.0;  // Sum of squared deviations from the mean
+};
+
+#endif // FRAMETIMING_H
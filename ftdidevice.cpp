@@ -0,0 +1,231 @@
+#include "ftdidevice.h"
+#include <map>
+#include <stdexcept>
+#ifndef _WIN32
+#include <ctime>
+#include <pthread.h>
+#endif
+
+namespace {
+
+// Channel serial numbers are the head's with the channel letter appended
+std::string headSerial(const std::string& channelSerial) {
+    return channelSerial.size() > 1 ? channelSerial.substr(0, channelSerial.size() - 1) : channelSerial;
+}
+
+} // namespace
+
+std::vector<FtdiDevice::Head> FtdiDevice::enumerate() {
+    DWORD count = 0;
+    if (FT_CreateDeviceInfoList(&count) != FT_OK) {
+        throw std::runtime_error("Failed to list FTDI devices");
+    }
+    std::vector<FT_DEVICE_LIST_INFO_NODE> nodes(count);
+    if (count > 0 && FT_GetDeviceInfoList(nodes.data(), &count) != FT_OK) {
+        throw std::runtime_error("Failed to list FTDI devices");
+    }
+    nodes.resize(count);
+
+    // Channels open in another process report neither serial nor description
+    std::map<std::string, Head> heads;
+    for (const FT_DEVICE_LIST_INFO_NODE& node : nodes) {
+        const std::string description = node.Description;
+        const std::string channelSerial = node.SerialNumber;
+        const bool command = description == CommandDescription;
+        if (channelSerial.empty() || (!command && description != DataDescription)) {
+            continue;
+        }
+        Head& head = heads[headSerial(channelSerial)];
+        head.serialNumber = headSerial(channelSerial);
+        (command ? head.commandChannel : head.dataChannel) = channelSerial;
+    }
+
+    std::vector<Head> complete;
+    for (const auto& [serialNumber, head] : heads) {
+        if (!head.commandChannel.empty() && !head.dataChannel.empty()) {
+            complete.push_back(head);
+        }
+    }
+    return complete;
+}
+
+FtdiDevice::FtdiDevice(std::string commandChannel, std::string dataChannel, OpenBy openBy) :
+    commandChannel(std::move(commandChannel)),
+    dataChannel(std::move(dataChannel)),
+    openBy(openBy)
+{
+}
+
+FtdiDevice::FtdiDevice(const Head& head) :
+    FtdiDevice(head.commandChannel, head.dataChannel, OpenBy::SerialNumber)
+{
+    serial = head.serialNumber;
+}
+
+FtdiDevice::~FtdiDevice() {
+    close();
+}
+
+FT_HANDLE FtdiDevice::openChannel(const std::string& name) const {
+    FT_HANDLE handle = nullptr;
+    FT_STATUS status = FT_OpenEx(reinterpret_cast<PVOID>(const_cast<char*>(name.c_str())),
+                                 openBy == OpenBy::SerialNumber ? FT_OPEN_BY_SERIAL_NUMBER : FT_OPEN_BY_DESCRIPTION,
+                                 &handle);
+    if (status != FT_OK) {
+        throw std::runtime_error("Failed to open " + name + " device. Error: " + std::to_string(status));
+    }
+    return handle;
+}
+
+void FtdiDevice::open() {
+    close();
+
+    fthandle_uart = openChannel(commandChannel);
+    try {
+        ftHandle = openChannel(dataChannel);
+    } catch (...) {
+        close();
+        throw;
+    }
+
+    // Opened by description, the serial number is only known now
+    if (openBy == OpenBy::Description) {
+        FT_DEVICE type;
+        DWORD id = 0;
+        char channelSerial[16] = {};
+        char description[64] = {};
+        if (FT_GetDeviceInfo(fthandle_uart, &type, &id, channelSerial, description, nullptr) == FT_OK) {
+            serial = headSerial(channelSerial);
+        }
+    }
+
+    if (FT_SetBaudRate(fthandle_uart, 9600) != FT_OK) {
+        close();
+        throw std::runtime_error("Failed to set baud rate");
+    }
+    if (FT_ResetDevice(fthandle_uart) != FT_OK) {
+        close();
+        throw std::runtime_error("Failed to reset device");
+    }
+
+    // Let the driver wake waitForData() as soon as characters arrive
+#ifdef _WIN32
+    rxEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    FT_SetEventNotification(ftHandle, FT_EVENT_RXCHAR, rxEvent);
+#else
+    pthread_mutex_init(&rxEvent.eMutex, nullptr);
+    pthread_cond_init(&rxEvent.eCondVar, nullptr);
+    rxEventReady = true;
+    cancelRequested = false;
+    FT_SetEventNotification(ftHandle, FT_EVENT_RXCHAR, static_cast<PVOID>(&rxEvent));
+#endif
+}
+
+void FtdiDevice::close() {
+    if (ftHandle != nullptr) {
+        FT_SetEventNotification(ftHandle, 0, nullptr);
+#ifdef _WIN32
+        if (rxEvent != nullptr) {
+            CloseHandle(rxEvent);
+            rxEvent = nullptr;
+        }
+#else
+        if (rxEventReady) {
+            pthread_cond_destroy(&rxEvent.eCondVar);
+            pthread_mutex_destroy(&rxEvent.eMutex);
+            rxEventReady = false;
+        }
+#endif
+        FT_Close(ftHandle);
+        ftHandle = nullptr;
+    }
+    if (fthandle_uart != nullptr) {
+        FT_Close(fthandle_uart);
+        fthandle_uart = nullptr;
+    }
+}
+
+bool FtdiDevice::writeCommand(const void* data, uint32_t size) {
+    DWORD bytesWritten = 0;
+    FT_STATUS status = FT_Write(fthandle_uart, const_cast<void*>(data), size, &bytesWritten);
+    return status == FT_OK && bytesWritten == size;
+}
+
+bool FtdiDevice::readCommandResponse(char& response) {
+    // FT_Read would block until the byte arrives; the caller polls instead
+    DWORD queued = 0;
+    if (FT_GetQueueStatus(fthandle_uart, &queued) != FT_OK || queued == 0) {
+        return false;
+    }
+    DWORD bytesRead = 0;
+    FT_STATUS status = FT_Read(fthandle_uart, &response, 1, &bytesRead);
+    return status == FT_OK && bytesRead == 1;
+}
+
+void FtdiDevice::purgeCommandChannel() {
+    FT_Purge(fthandle_uart, FT_PURGE_RX | FT_PURGE_TX);
+}
+
+uint32_t FtdiDevice::queuedBytes() const {
+    DWORD bytesAvailable = 0;
+    if (FT_GetQueueStatus(ftHandle, &bytesAvailable) != FT_OK) {
+        return 0;
+    }
+    return bytesAvailable;
+}
+
+uint32_t FtdiDevice::waitForData(int timeoutMs) {
+    uint32_t available = queuedBytes();
+    if (available > 0) {
+        return available;
+    }
+
+    // Nothing queued: sleep until the driver signals received characters.
+    // The timeout bounds the latency of an event raised before we waited.
+#ifdef _WIN32
+    WaitForSingleObject(rxEvent, static_cast<DWORD>(timeoutMs));
+#else
+    timespec deadline{};
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += static_cast<long>(timeoutMs) * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    pthread_mutex_lock(&rxEvent.eMutex);
+    if (!cancelRequested) {
+        pthread_cond_timedwait(&rxEvent.eCondVar, &rxEvent.eMutex, &deadline);
+    }
+    cancelRequested = false;
+    pthread_mutex_unlock(&rxEvent.eMutex);
+#endif
+
+    return queuedBytes();
+}
+
+void FtdiDevice::cancelWait() {
+#ifdef _WIN32
+    SetEvent(rxEvent);
+#else
+    if (!rxEventReady) {
+        return;
+    }
+    pthread_mutex_lock(&rxEvent.eMutex);
+    cancelRequested = true;
+    pthread_cond_broadcast(&rxEvent.eCondVar);
+    pthread_mutex_unlock(&rxEvent.eMutex);
+#endif
+}
+
+bool FtdiDevice::readData(uint8_t* destination, uint32_t maxBytes, uint32_t& bytesRead) {
+    DWORD read = 0;
+    FT_STATUS status = FT_Read(ftHandle, destination, maxBytes, &read);
+    bytesRead = read;
+    return status == FT_OK;
+}
+
+bool FtdiDevice::purgeDataChannel() {
+    return FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX) == FT_OK;
+}
+
+bool FtdiDevice::resetDataChannel() {
+    return FT_ResetDevice(ftHandle) == FT_OK;
+}
@@ -0,0 +1,78 @@
+#ifndef FTDIDEVICE_H
+#define FTDIDEVICE_H
+
+#include <string>
+#include <vector>
+#include "ftd2xx.h"
+#include "spectrometerdevice.h"
+
+// Spectrometer head attached through the FTDI D2XX driver: channel A is the
+// 9600 baud command UART, channel B the frame stream.
+class FtdiDevice final : public SpectrometerDevice
+{
+public:
+    // What the channel names given to the constructor are
+    enum class OpenBy { Description, SerialNumber };
+
+    // A head on the bus. The FT2232H reports each channel as a device of
+    // its own, with the MD_HS_V1 A/B description and the head's serial
+    // number followed by A or B.
+    struct Head {
+        std::string serialNumber;
+        std::string commandChannel;  // Channel serial numbers
+        std::string dataChannel;
+    };
+
+    static constexpr const char* CommandDescription = "MD_HS_V1 A";
+    static constexpr const char* DataDescription = "MD_HS_V1 B";
+
+    // Heads with both channels attached and not open elsewhere, by serial
+    // number. Throws std::runtime_error when the driver cannot list devices.
+    static std::vector<Head> enumerate();
+
+    // By description, the first head the driver finds is opened
+    explicit FtdiDevice(std::string commandChannel = CommandDescription,
+                        std::string dataChannel = DataDescription,
+                        OpenBy openBy = OpenBy::Description);
+    explicit FtdiDevice(const Head& head);
+    ~FtdiDevice() override;
+
+    void open() override;
+    void close() override;
+    bool isOpen() const override { return ftHandle != nullptr && fthandle_uart != nullptr; }
+    std::string serialNumber() const override { return serial; }
+
+    bool writeCommand(const void* data, uint32_t size) override;
+    bool readCommandResponse(char& response) override;
+    void purgeCommandChannel() override;
+
+    uint32_t waitForData(int timeoutMs) override;
+    void cancelWait() override;
+    bool readData(uint8_t* destination, uint32_t maxBytes, uint32_t& bytesRead) override;
+    bool purgeDataChannel() override;
+    bool resetDataChannel() override;
+
+private:
+    FT_HANDLE openChannel(const std::string& name) const;
+    uint32_t queuedBytes() const;
+
+    std::string commandChannel;
+    std::string dataChannel;
+    OpenBy openBy;
+    std::string serial;
+    FT_HANDLE ftHandle = nullptr;
+    FT_HANDLE fthandle_uart = nullptr;
+
+#ifdef _WIN32
+    HANDLE rxEvent = nullptr;
+#else
+    // The mutex and condition exist only between open() and close(); the
+    // flag, guarded by the mutex, keeps a cancelWait() that comes before the
+    // wait from being lost
+    EVENT_HANDLE rxEvent{};
+    bool rxEventReady = false;
+    bool cancelRequested = false;
+#endif
+};
+
+#endif // FTDIDEVICE_H
@@ -0,0 +1,543 @@
+#include "headlessacquisition.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "acquisitionworker.h"
+#include "devicecommandqueue.h"
+#include "framerecorder.h"
+#include "pipelinetelemetry.h"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr int PollMs = 10;
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    const auto ticks = [](const FILETIME& time) {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return static_cast<double>(ticks(kernel) + ticks(user)) / 1e7;  // 100 ns units
+#else
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    const auto seconds = [](const timeval& time) { return time.tv_sec + time.tv_usec / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#endif
+}
+
+void requireSuccess(const DeviceCommandResult& result) {
+    if (!result.succeeded) {
+        throw std::runtime_error(std::string(result.command.name()) + " failed: " + result.error);
+    }
+}
+
+template<typename T>
+void appendNumber(std::string& text, T value) {
+    char digits[24];
+    const std::to_chars_result end = std::to_chars(digits, digits + sizeof(digits), value);
+    text.append(digits, end.ptr);
+}
+
+// sequence,timestamp_ns,exposure_us,pixel_0,...,pixel_1041
+void appendCsvLine(std::string& text, const SpectrumFrame& frame) {
+    appendNumber(text, frame.sequence);
+    text += ',';
+    appendNumber(text, frame.timestampNs);
+    text += ',';
+    appendNumber(text, frame.exposureTime);
+    for (const uint16_t sample : frame.pixels) {
+        text += ',';
+        appendNumber(text, sample);
+    }
+    text += '\n';
+}
+
+// sequence,timestamp_ns,pixel,centre,height,prominence,fwhm,area per peak
+// With a calibration, each line ends with the centre and FWHM in `unit`,
+// looked up in its table
+void appendPeakLines(std::string& text, const SpectrumFrame& frame, const std::vector<SpectrumPeak>& peaks,
+                     const WavelengthCalibration* calibration, SpectralUnit unit) {
+    char line[200];
+    for (const SpectrumPeak& peak : peaks) {
+        int length = std::snprintf(line, sizeof(line), "%llu,%lld,%d,%.3f,%.0f,%.0f,%.3f,%.1f",
+                                   static_cast<unsigned long long>(frame.sequence),
+                                   static_cast<long long>(frame.timestampNs), peak.pixel, peak.centre,
+                                   peak.height, peak.prominence, peak.fwhm, peak.area);
+        if (length > 0 && calibration != nullptr) {
+            const double fwhm = std::abs(calibration->valueAt(peak.rightHalf, unit)
+                                         - calibration->valueAt(peak.leftHalf, unit));
+            length += std::snprintf(line + length, sizeof(line) - static_cast<std::size_t>(length), ",%.4f,%.4f",
+                                    calibration->valueAt(peak.centre, unit), fwhm);
+        }
+        if (length > 0) {
+            text.append(line, static_cast<std::size_t>(std::min<int>(length, sizeof(line) - 2)));
+            text += '\n';
+        }
+    }
+}
+
+std::string csvHeader() {
+    std::string header = "sequence,timestamp_ns,exposure_us";
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        header += ",pixel_" + std::to_string(pixel);
+    }
+    header += '\n';
+    return header;
+}
+
+// "--name value" or "--name=value"
+bool takeValue(int argc, char* argv[], int& index, const std::string& name, std::string& value) {
+    const std::string argument = argv[index];
+    if (argument == name) {
+        if (index + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + name);
+        }
+        value = argv[++index];
+        return true;
+    }
+    if (argument.compare(0, name.size() + 1, name + "=") == 0) {
+        value = argument.substr(name.size() + 1);
+        return true;
+    }
+    return false;
+}
+
+double parseNumber(const std::string& name, const std::string& value, double minimum) {
+    std::size_t used = 0;
+    double number = 0.0;
+    try {
+        number = std::stod(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || value.empty() || !(number >= minimum)) {
+        throw std::runtime_error("Invalid value for " + name + ": " + value);
+    }
+    return number;
+}
+
+uint64_t parseCount(const std::string& name, const std::string& value) {
+    uint64_t number = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (error != std::errc() || end != value.data() + value.size() || value.empty()) {
+        throw std::runtime_error("Invalid value for " + name + ": " + value);
+    }
+    return number;
+}
+
+} // namespace
+
+std::string headlessUsage(const std::string& program) {
+    return "Usage: " + program + " [options]\n"
+           "Acquires spectra without the GUI and records them to a file or stdout.\n"
+           "\n"
+           "  --exposure <us>       Exposure time in microseconds (default 10000)\n"
+           "  --duration <s>        Stop after this many seconds\n"
+           "  --frames <n>          Stop after this many frames\n"
+           "  --output <file>       Record to a .lsvrec file\n"
+           "  --stdout              Write one CSV line per frame to stdout (one spectrometer only)\n"
+           "  --peaks <file>        Write the peaks found in every frame to a CSV file\n"
+           "                        (one spectrometer only)\n"
+           "  --prominence <counts> Smallest peak prominence (default 500)\n"
+           "  --centroid            Peak centres by centroid instead of a parabola fit\n"
+           "  --calibration <file>  Device profile whose wavelength calibration adds each\n"
+           "                        peak's centre and FWHM in nm to the peak log\n"
+           "  --raman               Add them as Raman shift from the profile's laser line\n"
+           "  --serial <serial>     Acquire from this spectrometer; repeat for several\n"
+           "                        (default: every spectrometer attached)\n"
+           "  --simulate            Use a simulated spectrometer instead of the FTDI device\n"
+           "  --sim-devices <n>     Number of simulated spectrometers (implies --simulate)\n"
+           "  --sim-fps <fps>       Simulated frame rate, 0 for as fast as possible (default 100)\n"
+           "  --sim-loss <rate>     Probability per frame of losing bytes in transit\n"
+           "  --sim-misalign <rate> Probability per frame of stray bytes before the header\n"
+           "  -h, --help            Show this help\n"
+           "\n"
+           "Without --duration or --frames the acquisition runs until interrupted.\n"
+           "With several spectrometers --frames applies to each, and every recording\n"
+           "but the first gets the serial number appended to its file name.\n"
+           "The report is printed to stderr on exit; the exit code is 3 when frames\n"
+           "were lost in the stream or dropped on the way to the output.\n";
+}
+
+bool parseHeadlessArguments(int argc, char* argv[], HeadlessOptions& options) {
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        std::string value;
+        if (argument == "-h" || argument == "--help") {
+            return false;
+        } else if (argument == "--stdout") {
+            options.writeToStdout = true;
+        } else if (argument == "--centroid") {
+            options.peaks.centre = PeakCentre::Centroid;
+        } else if (argument == "--raman") {
+            options.peakUnit = SpectralUnit::RamanShift;
+        } else if (takeValue(argc, argv, index, "--calibration", value)) {
+            options.calibrationPath = value;
+        } else if (takeValue(argc, argv, index, "--peaks", value)) {
+            options.peaksPath = value;
+        } else if (takeValue(argc, argv, index, "--prominence", value)) {
+            options.peaks.minProminence = parseNumber("--prominence", value, 0.0);
+        } else if (argument == "--simulate") {
+            options.devices.simulate = true;
+        } else if (takeValue(argc, argv, index, "--serial", value)) {
+            if (value.empty()) {
+                throw std::runtime_error("Invalid value for --serial: " + value);
+            }
+            options.devices.serialNumbers.push_back(value);
+        } else if (takeValue(argc, argv, index, "--sim-devices", value)) {
+            const uint64_t count = parseCount("--sim-devices", value);
+            if (count == 0 || count > 64) {
+                throw std::runtime_error("Invalid value for --sim-devices: " + value);
+            }
+            options.devices.simulate = true;
+            options.devices.simulatedDevices = static_cast<int>(count);
+        } else if (takeValue(argc, argv, index, "--exposure", value)) {
+            const uint64_t exposure = parseCount("--exposure", value);
+            if (exposure > UINT32_MAX) {
+                throw std::runtime_error("Invalid value for --exposure: " + value);
+            }
+            options.exposureTime = static_cast<uint32_t>(exposure);
+        } else if (takeValue(argc, argv, index, "--duration", value)) {
+            options.durationSeconds = parseNumber("--duration", value, 0.0);
+        } else if (takeValue(argc, argv, index, "--frames", value)) {
+            options.frameLimit = parseCount("--frames", value);
+        } else if (takeValue(argc, argv, index, "--output", value)) {
+            options.recordingPath = value;
+        } else if (takeValue(argc, argv, index, "--sim-fps", value)) {
+            options.devices.simulation.frameRate = parseNumber("--sim-fps", value, 0.0);
+        } else if (takeValue(argc, argv, index, "--sim-loss", value)) {
+            options.devices.simulation.byteLossRate = parseNumber("--sim-loss", value, 0.0);
+        } else if (takeValue(argc, argv, index, "--sim-misalign", value)) {
+            options.devices.simulation.misalignmentRate = parseNumber("--sim-misalign", value, 0.0);
+        } else {
+            throw std::runtime_error("Unknown option " + argument);
+        }
+    }
+    return true;
+}
+
+bool HeadlessSummary::framesMissing() const {
+    return std::any_of(devices.begin(), devices.end(), [](const HeadlessDeviceSummary& device) {
+        return device.framesLost > 0 || device.framesDropped > 0 || device.recorderDropped > 0;
+    });
+}
+
+HeadlessAcquisition::HeadlessAcquisition(std::vector<std::unique_ptr<SpectrometerDevice>> spectrometers,
+                                         HeadlessOptions acquisitionOptions) :
+    options(std::move(acquisitionOptions))
+{
+    for (std::unique_ptr<SpectrometerDevice>& spectrometer : spectrometers) {
+        pipelines.push_back(std::make_unique<SpectrometerPipeline>(std::move(spectrometer)));
+    }
+}
+
+HeadlessSummary HeadlessAcquisition::run(const std::atomic<bool>& interrupt, std::ostream& log,
+                                         std::ostream& frameOutput) {
+    using Clock = std::chrono::steady_clock;
+
+    if (pipelines.empty()) {
+        throw std::runtime_error("No spectrometer to acquire from");
+    }
+    if (options.writeToStdout && pipelines.size() > 1) {
+        throw std::runtime_error("--stdout takes the frames of one spectrometer; choose it with --serial");
+    }
+    if (!options.peaksPath.empty() && pipelines.size() > 1) {
+        throw std::runtime_error("--peaks takes the frames of one spectrometer; choose it with --serial");
+    }
+    const bool logPeaks = !options.peaksPath.empty();
+    if (!options.calibrationPath.empty() && !logPeaks) {
+        throw std::runtime_error("--calibration applies to the peak log; add --peaks");
+    }
+
+    // Expanded into its tables here, before any frame arrives
+    WavelengthCalibration calibration;
+    const bool calibrated = !options.calibrationPath.empty();
+    if (calibrated) {
+        calibration = loadWavelengthCalibration(options.calibrationPath);
+        if (!calibration.supports(options.peakUnit)) {
+            throw std::runtime_error(options.calibrationPath.string()
+                                     + (calibration.isCalibrated() ? " has no laser wavelength for --raman"
+                                                                   : " has no wavelength calibration"));
+        }
+    }
+    const bool consumeFrames = options.writeToStdout || logPeaks;
+
+    // Every head gets the command before any result is awaited, so the
+    // heads start and stop together rather than one after the other
+    const auto runCommands = [&](const DeviceCommand& command) {
+        std::vector<std::promise<DeviceCommandResult>> promises(pipelines.size());
+        for (std::size_t index = 0; index < pipelines.size(); ++index) {
+            std::promise<DeviceCommandResult>& promise = promises[index];
+            pipelines[index]->commands().submit(command, [&promise](const DeviceCommandResult& finished) {
+                promise.set_value(finished);
+            });
+        }
+        std::vector<DeviceCommandResult> results;
+        for (std::promise<DeviceCommandResult>& promise : promises) {
+            results.push_back(promise.get_future().get());
+        }
+        return results;
+    };
+    const auto requireAll = [&](const DeviceCommand& command) {
+        for (const DeviceCommandResult& result : runCommands(command)) {
+            requireSuccess(result);
+        }
+    };
+
+    // The worker wakes the stdout writer and the peak search the way it
+    // wakes the GUI; both see every frame under the lossless policy
+    AcquisitionWorker& first = pipelines.front()->worker();
+    std::mutex readyMutex;
+    std::condition_variable readyCondition;
+    bool framesReady = false;
+    std::string text;
+    std::string peakText;
+    std::vector<SpectrumPeak> peaks;
+    std::ofstream peakLog;
+    uint64_t framesWritten = 0;
+    uint64_t peaksLogged = 0;
+    const auto writeFrames = [&]() {
+        first.acknowledgeFrames();
+        text.clear();
+        peakText.clear();
+        first.drainFrames([&](const SpectrumFrame& frame) {
+            if (options.writeToStdout) {
+                appendCsvLine(text, frame);
+            }
+            if (logPeaks) {
+                detectPeaks(frame.pixels.data(), frame.pixels.size(), 0, options.peaks, peaks);
+                appendPeakLines(peakText, frame, peaks, calibrated ? &calibration : nullptr, options.peakUnit);
+                peaksLogged += peaks.size();
+            }
+            ++framesWritten;
+        }, nullptr);
+        if (!text.empty()) {
+            frameOutput.write(text.data(), static_cast<std::streamsize>(text.size()));
+            frameOutput.flush();
+        }
+        if (!peakText.empty()) {
+            peakLog.write(peakText.data(), static_cast<std::streamsize>(peakText.size()));
+        }
+    };
+    const auto allLimitsReached = [&]() {
+        return std::all_of(pipelines.begin(), pipelines.end(), [](const std::unique_ptr<SpectrometerPipeline>& pipeline) {
+            return pipeline->worker().frameLimitReached();
+        });
+    };
+
+    HeadlessSummary summary;
+    try {
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            pipeline->open();
+        }
+
+        // The heads may have been left streaming
+        requireAll(DeviceCommand::triggerOff());
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            if (!pipeline->device().purgeDataChannel()) {
+                log << "Warning: purging the data channel of " << pipeline->serialNumber() << " failed\n";
+            }
+        }
+
+        if (!options.recordingPath.empty()) {
+            for (std::size_t index = 0; index < pipelines.size(); ++index) {
+                SpectrometerPipeline& pipeline = *pipelines[index];
+                pipeline.recorder().open(index == 0 ? options.recordingPath
+                                                    : devicePath(options.recordingPath, pipeline.serialNumber()));
+            }
+        }
+        if (options.writeToStdout) {
+            const std::string header = csvHeader();
+            frameOutput.write(header.data(), static_cast<std::streamsize>(header.size()));
+        }
+        if (logPeaks) {
+            peakLog.open(options.peaksPath, std::ios::binary | std::ios::trunc);
+            if (!peakLog) {
+                throw std::runtime_error("Cannot create " + options.peaksPath.string());
+            }
+            peakLog << "sequence,timestamp_ns,pixel,centre,height,prominence,fwhm,area";
+            if (calibrated) {
+                const std::string symbol = spectralUnitSymbol(options.peakUnit);
+                peakLog << ",centre_" << symbol << ",fwhm_" << symbol;
+            }
+            peakLog << '\n';
+        }
+
+        AcquisitionWorker::FramesReadyCallback onFramesReady;
+        if (consumeFrames) {
+            onFramesReady = [&]() {
+                {
+                    std::lock_guard<std::mutex> lock(readyMutex);
+                    framesReady = true;
+                }
+                readyCondition.notify_one();
+            };
+        }
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            AcquisitionWorker& worker = pipeline->worker();
+            FrameRecorder& recorder = pipeline->recorder();
+            worker.setOverloadPolicy(AcquisitionWorker::OverloadPolicy::Lossless);
+            worker.setExposureTime(options.exposureTime);
+            worker.setFrameLimit(options.frameLimit);
+            worker.start(&pipeline->device(), onFramesReady, recorder.isOpen() ? &recorder : nullptr);
+        }
+
+        requireAll(DeviceCommand::setExposure(options.exposureTime));
+        DeviceCommand triggerOn = DeviceCommand::triggerOn();
+        triggerOn.delayMs = TriggerSettleMs;
+        requireAll(triggerOn);
+
+        const Clock::time_point started = Clock::now();
+        const double cpuStarted = processCpuSeconds();
+        const auto deadline = started + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(options.durationSeconds));
+        log << "Acquiring from " << pipelines.size() << (pipelines.size() == 1 ? " spectrometer" : " spectrometers")
+            << " with " << options.exposureTime << " us exposure\n";
+
+        while (!interrupt.load(std::memory_order_relaxed) && !allLimitsReached() &&
+               (options.durationSeconds <= 0.0 || Clock::now() < deadline)) {
+            if (!consumeFrames) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(PollMs));
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCondition.wait_for(lock, std::chrono::milliseconds(PollMs), [&] { return framesReady; });
+            const bool drain = framesReady;
+            framesReady = false;
+            lock.unlock();
+            if (drain) {
+                writeFrames();
+            }
+        }
+
+        const std::vector<DeviceCommandResult> stopped = runCommands(DeviceCommand::triggerOff());
+        summary.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        for (std::size_t index = 0; index < pipelines.size(); ++index) {
+            if (!stopped[index].succeeded) {
+                log << "Warning: stopping the trigger of " << pipelines[index]->serialNumber()
+                    << " failed: " << stopped[index].error << "\n";
+            }
+        }
+
+        // Whatever the workers had queued still goes out
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            pipeline->worker().stop();
+        }
+        if (consumeFrames) {
+            writeFrames();
+        }
+        if (logPeaks) {
+            peakLog.close();
+            if (!peakLog) {
+                log << "Error: the peak log is incomplete\n";
+            }
+        }
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            FrameRecorder& recorder = pipeline->recorder();
+            if (!recorder.close()) {
+                log << "Error: the recording of " << pipeline->serialNumber()
+                    << " is incomplete: " << recorder.errorMessage() << "\n";
+            }
+        }
+        summary.cpuSeconds = processCpuSeconds() - cpuStarted;
+    } catch (...) {
+        for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            pipeline->close();
+        }
+        throw;
+    }
+
+    for (std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        const TelemetrySnapshot telemetry =
+            collectTelemetry(pipeline->worker(), &pipeline->recorder(), &pipeline->commands());
+        const FrameTimingStats timing = pipeline->worker().timingStats();
+        HeadlessDeviceSummary device;
+        device.serialNumber = pipeline->serialNumber();
+        device.bytesRead = telemetry.bytesRead;
+        device.framesParsed = telemetry.framesParsed;
+        device.framesPastLimit = pipeline->worker().framesPastLimit();
+        device.framesLost = telemetry.framesLost;
+        device.framesDropped = telemetry.framesDropped;
+        device.resyncs = telemetry.resyncs;
+        device.framesRejected = telemetry.framesRejected;
+        device.framesRecorded = telemetry.framesRecorded;
+        device.recorderDropped = telemetry.recorderDropped;
+        device.bytesRecorded = telemetry.bytesRecorded;
+        device.frameRate = timing.frameRate();
+        device.jitterMs = timing.jitterNs / 1e6;
+        summary.devices.push_back(device);
+        pipeline->close();
+    }
+    summary.devices.front().framesWritten = framesWritten;
+    summary.devices.front().peaksLogged = peaksLogged;
+    return summary;
+}
+
+std::string formatHeadlessSummary(const HeadlessSummary& summary) {
+    const double seconds = summary.seconds > 0.0 ? summary.seconds : 1.0;
+    char line[256];
+    std::string report;
+    const auto append = [&](int length) {
+        if (length > 0) {
+            report.append(line, static_cast<std::size_t>(std::min<int>(length, sizeof(line) - 1)));
+        }
+    };
+
+    // With several heads each block is headed by its serial number
+    for (const HeadlessDeviceSummary& device : summary.devices) {
+        if (summary.devices.size() > 1) {
+            report += device.serialNumber + ":\n";
+        }
+        append(std::snprintf(line, sizeof(line), "Acquired %llu frames in %.2f s: %.1f frames/s (jitter %.3f ms), %.2f MB/s\n",
+                             static_cast<unsigned long long>(device.framesParsed), summary.seconds, device.frameRate,
+                             device.jitterMs, device.bytesRead / 1e6 / seconds));
+        if (device.framesPastLimit > 0) {
+            append(std::snprintf(line, sizeof(line), "Discarded %llu frames that arrived after the frame limit\n",
+                                 static_cast<unsigned long long>(device.framesPastLimit)));
+        }
+        append(std::snprintf(line, sizeof(line), "Lost in the stream %llu, resyncs %llu (%llu frames rejected)\n",
+                             static_cast<unsigned long long>(device.framesLost),
+                             static_cast<unsigned long long>(device.resyncs),
+                             static_cast<unsigned long long>(device.framesRejected)));
+        if (device.framesRecorded > 0 || device.recorderDropped > 0) {
+            append(std::snprintf(line, sizeof(line), "Recorded %llu frames (%.2f MB), %llu dropped by the writer\n",
+                                 static_cast<unsigned long long>(device.framesRecorded), device.bytesRecorded / 1e6,
+                                 static_cast<unsigned long long>(device.recorderDropped)));
+        }
+        if (device.framesWritten > 0 || device.framesDropped > 0) {
+            append(std::snprintf(line, sizeof(line), "Wrote %llu frames to stdout or the peak log, %llu dropped\n",
+                                 static_cast<unsigned long long>(device.framesWritten),
+                                 static_cast<unsigned long long>(device.framesDropped)));
+        }
+        if (device.peaksLogged > 0) {
+            append(std::snprintf(line, sizeof(line), "Logged %llu peaks (%.2f per frame)\n",
+                                 static_cast<unsigned long long>(device.peaksLogged),
+                                 device.framesWritten > 0 ? static_cast<double>(device.peaksLogged) / device.framesWritten : 0.0));
+        }
+    }
+    append(std::snprintf(line, sizeof(line), "CPU time %.2f s (%.1f%% of one core)\n", summary.cpuSeconds,
+                         100.0 * summary.cpuSeconds / seconds));
+    return report;
+}
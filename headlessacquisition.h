@@ -0,0 +1,95 @@
+#ifndef HEADLESSACQUISITION_H
+#define HEADLESSACQUISITION_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "peakdetection.h"
+#include "spectrometerpipeline.h"
+#include "wavelengthcalibration.h"
+
+struct HeadlessOptions {
+    uint32_t exposureTime = 10000;    // Microseconds
+    double durationSeconds = 0.0;     // 0: until the frame limit or an interrupt
+    uint64_t frameLimit = 0;          // Per head; 0: until the duration or an interrupt
+    std::filesystem::path recordingPath;  // .lsvrec recording, empty for none
+    bool writeToStdout = false;       // One CSV line per frame, single head only
+    std::filesystem::path peaksPath;  // CSV of the peaks found in every frame, single head only
+    PeakDetectionSettings peaks;
+    std::filesystem::path calibrationPath;  // Device profile whose calibration the peak log adds
+    SpectralUnit peakUnit = SpectralUnit::Wavelength;
+    DeviceSelection devices;
+};
+
+// Parses the LaserSpectraVueHeadless command line. Returns false when only
+// the usage was asked for; throws std::runtime_error on invalid arguments.
+bool parseHeadlessArguments(int argc, char* argv[], HeadlessOptions& options);
+std::string headlessUsage(const std::string& program);
+
+// Totals of one head over a headless run
+struct HeadlessDeviceSummary {
+    std::string serialNumber;
+    uint64_t bytesRead = 0;
+    uint64_t framesParsed = 0;
+    uint64_t framesPastLimit = 0;  // Arrived after --frames was reached and were discarded
+    uint64_t framesLost = 0;
+    uint64_t framesDropped = 0;  // Queue to the stdout writer full
+    uint64_t resyncs = 0;
+    uint64_t framesRejected = 0;
+    uint64_t framesRecorded = 0;
+    uint64_t recorderDropped = 0;
+    uint64_t bytesRecorded = 0;
+    uint64_t framesWritten = 0;  // To stdout or the peak log
+    uint64_t peaksLogged = 0;
+    double frameRate = 0.0;      // From the frame timestamps
+    double jitterMs = 0.0;
+};
+
+// Totals of one headless run, for the report printed on exit
+struct HeadlessSummary {
+    double seconds = 0.0;  // Trigger on to trigger off
+    double cpuSeconds = 0.0;
+    std::vector<HeadlessDeviceSummary> devices;
+
+    // True when any head lost frames in the stream or dropped them on the
+    // way to an output
+    bool framesMissing() const;
+};
+
+// One acquisition without the GUI, built from the same pieces MainWindow
+// uses: per head, the command queue sets the exposure and switches the
+// trigger, the acquisition worker parses the data channel and the recorder
+// streams frames to disk from the worker thread. Several heads run side by
+// side, each in its own SpectrometerPipeline, and are commanded together;
+// the first records to the given path and the others to devicePath() of
+// it. Nothing is drawn, so the only per-frame work is parsing, decoding and
+// writing. Frames for stdout go through the worker's queue under the
+// lossless policy, so a slow reader makes the worker hold frames back
+// rather than lose them silently; the recording never waits for it.
+//
+// run() opens the devices, acquires until a limit is reached or `interrupt`
+// is set (which a signal handler may do), then stops the sensors and closes
+// everything again. Throws std::runtime_error when a device or a recording
+// file cannot be set up or a command fails.
+class HeadlessAcquisition
+{
+public:
+    static constexpr int TriggerSettleMs = 100;
+
+    HeadlessAcquisition(std::vector<std::unique_ptr<SpectrometerDevice>> spectrometers,
+                        HeadlessOptions acquisitionOptions);
+
+    HeadlessSummary run(const std::atomic<bool>& interrupt, std::ostream& log, std::ostream& frameOutput);
+
+private:
+    std::vector<std::unique_ptr<SpectrometerPipeline>> pipelines;
+    HeadlessOptions options;
+};
+
+std::string formatHeadlessSummary(const HeadlessSummary& summary);
+
+#endif // HEADLESSACQUISITION_H
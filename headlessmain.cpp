@@ -0,0 +1,47 @@
+#include "headlessacquisition.h"
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+std::atomic<bool> interrupted{false};
+
+// Ctrl+C ends the acquisition normally, with the recording closed and the
+// report printed
+void onInterrupt(int) {
+    interrupted.store(true);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    HeadlessOptions options;
+    try {
+        if (!parseHeadlessArguments(argc, argv, options)) {
+            std::cout << headlessUsage(argv[0]);
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n\n" << headlessUsage(argv[0]);
+        return 2;
+    }
+
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    // Frames go to stdout; everything else goes to stderr
+    std::ios::sync_with_stdio(false);
+    try {
+        HeadlessAcquisition acquisition(createSpectrometers(options.devices), options);
+        const HeadlessSummary summary = acquisition.run(interrupted, std::cerr, std::cout);
+        std::cout.flush();
+        std::cerr << formatHeadlessSummary(summary);
+        return summary.framesMissing() ? 3 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
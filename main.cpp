@@ -1,11 +1,43 @@
 #include "mainwindow.h"
+#include "spectrometerpipeline.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
 #include <QSurfaceFormat>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption simulateOption("simulate", "Use a simulated spectrometer instead of the FTDI device.");
+    QCommandLineOption serialOption("serial", "Acquire from this spectrometer; repeat for several (default: all attached).", "serial");
+    QCommandLineOption simDevicesOption("sim-devices", "Number of simulated spectrometers (implies --simulate).", "n", "1");
+    QCommandLineOption frameRateOption("sim-fps", "Simulated frame rate, 0 for as fast as possible.", "fps", "100");
+    QCommandLineOption byteLossOption("sim-loss", "Probability per frame of losing bytes in transit.", "rate", "0");
+    QCommandLineOption misalignOption("sim-misalign", "Probability per frame of stray bytes before the header.", "rate", "0");
+    parser.addOptions({simulateOption, serialOption, simDevicesOption, frameRateOption, byteLossOption, misalignOption});
+    parser.process(a);
+
+    DeviceSelection selection;
+    selection.simulate = parser.isSet(simulateOption) || parser.isSet(simDevicesOption);
+    selection.simulatedDevices = qBound(1, parser.value(simDevicesOption).toInt(), 64);
+    selection.simulation.frameRate = parser.value(frameRateOption).toDouble();
+    selection.simulation.byteLossRate = parser.value(byteLossOption).toDouble();
+    selection.simulation.misalignmentRate = parser.value(misalignOption).toDouble();
+    for (const QString& serialNumber : parser.values(serialOption)) {
+        selection.serialNumbers.push_back(serialNumber.toStdString());
+    }
+
+    std::vector<std::unique_ptr<SpectrometerDevice>> devices;
+    try {
+        devices = createSpectrometers(selection);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(nullptr, "Device Error", QString("Failed to find the spectrometers: %1").arg(e.what()));
+        return 1;
+    }
+
     // Set OpenGL format for better performance
     QSurfaceFormat format;
     format.setSamples(4);
@@ -13,7 +45,7 @@ int main(int argc, char *argv[])
     format.setProfile(QSurfaceFormat::CoreProfile);
     QSurfaceFormat::setDefaultFormat(format);
 
-    MainWindow w;
+    MainWindow w(std::move(devices));
     w.show();
 
     return QApplication::exec();
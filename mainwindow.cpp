@@ -1,23 +1,40 @@
 #include "mainwindow.h"
 #include <QDebug>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QSignalBlocker>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
 #include <memory> // Include for std::unique_ptr
+#include <stdexcept>
 
 
 
 
 
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(std::vector<std::unique_ptr<SpectrometerDevice>> spectrometers, QWidget *parent) :
     QMainWindow(parent),
-    ftHandle(nullptr),
-    fthandle_uart(nullptr),
     chart(std::make_unique<QChart>()),
     series(std::make_unique<QLineSeries>()),
     peakLineSeries(std::make_unique<QLineSeries>()),
+    peakMarkerSeries(std::make_unique<QScatterSeries>()),
     defaultExposureTime(10000)
 {
     setWindowTitle("MDSpectra");
 
+    for (std::unique_ptr<SpectrometerDevice>& spectrometer : spectrometers) {
+        pipelines.push_back(std::make_unique<SpectrometerPipeline>(std::move(spectrometer)));
+    }
+    device = &pipelines.front()->device();
+    commandQueue = &pipelines.front()->commands();
+    acquisitionWorker = &pipelines.front()->worker();
+    frameRecorder = &pipelines.front()->recorder();
+
     // Create and set up status bar first
     statusBar = new QStatusBar(this);
     setStatusBar(statusBar);
@@ -30,10 +47,16 @@ MainWindow::MainWindow(QWidget *parent) :
     // Show the window immediately
     show();
 
+    // Draw no more often than the monitor refreshes
+    if (QScreen* display = screen(); display && display->refreshRate() > 0) {
+        renderIntervalMs = qMax(1, qRound(1000.0 / display->refreshRate()));
+    }
+
     // Use QTimer to delay device initialization
     QTimer::singleShot(100, this, [this]() {
         try {
             setupDevice();
+            loadDeviceProfile();
             updateStatusBar(tr("Application initialized successfully"));
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Device Error",
@@ -44,32 +67,25 @@ MainWindow::MainWindow(QWidget *parent) :
 }
 
 MainWindow::~MainWindow() {
-    if (ftHandle != nullptr) FT_Close(ftHandle);
-    if (fthandle_uart != nullptr) FT_Close(fthandle_uart);
-
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        pipeline->close();
+    }
 }
 
 void MainWindow::setupDevice() {
     try {
-        setupDeviceHelper("MD_HS_V1 A", &fthandle_uart);
-        setupDeviceHelper("MD_HS_V1 B", &ftHandle);
-
-        if (ft_status != FT_OK) {
-            throw std::runtime_error("Failed to open device");
-        }
-
-        FT_STATUS status = FT_SetBaudRate(fthandle_uart, 9600);
-        if (status != FT_OK) {
-            throw std::runtime_error("Failed to set baud rate");
-        }
+        for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            try {
+                pipeline->open();
+            } catch (const std::exception& e) {
+                if (pipelines.size() == 1) throw;
+                throw std::runtime_error(pipeline->serialNumber() + ": " + e.what());
+            }
 
-        status = FT_ResetDevice(fthandle_uart);
-        if (status != FT_OK) {
-            throw std::runtime_error("Failed to reset device");
+            // The head may have been left streaming
+            submitDeviceCommand(*pipeline, DeviceCommand::triggerOff());
+            submitDeviceCommand(*pipeline, DeviceCommand::setExposure(defaultExposureTime));
         }
-
-        trig_off(); // To turn off
-        set_exp(defaultExposureTime);
         qDebug() << "**Device setup complete**";
     }
     catch (const std::exception& e) {
@@ -78,23 +94,6 @@ void MainWindow::setupDevice() {
     }
 }
 
-void MainWindow::setupDeviceHelper(const char* description, FT_HANDLE* handle) {
-    if (*handle != nullptr) {
-        FT_Close(*handle);
-        *handle = nullptr;
-    }
-
-    // Correctly cast using const_cast and reinterpret_cast
-    ft_status = FT_OpenEx(reinterpret_cast<PVOID>(const_cast<char*>(description)), FT_OPEN_BY_DESCRIPTION, handle);
-
-    if (ft_status != FT_OK) {
-        logError("Failed to open " + QString(description) + " device. Error: " + QString::number(ft_status));
-    }
-}
-
-
-
-
 void MainWindow::setupChart() {
     series->setUseOpenGL(true);
     chart->addSeries(series.get());
@@ -139,6 +138,13 @@ void MainWindow::setupChart() {
     peakLineSeries->attachAxis(axisX);
     peakLineSeries->attachAxis(axisY);
 
+    peakMarkerSeries->setMarkerSize(8);
+    peakMarkerSeries->setColor(QColor(255, 140, 0));
+    peakMarkerSeries->setBorderColor(QColor(255, 140, 0));
+    chart->addSeries(peakMarkerSeries.get());
+    peakMarkerSeries->attachAxis(axisX);
+    peakMarkerSeries->attachAxis(axisY);
+
     // Set chart background to white
     chart->setBackgroundBrush(QColor(255, 255, 255));
     chart->setPlotAreaBackgroundBrush(QColor(255, 255, 255));
@@ -147,7 +153,7 @@ void MainWindow::setupChart() {
     // Add some padding to the plot area
     chart->setMargins(QMargins(1, 1, 1, 1));
 
-    chartView = new QChartView(chart.get(), this);
+    chartView = new TimedChartView(chart.get(), this);
     chartView->setRenderHint(QPainter::Antialiasing);
 }
 
@@ -207,7 +213,115 @@ void MainWindow::setupUI() {
     chartView->chart()->setBackgroundBrush(QColor(24, 24, 24));
     chartView->chart()->setTitleBrush(QColor(236, 236, 236));
     chartView->chart()->legend()->setLabelColor(QColor(236, 236, 236));
+    chartView->setVisible(!useRasterPlot);
+
+    spectrumPlot = new SpectrumPlotWidget(this);
+    spectrumPlot->setMinimumSize(960, 480);
+    spectrumPlot->setTitle("Live Data Plot");
+    spectrumPlot->setAxisTitles("Pixel", "Intensity");
+    spectrumPlot->setXRange(currentMinRange, currentMaxRange);
+    spectrumPlot->setVisible(useRasterPlot);
+
+    auto plotOptionsLayout = new QHBoxLayout();
+    auto plotRendererLabel = new QLabel("Renderer:", this);
+    plotRendererLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    plotRendererComboBox = new QComboBox(this);
+    plotRendererComboBox->addItem("Raster", true);
+    plotRendererComboBox->addItem("QtCharts", false);
+    plotRendererComboBox->setToolTip("Draw the live trace with the raster plot or with QtCharts");
+    plotRendererComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    drawTimeLabel = new QLabel("Draw: N/A", this);
+    drawTimeLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    drawTimeLabel->setToolTip("Mean paint time of the plot over its last 120 paints");
+    frameRateLabel = new QLabel("Rate: N/A", this);
+    frameRateLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    frameRateLabel->setToolTip("Frame rate over the last frames received, interval jitter and frames missing from the stream");
+    waterfallButton = new QPushButton("Waterfall", this);
+    waterfallButton->setCheckable(true);
+    waterfallButton->setStyleSheet(buttonStyle());
+    waterfallButton->setToolTip("Show how the spectrum evolves over time");
+    waterfallDepthSpinBox = new QSpinBox(this);
+    waterfallDepthSpinBox->setRange(16, static_cast<int>(WaterfallImage::MaxDepth));
+    waterfallDepthSpinBox->setValue(static_cast<int>(waterfallImage.depth()));
+    waterfallDepthSpinBox->setSuffix(" frames");
+    waterfallDepthSpinBox->setToolTip("Number of frames the waterfall keeps");
+    waterfallDepthSpinBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    auto overloadPolicyLabel = new QLabel("Overload:", this);
+    overloadPolicyLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    overloadPolicyComboBox = new QComboBox(this);
+    overloadPolicyComboBox->addItem("Lossless", static_cast<int>(AcquisitionWorker::OverloadPolicy::Lossless));
+    overloadPolicyComboBox->addItem("Latest only", static_cast<int>(AcquisitionWorker::OverloadPolicy::LatestOnly));
+    overloadPolicyComboBox->addItem("Bounded latency", static_cast<int>(AcquisitionWorker::OverloadPolicy::BoundedLatency));
+    overloadPolicyComboBox->setToolTip("When frames arrive faster than they are shown: queue every frame for drawing, "
+                                       "draw only the newest, or skip drawing frames older than the latency budget. "
+                                       "Every frame is still recorded, averaged and added to the waterfall");
+    overloadPolicyComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    latencyBudgetSpinBox = new QSpinBox(this);
+    latencyBudgetSpinBox->setRange(10, 5000);
+    latencyBudgetSpinBox->setValue(AcquisitionWorker::DefaultLatencyBudgetMs);
+    latencyBudgetSpinBox->setSuffix(" ms");
+    latencyBudgetSpinBox->setToolTip("Oldest a frame may be when it reaches the display under bounded latency");
+    latencyBudgetSpinBox->setEnabled(false);
+    latencyBudgetSpinBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    waterfallView = new WaterfallWidget(waterfallImage, this);
+    waterfallView->setMinimumHeight(240);
+    waterfallView->setVisible(false);
+
+    if (pipelines.size() > 1) {
+        std::vector<std::string> serialNumbers;
+        for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+            serialNumbers.push_back(pipeline->serialNumber());
+        }
+        deviceSpectraView = new DeviceSpectraView(serialNumbers, this);
+        deviceSpectraView->setXRange(currentMinRange, currentMaxRange);
+    }
+
+    plotOptionsLayout->addWidget(plotRendererLabel);
+    plotOptionsLayout->addWidget(plotRendererComboBox);
+    plotOptionsLayout->addWidget(waterfallButton);
+    plotOptionsLayout->addWidget(waterfallDepthSpinBox);
+    plotOptionsLayout->addWidget(overloadPolicyLabel);
+    plotOptionsLayout->addWidget(overloadPolicyComboBox);
+    plotOptionsLayout->addWidget(latencyBudgetSpinBox);
+    plotOptionsLayout->addStretch();
+    plotOptionsLayout->addWidget(frameRateLabel);
+    plotOptionsLayout->addWidget(drawTimeLabel);
+
+    chartLayout->addLayout(plotOptionsLayout);
+    chartLayout->addWidget(spectrumPlot);
     chartLayout->addWidget(chartView);
+    chartLayout->addWidget(waterfallView);
+    if (deviceSpectraView) {
+        chartLayout->addWidget(deviceSpectraView);
+    }
     mainLayout->addWidget(chartContainer);
 
     auto controlsContainer = new QWidget(this);
@@ -249,8 +363,13 @@ void MainWindow::setupUI() {
     startButton->setStyleSheet(buttonStyle("green"));
     stopButton->setStyleSheet(buttonStyle("red"));
     stopButton->setEnabled(false);
+    recordToFileButton = new QPushButton(tr("Record to File"), this);
+    recordToFileButton->setStyleSheet(buttonStyle());
+    recordToFileButton->setCheckable(true);
+    recordToFileButton->setToolTip(tr("Stream the next acquisition to a recording file"));
     buttonsLayout->addWidget(startButton);
     buttonsLayout->addWidget(stopButton);
+    buttonsLayout->addWidget(recordToFileButton);
     controlsLayout->addLayout(buttonsLayout);
 
     auto additionalButtonsLayout = new QHBoxLayout();
@@ -271,10 +390,113 @@ void MainWindow::setupUI() {
     additionalButtonsLayout->addWidget(showSubtractedValuesButton);
     additionalButtonsLayout->addWidget(showAverageButton);
     additionalButtonsLayout->addWidget(storeTraceButton);
+
+    averageModeComboBox = new QComboBox(this);
+    averageModeComboBox->addItem("Sliding", static_cast<int>(FrameAverager::Mode::Sliding));
+    averageModeComboBox->addItem("Exponential", static_cast<int>(FrameAverager::Mode::Exponential));
+    averageModeComboBox->setToolTip("Average the last N frames, or weight them exponentially like N frames");
+    averageModeComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    averageWindowSpinBox = new QSpinBox(this);
+    averageWindowSpinBox->setRange(1, static_cast<int>(FrameAverager::MaxWindow));
+    averageWindowSpinBox->setValue(static_cast<int>(frameAverager.window()));
+    averageWindowSpinBox->setSuffix(" frames");
+    averageWindowSpinBox->setToolTip("Number of frames averaged");
+    averageWindowSpinBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    additionalButtonsLayout->addWidget(averageModeComboBox);
+    additionalButtonsLayout->addWidget(averageWindowSpinBox);
     controlsLayout->addLayout(additionalButtonsLayout);
 
     mainLayout->addWidget(controlsContainer);
 
+    auto playbackContainer = new QWidget(this);
+    playbackContainer->setObjectName("playbackContainer");
+    playbackContainer->setStyleSheet(R"(
+        #playbackContainer {
+            background-color: rgba(255, 255, 255, 0.05);
+            border: 1px solid rgba(255, 255, 255, 0.1);
+            border-radius: 12px;
+            padding: 20px;
+        }
+    )");
+    auto playbackLayout = new QHBoxLayout(playbackContainer);
+    playbackLayout->setSpacing(20);
+
+    openRecordingButton = new QPushButton("Open Recording", this);
+    openRecordingButton->setStyleSheet(buttonStyle());
+    playPauseButton = new QPushButton("Play", this);
+    playPauseButton->setStyleSheet(buttonStyle());
+    playPauseButton->setEnabled(false);
+
+    playbackSlider = new QSlider(Qt::Horizontal, this);
+    playbackSlider->setRange(0, 0);
+    playbackSlider->setEnabled(false);
+
+    playbackSpeedComboBox = new QComboBox(this);
+    for (double speed : {0.25, 0.5, 1.0, 2.0, 4.0, 10.0}) {
+        playbackSpeedComboBox->addItem(QString("%1x").arg(speed), speed);
+    }
+    playbackSpeedComboBox->setCurrentIndex(2);
+    playbackSpeedComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+
+    playbackPositionLabel = new QLabel("No recording", this);
+    playbackPositionLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+
+    playbackLayout->addWidget(openRecordingButton);
+    playbackLayout->addWidget(playPauseButton);
+    playbackLayout->addWidget(playbackSlider, 1);
+    playbackLayout->addWidget(playbackSpeedComboBox);
+    playbackLayout->addWidget(playbackPositionLabel);
+
+    mainLayout->addWidget(playbackContainer);
+
+    playbackTimer = new QTimer(this);
+    playbackTimer->setInterval(PlaybackIntervalMs);
+    playbackTimer->setTimerType(Qt::PreciseTimer);
+
+    exportTimer = new QTimer(this);
+    exportTimer->setInterval(ExportPollIntervalMs);
+
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    renderTimer->setTimerType(Qt::PreciseTimer);
+
+    // Telemetry summary and the diagnostics panel, next to the status bar
+    telemetryLabel = new QLabel(this);
+    telemetryLabel->setStyleSheet("color: #BBBBBB; font-size: 12px;");
+    telemetryLabel->setToolTip("Bytes read, frames parsed, display queue depth, frames the display dropped or shed "
+                               "and 99th percentile read-to-display latency");
+    diagnosticsButton = new QPushButton("Diagnostics", this);
+    diagnosticsButton->setStyleSheet(buttonStyle());
+    diagnosticsButton->setToolTip("Show all pipeline counters and the latency histogram");
+    statusBar->addPermanentWidget(telemetryLabel);
+    statusBar->addPermanentWidget(diagnosticsButton);
+    diagnosticsPanel = new DiagnosticsPanel(this);
+
+    telemetryTimer = new QTimer(this);
+    telemetryTimer->setInterval(TelemetryIntervalMs);
+    telemetryTimer->start();
+
     auto rangeContainer = new QWidget(this);
     rangeContainer->setObjectName("rangeContainer");
     rangeContainer->setStyleSheet(R"(
@@ -290,8 +512,9 @@ void MainWindow::setupUI() {
 
     auto minRangeLabel = new QLabel("Min Range:", this);
     minRangeLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
-    minRangeSpinBox = new QSpinBox(this);
-    minRangeSpinBox->setRange(0, 1023);
+    minRangeSpinBox = new QDoubleSpinBox(this);
+    minRangeSpinBox->setDecimals(0);
+    minRangeSpinBox->setRange(0, LastRangePixel);
     minRangeSpinBox->setValue(0);
     minRangeSpinBox->setStyleSheet(R"(
         background-color: rgba(255, 255, 255, 0.1);
@@ -304,9 +527,10 @@ void MainWindow::setupUI() {
 
     auto maxRangeLabel = new QLabel("Max Range:", this);
     maxRangeLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
-    maxRangeSpinBox = new QSpinBox(this);
-    maxRangeSpinBox->setRange(0, 1023);
-    maxRangeSpinBox->setValue(1023);
+    maxRangeSpinBox = new QDoubleSpinBox(this);
+    maxRangeSpinBox->setDecimals(0);
+    maxRangeSpinBox->setRange(0, LastRangePixel);
+    maxRangeSpinBox->setValue(LastRangePixel);
     maxRangeSpinBox->setStyleSheet(R"(
         background-color: rgba(255, 255, 255, 0.1);
         color: #FFFFFF;
@@ -319,11 +543,36 @@ void MainWindow::setupUI() {
     setRangeButton = new QPushButton("Set Range", this);
     setRangeButton->setStyleSheet(buttonStyle());
 
+    // Units other than pixels need the calibration in the device profile
+    auto axisUnitLabel = new QLabel("X Axis:", this);
+    axisUnitLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    axisUnitComboBox = new QComboBox(this);
+    for (SpectralUnit unit : {SpectralUnit::Pixel, SpectralUnit::Wavelength, SpectralUnit::RamanShift}) {
+        axisUnitComboBox->addItem(spectralUnitTitle(unit), static_cast<int>(unit));
+    }
+    axisUnitComboBox->setToolTip("Spectral axis of the plot, the range, the peak readouts and exports");
+    axisUnitComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    updateAxisUnitChoices();
+
+    calibrationButton = new QPushButton("Calibration", this);
+    calibrationButton->setStyleSheet(buttonStyle());
+    calibrationButton->setToolTip("Wavelength calibration and laser line of this spectrometer");
+
+    rangeLayout->addWidget(axisUnitLabel);
+    rangeLayout->addWidget(axisUnitComboBox);
     rangeLayout->addWidget(minRangeLabel);
     rangeLayout->addWidget(minRangeSpinBox);
     rangeLayout->addWidget(maxRangeLabel);
     rangeLayout->addWidget(maxRangeSpinBox);
     rangeLayout->addWidget(setRangeButton);
+    rangeLayout->addWidget(calibrationButton);
 
     mainLayout->addWidget(rangeContainer);
 
@@ -404,6 +653,8 @@ void MainWindow::setupUI() {
     peakValueLabel = createStylishLabel("Peak Value: N/A");
     peakPixelLabel = createStylishLabel("Peak Pixel: N/A");
     peakToPeakValueLabel = createStylishLabel("Peak to Peak: N/A");
+    fwhmLabel = createStylishLabel("FWHM: N/A");
+    fwhmLabel->setToolTip("Full width at half maximum of the most prominent detected peak");
     saturationIndicator = new QLabel(this);
     saturationIndicator->setFixedSize(20, 20);
     saturationIndicator->setStyleSheet("background-color: green; border-radius: 20px;");
@@ -425,6 +676,7 @@ void MainWindow::setupUI() {
     labelsTopLayout->addWidget(peakValueLabel);
     labelsTopLayout->addWidget(peakPixelLabel);
     labelsTopLayout->addWidget(peakToPeakValueLabel);
+    labelsTopLayout->addWidget(fwhmLabel);
     labelsTopLayout->addWidget(saturationIndicator);
 
     labelsBottomLayout->addWidget(varianceLabel);
@@ -432,17 +684,85 @@ void MainWindow::setupUI() {
     labelsBottomLayout->addWidget(meanLabel);
     labelsBottomLayout->addWidget(medianLabel);
 
+    // Peak detection settings and the table of detected peaks
+    auto peakOptionsLayout = new QHBoxLayout();
+    auto peakProminenceLabel = new QLabel("Prominence:", this);
+    peakProminenceLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    peakProminenceSpinBox = new QSpinBox(this);
+    peakProminenceSpinBox->setRange(1, 65535);
+    peakProminenceSpinBox->setValue(static_cast<int>(peakSettings.minProminence));
+    peakProminenceSpinBox->setSuffix(" counts");
+    peakProminenceSpinBox->setToolTip("How far a peak has to rise above its valleys to be detected");
+    peakProminenceSpinBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    auto peakCentreLabel = new QLabel("Centre:", this);
+    peakCentreLabel->setStyleSheet("color: #BBBBBB; font-weight: 500; font-size: 14px;");
+    peakCentreComboBox = new QComboBox(this);
+    peakCentreComboBox->addItem("Parabolic", static_cast<int>(PeakCentre::Parabolic));
+    peakCentreComboBox->addItem("Centroid", static_cast<int>(PeakCentre::Centroid));
+    peakCentreComboBox->setToolTip("Sub-pixel peak centre from a parabola through the top three samples, "
+                                   "or from the centroid of the samples above half maximum");
+    peakCentreComboBox->setStyleSheet(R"(
+        background-color: rgba(255, 255, 255, 0.1);
+        color: #FFFFFF;
+        border: none;
+        border-radius: 6px;
+        padding: 8px;
+        font-size: 14px;
+    )");
+    peakTableButton = new QPushButton("Peak Table", this);
+    peakTableButton->setCheckable(true);
+    peakTableButton->setStyleSheet(buttonStyle());
+    peakTableButton->setToolTip("List every detected peak with its centre, height, prominence, FWHM and area");
+    peakOptionsLayout->addWidget(peakProminenceLabel);
+    peakOptionsLayout->addWidget(peakProminenceSpinBox);
+    peakOptionsLayout->addWidget(peakCentreLabel);
+    peakOptionsLayout->addWidget(peakCentreComboBox);
+    peakOptionsLayout->addWidget(peakTableButton);
+    peakOptionsLayout->addStretch();
+    labelsMainLayout->addLayout(peakOptionsLayout);
+
+    peakTable = new QTableWidget(0, 5, this);
+    peakTable->setHorizontalHeaderLabels({"Centre (px)", "Height", "Prominence", "FWHM (px)", "Area"});
+    peakTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    peakTable->verticalHeader()->setVisible(false);
+    peakTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    peakTable->setSelectionMode(QAbstractItemView::NoSelection);
+    peakTable->setMinimumHeight(160);
+    peakTable->setStyleSheet(R"(
+        QTableWidget {
+            background-color: rgba(255, 255, 255, 0.05);
+            color: #FFFFFF;
+            gridline-color: #444444;
+            border: none;
+            font-size: 13px;
+        }
+        QHeaderView::section {
+            background-color: rgba(255, 255, 255, 0.1);
+            color: #BBBBBB;
+            border: none;
+            padding: 4px;
+        }
+    )");
+    peakTable->setVisible(false);
+    labelsMainLayout->addWidget(peakTable);
+
     mainLayout->addWidget(labelsContainer);
 
     connectSignalsAndSlots();
 
-    setupTimer();
-
     storedTraces.clear();
     for (auto& series : storedSeries) {
         chart->removeSeries(series.get());
     }
     storedSeries.clear();
+    spectrumPlot->setStoredTraces(storedTraces);
 }
 
 QString MainWindow::buttonStyle(const QString& color) {
@@ -586,34 +906,140 @@ void MainWindow::connectSignalsAndSlots() {
     if (!connectionSuccessful) {
         qWarning() << "Failed to connect toggleYRangeButton clicked signal.";
     }
-}
 
+    connectionSuccessful = connect(recordToFileButton, &QPushButton::toggled, this, &MainWindow::onRecordToFileToggled);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect recordToFileButton toggled signal.";
+    }
+
+    connectionSuccessful = connect(openRecordingButton, &QPushButton::clicked, this, &MainWindow::onOpenRecordingClicked);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect openRecordingButton clicked signal.";
+    }
+
+    connectionSuccessful = connect(playPauseButton, &QPushButton::clicked, this, &MainWindow::onPlayPauseClicked);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect playPauseButton clicked signal.";
+    }
 
-void MainWindow::setupTimer() {
-    if (timer) {
-        // Disconnect the existing timer if already connected
-        bool disconnectSuccessful = disconnect(timer, &QTimer::timeout, this, &MainWindow::updatePlot);
-        if (!disconnectSuccessful) {
-            qWarning() << "Failed to disconnect timer timeout signal.";
-        }
+    connectionSuccessful = connect(playbackTimer, &QTimer::timeout, this, &MainWindow::onPlaybackTimer);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect playbackTimer timeout signal.";
     }
 
-    // Create a new timer and set its interval
-    timer = new QTimer(this);
-    timer->setInterval(10);
+    connectionSuccessful = connect(exportTimer, &QTimer::timeout, this, &MainWindow::onExportTimer);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect exportTimer timeout signal.";
+    }
 
-    // Connect the timer's timeout signal to the updatePlot slot
-    bool connectSuccessful = connect(timer, &QTimer::timeout, this, &MainWindow::updatePlot);
-    if (!connectSuccessful) {
-        qWarning() << "Failed to connect timer timeout signal.";
+    connectionSuccessful = connect(telemetryTimer, &QTimer::timeout, this, &MainWindow::onTelemetryTimer);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect telemetryTimer timeout signal.";
+    }
+
+    connectionSuccessful = connect(diagnosticsButton, &QPushButton::clicked, this, [this]() {
+        diagnosticsPanel->show();
+        diagnosticsPanel->raise();
+        onTelemetryTimer();
+    });
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect diagnosticsButton clicked signal.";
+    }
+
+    connectionSuccessful = connect(diagnosticsPanel, &DiagnosticsPanel::saveRequested, this, &MainWindow::onSaveDiagnosticsClicked);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect diagnosticsPanel saveRequested signal.";
+    }
+
+    connectionSuccessful = connect(diagnosticsPanel, &DiagnosticsPanel::resetLatencyRequested, this,
+                                   [this]() { displayLatency.reset(); });
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect diagnosticsPanel resetLatencyRequested signal.";
+    }
+
+    connectionSuccessful = connect(renderTimer, &QTimer::timeout, this, &MainWindow::renderDisplay);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect renderTimer timeout signal.";
+    }
+
+    connectionSuccessful = connect(playbackSlider, &QSlider::valueChanged, this, &MainWindow::onPlaybackSliderMoved);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect playbackSlider valueChanged signal.";
+    }
+
+    connectionSuccessful = connect(playbackSpeedComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onPlaybackSpeedChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect playbackSpeedComboBox currentIndexChanged signal.";
     }
-}
 
+    connectionSuccessful = connect(averageModeComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onAverageModeChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect averageModeComboBox currentIndexChanged signal.";
+    }
+
+    connectionSuccessful = connect(averageWindowSpinBox, &QSpinBox::valueChanged, this, &MainWindow::onAverageWindowChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect averageWindowSpinBox valueChanged signal.";
+    }
+
+    connectionSuccessful = connect(plotRendererComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onPlotRendererChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect plotRendererComboBox currentIndexChanged signal.";
+    }
+
+    connectionSuccessful = connect(waterfallButton, &QPushButton::toggled, this, &MainWindow::onWaterfallToggled);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect waterfallButton toggled signal.";
+    }
+
+    connectionSuccessful = connect(waterfallDepthSpinBox, &QSpinBox::valueChanged, this, &MainWindow::onWaterfallDepthChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect waterfallDepthSpinBox valueChanged signal.";
+    }
+
+    connectionSuccessful = connect(overloadPolicyComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onOverloadPolicyChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect overloadPolicyComboBox currentIndexChanged signal.";
+    }
+
+    connectionSuccessful = connect(latencyBudgetSpinBox, &QSpinBox::valueChanged, this, &MainWindow::onLatencyBudgetChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect latencyBudgetSpinBox valueChanged signal.";
+    }
+
+    connectionSuccessful = connect(peakProminenceSpinBox, &QSpinBox::valueChanged, this, &MainWindow::onPeakProminenceChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect peakProminenceSpinBox valueChanged signal.";
+    }
+
+    connectionSuccessful = connect(peakCentreComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onPeakCentreChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect peakCentreComboBox currentIndexChanged signal.";
+    }
+
+    connectionSuccessful = connect(peakTableButton, &QPushButton::toggled, this, &MainWindow::onPeakTableToggled);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect peakTableButton toggled signal.";
+    }
+
+    connectionSuccessful = connect(axisUnitComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onAxisUnitChanged);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect axisUnitComboBox currentIndexChanged signal.";
+    }
 
+    connectionSuccessful = connect(calibrationButton, &QPushButton::clicked, this, &MainWindow::onCalibrationClicked);
+    if (!connectionSuccessful) {
+        qWarning() << "Failed to connect calibrationButton clicked signal.";
+    }
+}
 
 
 void MainWindow::startDataAcquisition() {
-    if (ftHandle == nullptr || fthandle_uart == nullptr) {
+    if (exportJob.isRunning()) {
+        updateStatusBar(tr("Wait for the export to finish before starting an acquisition"), 5000);
+        return;
+    }
+    if (!device->isOpen()) {
         updateStatusBar(tr("Device Error: Not properly initialized"), 5000);
         QMessageBox::critical(this, "Device Error", "Devices are not properly initialized. Please check the connection.");
         return;
@@ -621,6 +1047,31 @@ void MainWindow::startDataAcquisition() {
 
     updateStatusBar(tr("Starting data acquisition..."));
 
+    // Live frames take over the display
+    pausePlayback();
+
+    // Open the recording file before the sensor is triggered
+    FrameRecorder* recorder = nullptr;
+    if (!recordingFilePath.isEmpty()) {
+        try {
+            // Every head but the first records next to it, under its serial number
+            const std::filesystem::path path(recordingFilePath.toStdWString());
+            for (std::size_t index = 0; index < pipelines.size(); ++index) {
+                SpectrometerPipeline& pipeline = *pipelines[index];
+                pipeline.recorder().open(index == 0 ? path : devicePath(path, pipeline.serialNumber()));
+            }
+            recorder = frameRecorder;
+        } catch (const std::exception& e) {
+            for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+                pipeline->recorder().close();
+            }
+            qDebug() << "Failed to open recording file:" << e.what();
+            updateStatusBar(tr("Error: Failed to open recording file"), 5000);
+            QMessageBox::critical(this, "Error", QString("Failed to open recording file: %1").arg(e.what()));
+            return;
+        }
+    }
+
     // Clear the frame buffer
     frameBuffer.clear();
 
@@ -630,62 +1081,89 @@ void MainWindow::startDataAcquisition() {
         chart->removeSeries(series.data());
     }
     storedSeries.clear();
+    spectrumPlot->setStoredTraces(storedTraces);
 
-    // Clear the data buffer
-    dataBuffer.clear();
-
-    // Purge any existing data in the reception buffer
-    FT_STATUS purgeStatus = FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
-    if (purgeStatus != FT_OK) {
-        qDebug() << "Failed to purge buffers. Status:" << purgeStatus;
+    // Purge any existing data in the reception buffers
+    bool purged = true;
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        purged = pipeline->device().purgeDataChannel() && purged;
+    }
+    if (!purged) {
+        qDebug() << "Failed to purge buffers";
         updateStatusBar(tr("Warning: Buffer purge failed. Data may be inconsistent."), 5000);
         QMessageBox::warning(this, "Warning", "Failed to purge device buffers. Data may be inconsistent.");
     }
 
-    // Set the exposure time
-    try {
-        updateStatusBar(tr("Setting exposure time..."));
-        set_exp(defaultExposureTime);
-    } catch (const std::exception& e) {
-        qDebug() << "Failed to set exposure time:" << e.what();
-        updateStatusBar(tr("Error: Failed to set exposure time"), 5000);
-        QMessageBox::critical(this, "Error", QString("Failed to set exposure time: %1").arg(e.what()));
-        return;
+    // Set the exposure time, then turn on the trigger. Both run on the
+    // command thread, so the acquisition thread is already waiting when the
+    // first frame arrives; a failure stops this acquisition again.
+    const quint64 run = ++acquisitionRun;
+    const auto abortOnFailure = [this, run](const DeviceCommandResult& result) {
+        if (result.succeeded || run != acquisitionRun || !acquisitionWorker->isRunning()) {
+            return;
+        }
+        updateStatusBar(tr("Error: %1 failed").arg(result.command.name()), 5000);
+        QMessageBox::critical(this, "Error", QString("Failed to start data acquisition: %1")
+                                                 .arg(QString::fromStdString(result.error)));
+        stopDataAcquisition();
+    };
+    DeviceCommand triggerOn = DeviceCommand::triggerOn();
+    triggerOn.delayMs = TriggerSettleMs;
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        submitDeviceCommand(*pipeline, DeviceCommand::setExposure(defaultExposureTime), abortOnFailure);
+        submitDeviceCommand(*pipeline, triggerOn, abortOnFailure);
     }
 
-    QThread::msleep(100);
-
-    // Turn on the trigger
-    try {
-        updateStatusBar(tr("Enabling trigger..."));
-        trig_on();
-    } catch (const std::exception& e) {
-        qDebug() << "Failed to turn on trigger:" << e.what();
-        updateStatusBar(tr("Error: Failed to enable trigger"), 5000);
-        QMessageBox::critical(this, "Error", QString("Failed to turn on trigger: %1").arg(e.what()));
-        return;
+    // Start recording frames; frames streamed to disk are not kept in memory
+    if (recorder != nullptr) {
+        recordedFrames.clear();
+    } else {
+        startRecording();
     }
+    acquisitionWorker->setExposureTime(defaultExposureTime);
 
-    // Start recording frames
-    startRecording();
+    // Hand the data channel to the acquisition thread; it wakes us through
+    // a queued call whenever complete frames are waiting
+    acquisitionClock.start();
+    acquisitionWorker->start(device, [this]() {
+        QMetaObject::invokeMethod(this, [this]() { updatePlot(); }, Qt::QueuedConnection);
+    }, recorder);
 
-    // Start the timer for continuous data acquisition
-    timer->start(10);
+    // The other heads are only shown in the spectrometer view, which wants
+    // their newest frame; each records every frame from its own thread
+    for (std::size_t index = 1; index < pipelines.size(); ++index) {
+        SpectrometerPipeline& pipeline = *pipelines[index];
+        pipeline.worker().setOverloadPolicy(AcquisitionWorker::OverloadPolicy::LatestOnly);
+        pipeline.worker().setExposureTime(defaultExposureTime);
+        pipeline.worker().start(&pipeline.device(), [this, index]() {
+            QMetaObject::invokeMethod(this, [this, index]() { updateDeviceSpectrum(index); }, Qt::QueuedConnection);
+        }, pipeline.recorder().isOpen() ? &pipeline.recorder() : nullptr);
+    }
 
     // Update UI state
     startButton->setEnabled(false);
     stopButton->setEnabled(true);
+    recordToFileButton->setEnabled(false);
 
     // Reset Y-axis if in auto range mode
     if (isAutoYRange) {
+        autoYRange.reset();
         auto axisY = dynamic_cast<QValueAxis*>(chart->axes(Qt::Vertical).first());
         if (axisY) {
             axisY->setRange(0, 65535);
         }
+        spectrumPlot->setYRange(0, 65535);
     }
 
-    // Clear last ten frames buffer
-    lastTenFrames.clear();
+    // Start the average, the waterfall and the display counters afresh
+    frameAverager.clear();
+    waterfallImage.clear();
+    if (deviceSpectraView) {
+        deviceSpectraView->clear();
+    }
+    renderedFrames = 0;
+    skippedDisplayFrames = 0;
+    framesAwaitingRender = 0;
 
     qDebug() << "Continuous data acquisition started";
     updateStatusBar(tr("Data acquisition started successfully - Exposure: %1 μs").arg(defaultExposureTime));
@@ -696,557 +1174,794 @@ void MainWindow::startDataAcquisition() {
 void MainWindow::stopDataAcquisition() {
     qDebug() << "Stopping data acquisition...";
 
-    // Stop the timer
-    timer->stop();
-    qDebug() << "Timer stopped";
+    // Stop the acquisition threads before touching the data channels
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        pipeline->worker().stop();
+    }
+    qDebug() << "Acquisition thread stopped";
 
-    try {
-        // Turn off the trigger
-        trig_off();
-        qDebug() << "Trigger turned off successfully";
-
-        // Purge any remaining data in the reception and transmit buffers
-        FT_STATUS purgeStatus = FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
-        if (purgeStatus != FT_OK) {
-            qDebug() << "FT_Purge failed with status:" << purgeStatus;
-            throw std::runtime_error("Failed to purge device buffers");
-        }
-        qDebug() << "Device buffers purged successfully";
+    // What the worker still had queued or held back belongs in the recording
+    updatePlot();
 
-        // Reset the device
-        FT_STATUS resetStatus = FT_ResetDevice(ftHandle);
-        if (resetStatus != FT_OK) {
-            qDebug() << "FT_ResetDevice failed with status:" << resetStatus;
-            throw std::runtime_error("Failed to reset device");
+    const double elapsedSeconds = acquisitionClock.isValid() ? acquisitionClock.elapsed() / 1000.0 : 0.0;
+    if (elapsedSeconds > 0.0) {
+        const quint64 parsedFrames = acquisitionWorker->parsedFrames();
+        const FrameSynchronizer& sync = acquisitionWorker->frameSync();
+        const FrameTimingStats timing = acquisitionWorker->timingStats();
+        updateStatusBar(tr("Acquired %1 frames at %2 frames/s (jitter %3 ms), %4 lost in the stream, %5 dropped, "
+                           "%6 shed (%7), %8 resyncs (%9 frames rejected), %10 drawn")
+                            .arg(parsedFrames)
+                            .arg(timing.frameRate(), 0, 'f', 1)
+                            .arg(timing.jitterNs / 1e6, 0, 'f', 2)
+                            .arg(acquisitionWorker->lostFrames())
+                            .arg(acquisitionWorker->droppedFrames())
+                            .arg(acquisitionWorker->shedFrames())
+                            .arg(AcquisitionWorker::overloadPolicyName(acquisitionWorker->overloadPolicy()))
+                            .arg(sync.resyncs())
+                            .arg(sync.framesRejected())
+                            .arg(renderedFrames), 10000);
+        qDebug() << "Frame interval: mean" << timing.meanIntervalNs / 1e6 << "ms, jitter" << timing.jitterNs / 1e6
+                 << "ms, min" << timing.minIntervalNs / 1e6 << "ms, max" << timing.maxIntervalNs / 1e6 << "ms,"
+                 << timing.missingFrames << "frames missing in" << timing.gaps << "gaps"
+                 << (timing.isLossless() ? "(lossless)" : "");
+        qDebug() << "Frames drawn:" << renderedFrames << "skipped for display:" << skippedDisplayFrames;
+        qDebug() << "Mean paint time, raster:" << spectrumPlot->paintTimer().averageMicroseconds()
+                 << "us, QtCharts:" << chartView->paintTimer().averageMicroseconds() << "us";
+        qDebug() << "Stream resyncs:" << sync.resyncs() << "bytes discarded:" << sync.bytesDiscarded();
+    }
+
+    // The worker has submitted its last frame, so the recording can be finished
+    if (frameRecorder->isOpen()) {
+        const bool recordingSaved = frameRecorder->close();
+        qDebug() << "Recorded" << frameRecorder->framesWritten() << "frames," << frameRecorder->bytesWritten()
+                 << "bytes," << frameRecorder->framesDropped() << "dropped by the writer";
+        if (!recordingSaved) {
+            QMessageBox::warning(this, "Recording Error",
+                                 QString("The recording file is incomplete: %1").arg(QString::fromStdString(frameRecorder->errorMessage())));
         }
-        qDebug() << "Device reset successfully";
-
-        // Clear internal buffers
-        frameBuffer.clear();
-        dataBuffer.clear();
+        for (std::size_t index = 1; index < pipelines.size(); ++index) {
+            SpectrometerPipeline& pipeline = *pipelines[index];
+            FrameRecorder& other = pipeline.recorder();
+            const bool otherSaved = other.close();
+            qDebug() << QString::fromStdString(pipeline.serialNumber()) << "recorded" << other.framesWritten()
+                     << "frames," << other.framesDropped() << "dropped by the writer";
+            if (!otherSaved) {
+                QMessageBox::warning(this, "Recording Error",
+                                     QString("The recording file of %1 is incomplete: %2")
+                                         .arg(QString::fromStdString(pipeline.serialNumber()),
+                                              QString::fromStdString(other.errorMessage())));
+            }
+        }
+        // Ask for a new file before the next recording instead of overwriting this one
+        recordToFileButton->setChecked(false);
+    }
 
-        // Stop recording but keep the data in allFramesData
-        isRecording = false;
+    // Clear internal buffers
+    frameBuffer.clear();
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        pipeline->worker().clearFrames();
+    }
 
-        // Do not clear the current series or stored traces
-        // This keeps the signal on the screen
+    // Stop recording but keep the data in recordedFrames
+    isRecording = false;
 
-        startButton->setEnabled(true);
-        stopButton->setEnabled(false);
+    // Do not clear the current series or stored traces
+    // This keeps the signal on the screen
 
-        // Do not reset labels or saturation indicator
-        // This keeps the last values visible
+    startButton->setEnabled(true);
+    stopButton->setEnabled(false);
+    recordToFileButton->setEnabled(true);
+
+    // Do not reset labels or saturation indicator
+    // This keeps the last values visible
+
+    // The trigger goes off on each command thread; once a head has stopped
+    // streaming, whatever it sent last is flushed from its data channel
+    for (const std::unique_ptr<SpectrometerPipeline>& pipeline : pipelines) {
+        SpectrometerPipeline* stopping = pipeline.get();
+        submitDeviceCommand(*stopping, DeviceCommand::triggerOff(), [this, stopping](const DeviceCommandResult& result) {
+            if (!result.succeeded) {
+                QMessageBox::critical(this, "Error",
+                                      QString("Failed to stop data acquisition: %1").arg(QString::fromStdString(result.error)));
+                return;
+            }
 
-        qDebug() << "Data acquisition stopped successfully";
-    } catch (const std::exception& e) {
-        qDebug() << "Exception caught while stopping data acquisition:" << e.what();
-        QMessageBox::critical(this, "Error", QString("Failed to stop data acquisition: %1").arg(e.what()));
+            // A new acquisition has purged the channel itself and is reading it
+            if (stopping->worker().isRunning()) {
+                return;
+            }
+            if (!stopping->device().purgeDataChannel()) {
+                qDebug() << "Purging the data channel failed";
+                updateStatusBar(tr("Warning: Failed to purge device buffers"), 5000);
+            } else if (!stopping->device().resetDataChannel()) {
+                qDebug() << "Resetting the data channel failed";
+                updateStatusBar(tr("Warning: Failed to reset device"), 5000);
+            }
+        });
     }
+
+    qDebug() << "Data acquisition stopped successfully";
 }
 
 
 void MainWindow::updatePlot() {
-   if (ftHandle == nullptr || fthandle_uart == nullptr) {
-       QMessageBox::critical(this, "Device Error", "Devices are not properly initialized. Please check the connection.");
-       stopDataAcquisition();
-       return;
-   }
-
-   constexpr int expectedFrameSize = 2088;
-
-   // Read available data
-   DWORD bytesAvailable;
-   FT_GetQueueStatus(ftHandle, &bytesAvailable);
-
-   if (bytesAvailable > 0) {
-       QByteArray newData(bytesAvailable, 0);
-       DWORD bytesRead;
-       FT_STATUS status = FT_Read(ftHandle, newData.data(), bytesAvailable, &bytesRead);
-       if (status != FT_OK) {
-           qWarning() << "FT_Read failed with status:" << status;
-           return;
-       }
-       if (bytesRead > 0) {
-           dataBuffer.append(newData.left(bytesRead));
-       }
-   }
-
-   int maxFramesToProcess = 10;
-
-   while (dataBuffer.size() >= expectedFrameSize && maxFramesToProcess > 0) {
-       int frameStart = findFrameStart(dataBuffer);
-       if (frameStart == -1) {
-           dataBuffer.remove(0, 4);
-           break;
-       }
-
-       if (frameStart > 0) {
-           dataBuffer.remove(0, frameStart);
-           continue;
-       }
-
-       if (dataBuffer.size() < expectedFrameSize) {
-           break;
-       }
-
-       QByteArray frameData = dataBuffer.left(expectedFrameSize);
-       dataBuffer.remove(0, expectedFrameSize);
-
-       QVector<QPointF> newPoints = processFrame(frameData);
-
-       if (lastTenFrames.size() >= 10) {
-           lastTenFrames.removeFirst();
-       }
-       lastTenFrames.append(newPoints);
-
-       if (!showingAverage) {
-           QMetaObject::invokeMethod(this, [this, newPoints]() {
-               updatePlotWithPoints(newPoints);
-           }, Qt::QueuedConnection);
-       }
-
-       maxFramesToProcess--;
-   }
-
-   // If buffer gets too large, clear old data
-   if (dataBuffer.size() > expectedFrameSize * 100) {
-       dataBuffer = dataBuffer.right(expectedFrameSize * 50);
-   }
-
-   if (showingAverage) {
-       updateAveragePlot();
-   }
-}
-
-int MainWindow::findFrameStart(const QByteArray& data) {
-    if (data.size() < 4) return -1;
-
-    for (int i = 0; i <= data.size() - 4; ++i) {
-        if (static_cast<uint8_t>(data[i]) == 0x00 &&
-            static_cast<uint8_t>(data[i + 1]) == 0x00 &&
-            static_cast<uint8_t>(data[i + 2]) == 0x00 &&
-            static_cast<uint8_t>(data[i + 3]) == 0x01) {
-            return i;
-            }
-    }
-    return -1;
+    // Consumer side of the acquisition queue: clear the pending flag first so
+    // frames pushed while we drain trigger a fresh notification
+    acquisitionWorker->acknowledgeFrames();
+
+    // The overload policy decides which of the queued frames are shown
+    acquisitionWorker->drainFrames([this](const SpectrumFrame& frame) { ingestFrame(frame); },
+                                   [this](const SpectrumFrame& frame) { presentFrame(frame); });
 }
 
-void MainWindow::updatePlotWithPoints(const QVector<QPointF>& points) const {
-    QVector<QPointF> filteredPoints = filterPointsByRange(points);
-    updateMainSeries(filteredPoints);
-    updatePeakIndicator(filteredPoints);
-    updateAxisRanges(filteredPoints);
-    updateLabels(filteredPoints);
+void MainWindow::updateDeviceSpectrum(std::size_t index) {
+    AcquisitionWorker& worker = pipelines[index]->worker();
+    worker.acknowledgeFrames();
+    worker.drainFrames(nullptr, [this, index](const SpectrumFrame& frame) { deviceSpectraView->setSpectrum(index, frame); });
 }
 
-QVector<QPointF> MainWindow::filterPointsByRange(const QVector<QPointF>& points) const {
-    QVector<QPointF> filteredPoints;
-    for (const auto& point : points) {
-        if (point.x() >= currentMinRange && point.x() <= currentMaxRange) {
-            filteredPoints.append(point);
-        }
+void MainWindow::ingestFrame(const SpectrumFrame& frame) {
+    if (isRecording) {
+        recordedFrames.append(frame);
     }
-    return filteredPoints;
+    frameAverager.add(frame);
+    waterfallImage.addFrame(frame.pixels.data(),
+                            showSubtracted && !backgroundSamples.empty() ? backgroundSamples.data() : nullptr);
+    saturatedSinceRender = saturatedSinceRender || frame.isSaturated();
+    ++framesAwaitingRender;
 }
 
-void MainWindow::updateMainSeries(const QVector<QPointF>& filteredPoints) const {
-    series->replace(filteredPoints);
+void MainWindow::presentFrame(const SpectrumFrame& frame) {
+    newestFrame = frame;
+    hasNewestFrame = true;
+    requestRender();
 }
 
-MainWindow::Statistics MainWindow::calculateStatistics(const QVector<QPointF>& points) const {
-    Statistics stats{};
+void MainWindow::requestRender() {
+    if (!hasNewestFrame || renderTimer->isActive()) return;
 
-    // First filter points to only include those within the current range
-    QVector<QPointF> rangePoints;
-    for (const auto& point : points) {
-        if (point.x() >= currentMinRange && point.x() <= currentMaxRange) {
-            rangePoints.append(point);
-        }
-    }
+    // Draw right away when the last draw was a refresh interval ago,
+    // otherwise at the next interval
+    const qint64 sinceLastRender = renderClock.isValid() ? renderClock.elapsed() : renderIntervalMs;
+    renderTimer->start(static_cast<int>(qMax<qint64>(0, renderIntervalMs - sinceLastRender)));
+}
 
-    if (rangePoints.isEmpty()) {
-        return stats;
+void MainWindow::renderDisplay() {
+    if (!hasNewestFrame) return;
+    renderClock.start();
+    // Every frame ingested since the last draw but the newest was skipped,
+    // whether the overload policy held it back or a newer one replaced it
+    const bool drawingNewFrame = framesAwaitingRender > 0;
+    if (drawingNewFrame) {
+        ++renderedFrames;
+        skippedDisplayFrames += framesAwaitingRender - 1;
+        framesAwaitingRender = 0;
     }
 
-    // Calculate mean
-    double sum = 0.0;
-    QVector<double> values;
-    values.reserve(rangePoints.size());
+    // Saturation in any frame since the last draw is shown, not just the newest
+    updateSaturationIndicator(saturatedSinceRender);
+    saturatedSinceRender = false;
 
-    for (const auto& point : rangePoints) {  // Use filtered points
-        sum += point.y();
-        values.append(point.y());
+    if (showingAverage) {
+        updateAveragePlot();
+    } else {
+        updatePlotWithPoints(processFrame(newestFrame));
     }
-    stats.mean = sum / rangePoints.size();
 
-    // Calculate variance and standard deviation
-    double squaredSum = 0.0;
-    for (const auto& value : values) {
-        double diff = value - stats.mean;
-        squaredSum += diff * diff;
+    // Live frames only: recordings carry the timestamps they were taken with
+    if (drawingNewFrame && acquisitionWorker->isRunning()) {
+        if (deviceSpectraView) {
+            deviceSpectraView->setSpectrum(0, newestFrame);
+        }
+        const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        displayLatency.record(nowNs - newestFrame.timestampNs);
     }
-    stats.variance = squaredSum / rangePoints.size();
-    stats.stdDev = std::sqrt(stats.variance);
 
-    // Calculate median
-    std::sort(values.begin(), values.end());
-    if (values.size() % 2 == 0) {
-        stats.median = (values[values.size()/2 - 1] + values[values.size()/2]) / 2.0;
-    } else {
-        stats.median = values[values.size()/2];
+    if (waterfallView->isVisible()) {
+        // Colours span the plot's Y range, which moves rarely thanks to the
+        // auto range hysteresis; rows already drawn keep their colours
+        const double blackLevel = isAutoYRange ? autoYRange.lower() : userMinYRange;
+        const double whiteLevel = isAutoYRange ? autoYRange.upper() : userMaxYRange;
+        waterfallImage.setLevels(static_cast<uint16_t>(qBound(0.0, blackLevel, 65535.0)),
+                                 static_cast<uint16_t>(qBound(0.0, whiteLevel, 65535.0)));
+        waterfallView->update();
     }
 
-    return stats;
+    // Refresh the readout a few times a second, not per frame
+    if (!drawTimeLabelClock.isValid() || drawTimeLabelClock.elapsed() >= 500) {
+        drawTimeLabelClock.start();
+        updateDrawTimeLabel();
+        updateFrameRateLabel();
+    }
 }
 
-void MainWindow::updatePeakIndicator(const QVector<QPointF>& filteredPoints) const {
-    double peakValue = 0;
-    int peakPixel = 0;
-    double minValue = std::numeric_limits<double>::max();
-    double maxValue = std::numeric_limits<double>::lowest();
-
-    for (const auto& point : filteredPoints) {
-        if (point.y() > peakValue) {
-            peakValue = point.y();
-            peakPixel = static_cast<int>(point.x());
-        }
-        if (point.y() < minValue) minValue = point.y();
-        if (point.y() > maxValue) maxValue = point.y();
+void MainWindow::onWaterfallToggled(bool checked) {
+    waterfallView->setVisible(checked);
+    if (checked) {
+        waterfallView->setXRange(currentMinRange, currentMaxRange);
+        requestRender();
     }
+}
 
-    QVector<QPointF> peakPoints;
-    if (peakPixel >= currentMinRange && peakPixel <= currentMaxRange) {
-        double arrowHeight = (maxValue - minValue) * 0.1;
-        double arrowWidth = (currentMaxRange - currentMinRange) * 0.02;
-
-        peakPoints << QPointF(peakPixel, maxValue + arrowHeight)
-                   << QPointF(peakPixel, peakValue + arrowHeight * 0.2);
+void MainWindow::onWaterfallDepthChanged(int depth) {
+    waterfallImage.setDepth(static_cast<std::size_t>(depth));
+    waterfallView->update();
+}
 
-        peakPoints << QPointF(peakPixel - arrowWidth, peakValue + arrowHeight * 0.6)
-                   << QPointF(peakPixel, peakValue)
-                   << QPointF(peakPixel + arrowWidth, peakValue + arrowHeight * 0.6)
-                   << QPointF(peakPixel, peakValue + arrowHeight * 0.2);
-    }
+void MainWindow::onOverloadPolicyChanged(int index) {
+    const auto policy = static_cast<AcquisitionWorker::OverloadPolicy>(overloadPolicyComboBox->itemData(index).toInt());
+    acquisitionWorker->setOverloadPolicy(policy);
+    latencyBudgetSpinBox->setEnabled(policy == AcquisitionWorker::OverloadPolicy::BoundedLatency);
+    qDebug() << "Overload policy:" << AcquisitionWorker::overloadPolicyName(policy);
+}
 
-    peakLineSeries->replace(peakPoints);
+void MainWindow::onLatencyBudgetChanged(int milliseconds) {
+    acquisitionWorker->setLatencyBudgetMs(milliseconds);
+}
 
-    QPen peakPen(Qt::red);
-    peakPen.setWidth(2);
-    peakLineSeries->setPen(peakPen);
-    peakLineSeries->setBrush(QBrush(Qt::red));
+void MainWindow::updateDrawTimeLabel() {
+    const PaintTimer& timer = useRasterPlot ? spectrumPlot->paintTimer() : chartView->paintTimer();
+    if (timer.sampleCount() == 0) {
+        drawTimeLabel->setText("Draw: N/A");
+        return;
+    }
+    drawTimeLabel->setText(QString("Draw: %1 μs").arg(timer.averageMicroseconds(), 0, 'f', 0));
 }
 
-void MainWindow::updateAxisRanges(const QVector<QPointF>& filteredPoints) const {
-    auto axisX = dynamic_cast<QValueAxis*>(chart->axes(Qt::Horizontal).first());
-    auto axisY = dynamic_cast<QValueAxis*>(chart->axes(Qt::Vertical).first());
-    if (axisX && axisY) {
-        axisX->setRange(currentMinRange, currentMaxRange);
-
-        if (isAutoYRange) {
-            double minValue = std::numeric_limits<double>::max();
-            double maxValue = std::numeric_limits<double>::lowest();
-            for (const auto& point : filteredPoints) {
-                if (point.y() < minValue) minValue = point.y();
-                if (point.y() > maxValue) maxValue = point.y();
-            }
-            double yPadding = (maxValue - minValue) * 0.15;
-            axisY->setRange(minValue - yPadding, maxValue + yPadding);
-        } else {
-            axisY->setRange(userMinYRange, userMaxYRange);
-        }
+void MainWindow::updateFrameRateLabel() {
+    if (!acquisitionWorker->isRunning()) {
+        return;
     }
+    const FrameTimingStats timing = acquisitionWorker->timingStats();
+    if (timing.frames < 2) {
+        frameRateLabel->setText("Rate: N/A");
+        return;
+    }
+    frameRateLabel->setText(QString("Rate: %1 fps ±%2 ms, %3 missing")
+                                .arg(timing.recentFrameRate(), 0, 'f', 1)
+                                .arg(timing.jitterNs / 1e6, 0, 'f', 2)
+                                .arg(timing.missingFrames));
 }
 
-void MainWindow::updateLabels(const QVector<QPointF>& filteredPoints) const {
-    double peakValue = 0;
-    int peakPixel = 0;
-    double minValue = std::numeric_limits<double>::max();
-    double maxValue = std::numeric_limits<double>::lowest();
+TelemetrySnapshot MainWindow::telemetrySnapshot() const {
+    TelemetrySnapshot snapshot = collectTelemetry(*acquisitionWorker, frameRecorder, commandQueue);
+    snapshot.framesDrawn = renderedFrames;
+    snapshot.framesSkippedForDisplay = skippedDisplayFrames;
+    snapshot.displayLatency = displayLatency.snapshot();
+    return snapshot;
+}
 
-    for (const auto& point : filteredPoints) {
-        if (point.y() > peakValue) {
-            peakValue = point.y();
-            peakPixel = static_cast<int>(point.x());
-        }
-        if (point.y() < minValue) minValue = point.y();
-        if (point.y() > maxValue) maxValue = point.y();
+void MainWindow::onTelemetryTimer() {
+    const TelemetrySnapshot current = telemetrySnapshot();
+    const double seconds = hasPreviousTelemetry ? (current.timeNs - previousTelemetry.timeNs) / 1e9 : 0.0;
+
+    // Counters restart with each acquisition, so a drop means a new one
+    if (seconds > 0.0 && current.bytesRead >= previousTelemetry.bytesRead) {
+        telemetryLabel->setText(QString("%1 MB/s  %2 frames/s  queue %3/%4  shed %5  p99 %6 ms")
+                                    .arg((current.bytesRead - previousTelemetry.bytesRead) / 1e6 / seconds, 0, 'f', 2)
+                                    .arg((current.framesParsed - previousTelemetry.framesParsed) / seconds, 0, 'f', 0)
+                                    .arg(current.displayQueueDepth)
+                                    .arg(current.displayQueueCapacity)
+                                    .arg(current.framesDropped + current.framesShed)
+                                    .arg(current.displayLatency.percentileMicroseconds(0.99) / 1e3, 0, 'f', 1));
+    }
+    if (diagnosticsPanel->isVisible()) {
+        diagnosticsPanel->showReport(QString::fromStdString(
+            formatTelemetryReport(current, hasPreviousTelemetry ? &previousTelemetry : nullptr)));
     }
 
-    double peakToPeakValue = maxValue - minValue;
+    previousTelemetry = current;
+    hasPreviousTelemetry = true;
+}
 
-    // Update existing labels
-    peakValueLabel->setText(QString("Peak Value: %1").arg(peakValue));
-    peakPixelLabel->setText(QString("Peak Pixel: %1").arg(peakPixel));
-    peakToPeakValueLabel->setText(QString("Peak to Peak Value: %1").arg(peakToPeakValue));
+void MainWindow::onSaveDiagnosticsClicked() {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Diagnostics Report"),
+                                                    QDir::homePath(), tr("Text Files (*.txt)"));
+    if (fileName.isEmpty()) return;
 
-    // Calculate and update statistical labels
-    Statistics stats = calculateStatistics(filteredPoints);
-    varianceLabel->setText(QString("Variance: %1").arg(stats.variance, 0, 'f', 2));
-    stdDevLabel->setText(QString("Std Dev: %1").arg(stats.stdDev, 0, 'f', 2));
-    meanLabel->setText(QString("Mean: %1").arg(stats.mean, 0, 'f', 2));
-    medianLabel->setText(QString("Median: %1").arg(stats.median, 0, 'f', 2));
+    try {
+        saveTelemetryReport(std::filesystem::path(fileName.toStdWString()),
+                            formatTelemetryReport(telemetrySnapshot(), hasPreviousTelemetry ? &previousTelemetry : nullptr));
+        updateStatusBar(tr("Saved diagnostics to %1").arg(QFileInfo(fileName).fileName()));
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot save diagnostics: %1").arg(e.what()));
+    }
+}
 
-    qDebug() << "Frame processed, Exp:" << defaultExposureTime;
+void MainWindow::onPlotRendererChanged(int index) {
+    useRasterPlot = plotRendererComboBox->itemData(index).toBool();
+    spectrumPlot->setVisible(useRasterPlot);
+    chartView->setVisible(!useRasterPlot);
+
+    // The hidden renderer stops being updated, so bring this one up to date
+    if (useRasterPlot) {
+        spectrumPlot->setStoredTraces(storedTraces);
+    }
+    updateAllSeriesWithNewRange();
+    updateDrawTimeLabel();
 }
 
-void MainWindow::updateAveragePlot() {
-    if (lastTenFrames.isEmpty()) return;
+void MainWindow::updatePlotWithPoints(const QVector<QPointF>& points) {
+    QVector<QPointF> filteredPoints = filterPointsByRange(points);
+    updateMainSeries(filteredPoints);
+
+    // One statistics pass feeds the peak marker, the axes and the labels
+    const SpectrumStatistics stats = statisticsOf(filteredPoints);
+    updatePeakIndicator(stats);
+    updateAxisRanges(stats);
+    updateLabels(stats);
 
-    QVector<QPointF> averagePoints;
-    qsizetype numPoints = lastTenFrames.first().size();
-    averagePoints.reserve(numPoints);
+    // The peak search runs over the values the statistics pass gathered
+    const int firstPixel = filteredPoints.isEmpty() ? 0 : static_cast<int>(filteredPoints.first().x());
+    detectPeaks(statisticsValues.data(), statisticsValues.size(), firstPixel, peakSettings, detectedPeaks);
+    updateDetectedPeaks();
+}
 
-    for (int i = 0; i < numPoints; ++i) {
-        double sum = 0;
-        for (const auto& frame : lastTenFrames) {
-            sum += frame[i].y();
+void MainWindow::updateDetectedPeaks() {
+    if (useRasterPlot) {
+        spectrumPlot->setDetectedPeaks(detectedPeaks);
+    } else {
+        QVector<QPointF> markers;
+        markers.reserve(static_cast<qsizetype>(detectedPeaks.size()));
+        for (const SpectrumPeak& peak : detectedPeaks) {
+            markers.append(QPointF(toAxisX(peak.centre), peak.height));
         }
-        double average = sum / static_cast<double>(lastTenFrames.size());
-        averagePoints.append(QPointF(lastTenFrames.first()[i].x(), average));
+        peakMarkerSeries->replace(markers);
     }
 
-    QMetaObject::invokeMethod(this, [this, averagePoints]() {
-        updatePlotWithPoints(averagePoints);
-    }, Qt::QueuedConnection);
+    const auto mostProminent = std::max_element(detectedPeaks.begin(), detectedPeaks.end(),
+        [](const SpectrumPeak& a, const SpectrumPeak& b) { return a.prominence < b.prominence; });
+    fwhmLabel->setText(mostProminent == detectedPeaks.end()
+                           ? QString("FWHM: N/A")
+                           : QString("FWHM: %1 %2").arg(axisWidth(*mostProminent), 0, 'f', 2)
+                                 .arg(spectralUnitSymbol(axisUnit)));
+
+    // A table refresh costs far more than the search, so it is throttled
+    if (peakTable->isVisible() &&
+        (!peakTableClock.isValid() || peakTableClock.elapsed() >= PeakTableIntervalMs)) {
+        peakTableClock.start();
+        updatePeakTable();
+    }
 }
 
-QVector<QPointF> MainWindow::processFrame(const QByteArray& frameData) {
-    QVector<QPointF> newPoints;
-    newPoints.reserve(1024); // 1044 total pixels - 10 from each side
+void MainWindow::updatePeakTable() {
+    peakTable->setRowCount(static_cast<int>(detectedPeaks.size()));
+    const auto setCell = [this](int row, int column, const QString& text) {
+        QTableWidgetItem* item = peakTable->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            peakTable->setItem(row, column, item);
+        }
+        item->setText(text);
+    };
+    for (int row = 0; row < static_cast<int>(detectedPeaks.size()); ++row) {
+        const SpectrumPeak& peak = detectedPeaks[static_cast<std::size_t>(row)];
+        setCell(row, 0, QString::number(toAxisX(peak.centre), 'f', 2));
+        setCell(row, 1, QString::number(peak.height, 'f', 0));
+        setCell(row, 2, QString::number(peak.prominence, 'f', 0));
+        setCell(row, 3, QString::number(axisWidth(peak), 'f', 2));
+        setCell(row, 4, QString::number(peak.area, 'f', 0));
+    }
+}
 
-    double peakValue = 0;
-    double minValue = std::numeric_limits<double>::max();
-    double maxValue = std::numeric_limits<double>::lowest();
-    bool isSaturating = false;
+void MainWindow::onPeakProminenceChanged(int prominence) {
+    peakSettings.minProminence = prominence;
+    updatePlotWithPoints(displayedPoints);
+}
 
-    // Skip the 4-byte header and start processing data
-    for (int i = 4; i < frameData.size(); i += 2) {
-        uint16_t value = (static_cast<uint8_t>(frameData[i]) << 8) | static_cast<uint8_t>(frameData[i + 1]);
-        auto adjustedValue = static_cast<double>(value);
+void MainWindow::onPeakCentreChanged(int index) {
+    peakSettings.centre = static_cast<PeakCentre>(peakCentreComboBox->itemData(index).toInt());
+    updatePlotWithPoints(displayedPoints);
+}
 
-        if (adjustedValue >= 65535) {
-            isSaturating = true;
-        }
+void MainWindow::onPeakTableToggled(bool checked) {
+    peakTable->setVisible(checked);
+    if (checked) {
+        updatePeakTable();
+    }
+}
 
-        if (showSubtracted && !backgroundData.isEmpty() && (i / 2) - 2 < backgroundData.size()) {
-            double backgroundValue = backgroundData.at((i / 2) - 2).y();
-            adjustedValue = adjustedValue - backgroundValue;
-        }
+QString MainWindow::profileDirectory() const {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/profiles";
+}
 
-        // Adjust the pixel index to account for the header
-        newPoints.append(QPointF(static_cast<double>((i - 4) / 2.0), adjustedValue));
+void MainWindow::loadDeviceProfile() {
+    // The main plot shows the first head, so its profile sets the axis
+    const std::filesystem::path directory(profileDirectory().toStdWString());
+    WavelengthCalibration loaded;
+    try {
+        loaded = loadWavelengthCalibration(deviceProfilePath(directory, pipelines.front()->serialNumber()));
+    } catch (const std::exception& e) {
+        qWarning() << "Ignoring the device profile:" << e.what();
+    }
+    setCalibration(loaded);
+}
 
-        if (adjustedValue > peakValue) {
-            peakValue = adjustedValue;
-        }
+void MainWindow::setCalibration(const WavelengthCalibration& updated) {
+    // A head that gains a calibration switches to nm; a unit the new
+    // calibration cannot provide falls back to pixels
+    const bool newlyCalibrated = !calibration.isCalibrated() && updated.isCalibrated();
+    calibration = updated;
+    updateAxisUnitChoices();
 
-        if (adjustedValue < minValue) minValue = adjustedValue;
-        if (adjustedValue > maxValue) maxValue = adjustedValue;
+    SpectralUnit unit = calibration.supports(axisUnit) ? axisUnit : SpectralUnit::Pixel;
+    if (newlyCalibrated) {
+        unit = SpectralUnit::Wavelength;
+    }
+    {
+        const QSignalBlocker blocker(axisUnitComboBox);
+        axisUnitComboBox->setCurrentIndex(axisUnitComboBox->findData(static_cast<int>(unit)));
     }
+    axisUnit = unit;
+    applyAxisUnit();
+}
 
-    if (isRecording) {
-        allFramesData.append(newPoints);
+void MainWindow::updateAxisUnitChoices() {
+    // Units the calibration cannot provide stay listed, disabled
+    auto model = qobject_cast<QStandardItemModel*>(axisUnitComboBox->model());
+    if (!model) return;
+    for (int index = 0; index < axisUnitComboBox->count(); ++index) {
+        const auto unit = static_cast<SpectralUnit>(axisUnitComboBox->itemData(index).toInt());
+        if (QStandardItem* item = model->item(index)) {
+            item->setEnabled(calibration.supports(unit));
+        }
     }
+}
 
-    // Update the saturation indicator
-    QMetaObject::invokeMethod(this, [this, isSaturating]() {
-        updateSaturationIndicator(isSaturating);
-    }, Qt::QueuedConnection);
+void MainWindow::applyAxisUnit() {
+    const QString title = spectralUnitTitle(axisUnit);
+    const QString symbol = spectralUnitSymbol(axisUnit);
+    const bool pixels = axisUnit == SpectralUnit::Pixel;
+    const double first = toAxisX(currentMinRange);
+    const double last = toAxisX(currentMaxRange);
 
-    return newPoints;
+    spectrumPlot->setAxisTitles(title, "Intensity");
+    spectrumPlot->setXAxisCalibration(calibration, axisUnit);
+    if (auto axisX = dynamic_cast<QValueAxis*>(chart->axes(Qt::Horizontal).first())) {
+        axisX->setTitleText(title);
+        axisX->setLabelFormat(pixels ? "%i" : "%.1f");
+        axisX->setReverse(calibration.isDescending(axisUnit));
+        axisX->setRange(std::min(first, last), std::max(first, last));
+    }
+    peakTable->setHorizontalHeaderLabels({QString("Centre (%1)").arg(symbol), "Height", "Prominence",
+                                          QString("FWHM (%1)").arg(symbol), "Area"});
+
+    // The range boxes change unit; the range itself stays where it was
+    const double lowest = std::min(toAxisX(0), toAxisX(LastRangePixel));
+    const double highest = std::max(toAxisX(0), toAxisX(LastRangePixel));
+    for (QDoubleSpinBox* box : {minRangeSpinBox, maxRangeSpinBox}) {
+        box->setDecimals(pixels ? 0 : 2);
+        box->setSuffix(pixels ? QString() : " " + symbol);
+        box->setRange(lowest, highest);
+        box->setSingleStep(pixels ? 1.0 : (highest - lowest) / LastRangePixel);  // About a pixel
+    }
+    minRangeSpinBox->setValue(std::min(first, last));
+    maxRangeSpinBox->setValue(std::max(first, last));
+
+    // The chart series hold axis values, so they are rebuilt
+    updateAllSeriesWithNewRange();
 }
 
-void MainWindow::onToggleAverageView() {
-    showingAverage = !showingAverage;
-    if (showingAverage) {
-        updateAveragePlot();
-    } else {
-        updatePlot();
-    }
+void MainWindow::onAxisUnitChanged(int index) {
+    axisUnit = static_cast<SpectralUnit>(axisUnitComboBox->itemData(index).toInt());
+    applyAxisUnit();
 }
 
-void MainWindow::onToggleYRangeClicked() {
-    isAutoYRange = toggleYRangeButton->isChecked();
-    minYRangeSpinBox->setEnabled(!isAutoYRange);
-    maxYRangeSpinBox->setEnabled(!isAutoYRange);
+void MainWindow::onCalibrationClicked() {
+    QDialog dialog(this);
+    dialog.setWindowTitle("Wavelength Calibration");
+    auto layout = new QFormLayout(&dialog);
+
+    QStringList terms;
+    for (double coefficient : calibration.coefficients()) {
+        terms << QString::number(coefficient, 'g', 17);
+    }
+    auto coefficientsEdit = new QLineEdit(terms.join(' '), &dialog);
+    coefficientsEdit->setPlaceholderText("c0 c1 c2 ...");
+    coefficientsEdit->setToolTip("Wavelength in nm at pixel p is c0 + c1 p + c2 p^2 + ...; leave empty for none");
+    auto laserSpinBox = new QDoubleSpinBox(&dialog);
+    laserSpinBox->setRange(0.0, 10000.0);
+    laserSpinBox->setDecimals(3);
+    laserSpinBox->setSuffix(" nm");
+    laserSpinBox->setSpecialValueText("None");
+    laserSpinBox->setValue(calibration.laserWavelength());
+    laserSpinBox->setToolTip("Excitation wavelength the Raman shift is measured from");
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow("Coefficients:", coefficientsEdit);
+    layout->addRow("Laser line:", laserSpinBox);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    std::vector<double> coefficients;
+    for (const QString& term : coefficientsEdit->text().split(' ', Qt::SkipEmptyParts)) {
+        bool valid = false;
+        coefficients.push_back(term.toDouble(&valid));
+        if (!valid) {
+            QMessageBox::warning(this, "Invalid Calibration", QString("%1 is not a number.").arg(term));
+            return;
+        }
+    }
 
-    if (isAutoYRange) {
-        toggleYRangeButton->setText("Auto Y Range");
-    } else {
-        toggleYRangeButton->setText("Manual Y Range");
-        userMinYRange = minYRangeSpinBox->value();
-        userMaxYRange = maxYRangeSpinBox->value();
+    // Checked and expanded into its tables before anything changes
+    WavelengthCalibration updated;
+    try {
+        updated.setCoefficients(coefficients);
+        updated.setLaserWavelength(laserSpinBox->value());
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Invalid Calibration", e.what());
+        return;
     }
+    setCalibration(updated);
 
-    updatePlot();  // Update the plot to reflect the new Y-range settings
+    // An FTDI head that failed to open has no serial number to file it under
+    const std::string serialNumber = pipelines.front()->serialNumber();
+    if (serialNumber.empty()) {
+        updateStatusBar(tr("Calibration applied but not saved: the spectrometer has no serial number"), 5000);
+        return;
+    }
+    const std::filesystem::path directory(profileDirectory().toStdWString());
+    try {
+        saveWavelengthCalibration(deviceProfilePath(directory, serialNumber), serialNumber, calibration);
+        updateStatusBar(tr("Calibration saved to the profile of %1").arg(QString::fromStdString(serialNumber)));
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Save Error", QString("The calibration applies but was not saved: %1").arg(e.what()));
+    }
 }
 
+double MainWindow::toAxisX(double pixel) const {
+    return axisUnit == SpectralUnit::Pixel ? pixel : calibration.valueAt(pixel, axisUnit);
+}
 
+QVector<QPointF> MainWindow::toAxisX(const QVector<QPointF>& points) const {
+    // QtCharts needs the axis values themselves: a table lookup per point
+    if (axisUnit == SpectralUnit::Pixel) return points;
+    QVector<QPointF> converted(points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        converted[i] = QPointF(calibration.valueAt(points[i].x(), axisUnit), points[i].y());
+    }
+    return converted;
+}
 
+double MainWindow::axisWidth(const SpectrumPeak& peak) const {
+    return std::abs(toAxisX(peak.rightHalf) - toAxisX(peak.leftHalf));
+}
 
+SpectrumStatistics MainWindow::statisticsOf(const QVector<QPointF>& points) const {
+    // Points cover a contiguous pixel range, so only the y values are needed
+    statisticsValues.resize(points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        statisticsValues[i] = static_cast<float>(points[i].y());
+    }
+    const int firstPixel = points.isEmpty() ? 0 : static_cast<int>(points.first().x());
+    return computeStatistics(statisticsValues.data(), statisticsValues.size(), firstPixel);
+}
 
+QVector<QPointF> MainWindow::filterPointsByRange(const QVector<QPointF>& points) const {
+    // Traces hold consecutive pixels, so the range is a single slice
+    if (points.isEmpty()) return {};
+    const SampleSpan span = visibleSamples(static_cast<std::size_t>(points.size()), points.first().x(),
+                                           currentMinRange, currentMaxRange);
+    return points.mid(static_cast<qsizetype>(span.first), static_cast<qsizetype>(span.count));
+}
 
+void MainWindow::updateMainSeries(const QVector<QPointF>& filteredPoints) {
+    displayedPoints = filteredPoints;
+    if (useRasterPlot) {
+        spectrumPlot->setTrace(filteredPoints);
+    } else {
+        series->replace(toAxisX(filteredPoints));
+    }
+}
 
+void MainWindow::updatePeakIndicator(const SpectrumStatistics& stats) const {
+    const double peakValue = stats.peakValue;
+    const int peakPixel = stats.peakPixel;
+    const double minValue = stats.minimum;
+    const double maxValue = stats.maximum;
 
+    if (useRasterPlot) {
+        if (stats.count > 0 && peakPixel >= currentMinRange && peakPixel <= currentMaxRange) {
+            spectrumPlot->setPeakMarker(peakPixel, peakValue);
+        } else {
+            spectrumPlot->clearPeakMarker();
+        }
+        return;
+    }
 
+    QVector<QPointF> peakPoints;
+    if (stats.count > 0 && peakPixel >= currentMinRange && peakPixel <= currentMaxRange) {
+        double arrowHeight = (maxValue - minValue) * 0.1;
+        double arrowWidth = (currentMaxRange - currentMinRange) * 0.02;
 
+        peakPoints << QPointF(peakPixel, maxValue + arrowHeight)
+                   << QPointF(peakPixel, peakValue + arrowHeight * 0.2);
 
+        peakPoints << QPointF(peakPixel - arrowWidth, peakValue + arrowHeight * 0.6)
+                   << QPointF(peakPixel, peakValue)
+                   << QPointF(peakPixel + arrowWidth, peakValue + arrowHeight * 0.6)
+                   << QPointF(peakPixel, peakValue + arrowHeight * 0.2);
+    }
 
+    peakLineSeries->replace(toAxisX(peakPoints));
 
-void MainWindow::trig_on() const {
-    qDebug() << "Turning trigger on";
-    char ex[4] = {2, 0, 0, 0};
-    DWORD bytesWritten, bytesRead;
-    int retries = 0;
-    constexpr int maxRetries = 5;
+    QPen peakPen(Qt::red);
+    peakPen.setWidth(2);
+    peakLineSeries->setPen(peakPen);
+    peakLineSeries->setBrush(QBrush(Qt::red));
+}
 
-    do {
-        if (retries > 0) {
-            qDebug() << "Retrying to turn trigger on. Attempt:" << retries + 1;
+void MainWindow::updateAxisRanges(const SpectrumStatistics& stats) {
+    // Auto range only moves when the signal leaves its band, so most frames
+    // leave the axes, and the layout that depends on them, untouched
+    double minY = userMinYRange;
+    double maxY = userMaxYRange;
+    if (isAutoYRange) {
+        if (stats.count > 0) {
+            autoYRange.update(stats.minimum, stats.maximum);
         }
+        if (!autoYRange.isValid()) return;
+        minY = autoYRange.lower();
+        maxY = autoYRange.upper();
+    }
 
-        QThread::msleep(50);
+    if (useRasterPlot) {
+        spectrumPlot->setXRange(currentMinRange, currentMaxRange);
+        spectrumPlot->setYRange(minY, maxY);
+        return;
+    }
 
-        FT_STATUS writeStatus = FT_Write(fthandle_uart, ex, 4, &bytesWritten);
-        if (writeStatus != FT_OK || bytesWritten != 4) {
-            qDebug() << "Failed to write trig_on command. Status:" << writeStatus << "Bytes written:" << bytesWritten;
-            throw std::runtime_error("Failed to write trig_on command");
+    auto axisX = dynamic_cast<QValueAxis*>(chart->axes(Qt::Horizontal).first());
+    auto axisY = dynamic_cast<QValueAxis*>(chart->axes(Qt::Vertical).first());
+    if (axisX && axisY) {
+        const double first = toAxisX(currentMinRange);
+        const double last = toAxisX(currentMaxRange);
+        if (axisX->min() != std::min(first, last) || axisX->max() != std::max(first, last)) {
+            axisX->setRange(std::min(first, last), std::max(first, last));
         }
-
-        FT_STATUS readStatus = FT_Read(fthandle_uart, ex, 1, &bytesRead);
-        if (readStatus != FT_OK || bytesRead != 1) {
-            qDebug() << "Failed to read trig_on response. Status:" << readStatus << "Bytes read:" << bytesRead;
-            throw std::runtime_error("Failed to read trig_on response");
+        if (axisY->min() != minY || axisY->max() != maxY) {
+            axisY->setRange(minY, maxY);
         }
+    }
+}
 
-        retries++;
-    } while (ex[0] != 't' && retries < maxRetries);
+void MainWindow::updateLabels(const SpectrumStatistics& stats) const {
+    double peakToPeakValue = stats.maximum - stats.minimum;
 
-    if (ex[0] != 't') {
-        qDebug() << "Failed to turn trigger on after" << maxRetries << "attempts";
-        throw std::runtime_error("Failed to turn trigger on");
+    // Update existing labels
+    peakValueLabel->setText(QString("Peak Value: %1").arg(stats.peakValue));
+    if (axisUnit == SpectralUnit::Pixel) {
+        peakPixelLabel->setText(QString("Peak Pixel: %1").arg(stats.peakPixel));
+    } else {
+        peakPixelLabel->setText(QString("Peak Pixel: %1 (%2 %3)").arg(stats.peakPixel)
+                                    .arg(toAxisX(stats.peakPixel), 0, 'f', 2).arg(spectralUnitSymbol(axisUnit)));
     }
+    peakToPeakValueLabel->setText(QString("Peak to Peak Value: %1").arg(peakToPeakValue));
 
-    qDebug() << "Trigger turned on successfully";
+    // Update statistical labels
+    varianceLabel->setText(QString("Variance: %1").arg(stats.variance, 0, 'f', 2));
+    stdDevLabel->setText(QString("Std Dev: %1").arg(stats.stdDev, 0, 'f', 2));
+    meanLabel->setText(QString("Mean: %1").arg(stats.mean, 0, 'f', 2));
+    medianLabel->setText(QString("Median: %1").arg(stats.median, 0, 'f', 2));
 }
 
-void MainWindow::trig_off() const {
-    qDebug() << "Turning trigger off";
-    char ex[4] = {3, 0, 0, 0};
-    DWORD bytesWritten, bytesRead;
-    int retries = 0;
-    constexpr int maxRetries = 5;
-
-    do {
-        if (retries > 0) {
-            qDebug() << "Retrying to turn trigger off. Attempt:" << retries + 1;
-            QThread::msleep(50);
+void MainWindow::updateAveragePlot() {
+    if (frameAverager.isEmpty()) return;
+
+    // The engine averages raw samples; the background is subtracted once
+    // from the result, which is the same as averaging corrected frames
+    frameAverager.average(averageValues.data());
+    if (showSubtracted && !backgroundLevels.empty()) {
+        for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+            averageValues[pixel] -= backgroundLevels[pixel];
         }
+    }
 
-        // Clear any pending data
-        FT_Purge(fthandle_uart, FT_PURGE_RX | FT_PURGE_TX);
+    QVector<QPointF> averagePoints(SpectrumFrame::PixelCount);
+    QPointF* points = averagePoints.data();
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        points[pixel] = QPointF(pixel, averageValues[pixel]);
+    }
 
-        // Write command
-        FT_STATUS writeStatus = FT_Write(fthandle_uart, ex, 4, &bytesWritten);
-        if (writeStatus != FT_OK || bytesWritten != 4) {
-            qDebug() << "Failed to write trig_off command. Status:" << writeStatus << "Bytes written:" << bytesWritten;
-            if (retries == maxRetries - 1) {
-                throw std::runtime_error("Failed to write trig_off command");
-            }
-            continue;
-        }
+    updatePlotWithPoints(averagePoints);
+}
 
-        // Wait for response
-        QThread::msleep(20);
+void MainWindow::onAverageModeChanged(int index) {
+    frameAverager.setMode(static_cast<FrameAverager::Mode>(averageModeComboBox->itemData(index).toInt()));
+    updateStatusBar(tr("Averaging mode: %1").arg(averageModeComboBox->itemText(index)));
+}
 
-        // Read response
-        FT_STATUS readStatus = FT_Read(fthandle_uart, ex, 1, &bytesRead);
-        if (readStatus != FT_OK || bytesRead != 1) {
-            qDebug() << "Failed to read trig_off response. Status:" << readStatus << "Bytes read:" << bytesRead;
-            if (retries == maxRetries - 1) {
-                throw std::runtime_error("Failed to read trig_off response");
-            }
-            continue;
-        }
+void MainWindow::onAverageWindowChanged(int window) {
+    frameAverager.setWindow(static_cast<std::size_t>(window));
+}
 
-        qDebug() << "Received response byte:" << static_cast<int>(ex[0]);
+QVector<QPointF> MainWindow::processFrame(const SpectrumFrame& frame) {
+    // Samples arrive decoded by the acquisition thread, with their raw range;
+    // conversion and background subtraction are a single vectorised pass
+    const float* background = showSubtracted && !backgroundLevels.empty() ? backgroundLevels.data() : nullptr;
+    correctSpectrum(frame.pixels.data(), background, correctedValues.data(), correctedValues.size());
 
-        // Check for expected response ('t') or alternative valid responses
-        if (ex[0] == 't' || ex[0] == 'T' || ex[0] == 0x74) {
-            qDebug() << "Trigger turned off successfully";
-            return;
-        }
+    QVector<QPointF> newPoints(SpectrumFrame::PixelCount);
+    QPointF* points = newPoints.data();
+    for (int pixel = 0; pixel < SpectrumFrame::PixelCount; ++pixel) {
+        points[pixel] = QPointF(pixel, correctedValues[pixel]);
+    }
 
-        retries++;
-    } while (retries < maxRetries);
+    return newPoints;
+}
 
-    qDebug() << "Failed to turn trigger off after" << maxRetries << "attempts. Last response:" << static_cast<int>(ex[0]);
-    throw std::runtime_error("Failed to turn trigger off after maximum retries");
+void MainWindow::onToggleAverageView() {
+    showingAverage = !showingAverage;
+    requestRender();
 }
 
+void MainWindow::onToggleYRangeClicked() {
+    isAutoYRange = toggleYRangeButton->isChecked();
+    minYRangeSpinBox->setEnabled(!isAutoYRange);
+    maxYRangeSpinBox->setEnabled(!isAutoYRange);
 
-void MainWindow::set_exp(uint32_t exp) const {
-    qDebug() << "set_exp called with exposure time:" << exp;
+    if (isAutoYRange) {
+        toggleYRangeButton->setText("Auto Y Range");
+    } else {
+        toggleYRangeButton->setText("Manual Y Range");
+        userMinYRange = minYRangeSpinBox->value();
+        userMaxYRange = maxYRangeSpinBox->value();
+    }
 
-    char ex[1];
-    int retries = 0;
-    constexpr int maxRetries = 5;
+    requestRender();  // Redraw to reflect the new Y-range settings
+}
 
-    do {
-        if (retries > 0) {
-            qDebug() << "Retrying to set exposure time. Attempt:" << retries + 1;
-        }
 
-        QThread::msleep(50);
 
-        DWORD bytesWritten;
-        qDebug() << "Writing exposure time to device";
-        FT_STATUS writeStatus = FT_Write(fthandle_uart, &exp, sizeof(exp), &bytesWritten);
-        if (writeStatus != FT_OK) {
-            qDebug() << "FT_Write failed with status:" << writeStatus;
-            throw std::runtime_error("Failed to write exposure time to device");
-        }
 
-        if (bytesWritten != sizeof(exp)) {
-            qDebug() << "Failed to write all bytes. Bytes written:" << bytesWritten;
-            throw std::runtime_error("Failed to write all bytes of exposure time");
-        }
 
-        qDebug() << "Successfully wrote" << bytesWritten << "bytes to device";
 
-        DWORD bytesRead;
-        qDebug() << "Reading response from device";
-        FT_STATUS readStatus = FT_Read(fthandle_uart, ex, 1, &bytesRead);
-        if (readStatus != FT_OK) {
-            qDebug() << "FT_Read failed with status:" << readStatus;
-            throw std::runtime_error("Failed to read response from device");
-        }
 
-        if (bytesRead != 1) {
-            qDebug() << "Failed to read response byte. Bytes read:" << bytesRead;
-            throw std::runtime_error("Failed to read response byte");
-        }
 
-        qDebug() << "Read" << bytesRead << "bytes from device. Response:" << static_cast<int>(ex[0]);
 
-        retries++;
-    } while (ex[0] != 'A' && retries < maxRetries);
 
-    if (ex[0] != 'A') {
-        qDebug() << "Failed to set exposure time after" << maxRetries << "attempts";
-        throw std::runtime_error("Device did not acknowledge exposure time change");
-    }
 
-    qDebug() << "Exposure time successfully set to:" << exp;
+
+
+void MainWindow::submitDeviceCommand(const DeviceCommand& command,
+                                     std::function<void(const DeviceCommandResult&)> finished) {
+    submitDeviceCommand(*pipelines.front(), command, std::move(finished));
+}
+
+void MainWindow::submitDeviceCommand(SpectrometerPipeline& pipeline, const DeviceCommand& command,
+                                     std::function<void(const DeviceCommandResult&)> finished) {
+    pipeline.commands().submit(command, [this, finished = std::move(finished)](const DeviceCommandResult& result) {
+        QMetaObject::invokeMethod(this, [this, finished, result]() {
+            onDeviceCommandFinished(result, finished);
+        }, Qt::QueuedConnection);
+    });
 }
 
+void MainWindow::onDeviceCommandFinished(const DeviceCommandResult& result,
+                                         const std::function<void(const DeviceCommandResult&)>& finished) {
+    if (result.succeeded) {
+        qDebug() << "Device command" << result.command.name() << "acknowledged in" << result.roundTripNs / 1e6
+                 << "ms after" << result.attempts << "attempt(s)";
+    } else {
+        qDebug() << "Device command" << result.command.name() << "failed after" << result.attempts
+                 << "attempt(s):" << QString::fromStdString(result.error);
+    }
 
+    if (finished) {
+        finished(result);
+    } else if (!result.succeeded) {
+        updateStatusBar(tr("Error: %1 failed").arg(result.command.name()), 5000);
+        QMessageBox::critical(this, "Device Error", QString::fromStdString(result.error));
+    }
+}
 
 void MainWindow::onSetExposureClicked() {
     qDebug() << "onSetExposureClicked called";
 
-    if (ftHandle == nullptr || fthandle_uart == nullptr) {
+    if (!device->isOpen()) {
         qDebug() << "Device Error: Devices are not properly initialized.";
         QMessageBox::critical(this, "Device Error", "Devices are not properly initialized. Please check the connection.");
         return;
@@ -1262,32 +1977,44 @@ void MainWindow::onSetExposureClicked() {
 
     qDebug() << "Attempting to set exposure time to:" << exposureTime;
 
-    const bool wasRunning = timer->isActive();
-    if (wasRunning) {
-        qDebug() << "Stopping data acquisition before changing exposure time";
-        stopDataAcquisition();
-    }
-
-    qDebug() << "Data acquisition stopped, proceeding to set new exposure time";
-
-    // Add a try-catch block to catch any exceptions
-    try {
-        qDebug() << "Calling set_exp with exposure time:" << exposureTime;
-        set_exp(static_cast<uint32_t>(exposureTime));
-        defaultExposureTime = exposureTime;
-        qDebug() << "Exposure time successfully set to:" << exposureTime;
-    } catch (const std::exception& e) {
-        qDebug() << "Exception caught while setting exposure time:" << e.what();
-        QMessageBox::critical(this, "Error", QString("Failed to set exposure time: %1").arg(e.what()));
-        return;
-    }
+    // The acquisition keeps running: frames are tagged with the new exposure
+    // from the command thread as soon as the head acknowledges it
+    const auto exposure = static_cast<uint32_t>(exposureTime);
+    updateStatusBar(tr("Setting exposure time to %1 μs...").arg(exposure));
+    commandQueue->submit(DeviceCommand::setExposure(exposure), [this, exposure](const DeviceCommandResult& result) {
+        if (result.succeeded) {
+            acquisitionWorker->changeExposureTime(exposure, result.acknowledgedNs);
+        }
+        QMetaObject::invokeMethod(this, [this, exposure, result]() {
+            onDeviceCommandFinished(result, [this, exposure](const DeviceCommandResult& outcome) {
+                if (!outcome.succeeded) {
+                    QMessageBox::critical(this, "Error", QString("Failed to set exposure time: %1")
+                                                             .arg(QString::fromStdString(outcome.error)));
+                    return;
+                }
+                defaultExposureTime = exposure;
+                updateStatusBar(tr("Exposure time set to %1 μs (acknowledged in %2 ms)")
+                                    .arg(exposure)
+                                    .arg(outcome.roundTripNs / 1e6, 0, 'f', 1));
+            });
+        }, Qt::QueuedConnection);
+    });
 
-    if (wasRunning) {
-        qDebug() << "Restarting data acquisition after changing exposure time";
-        startDataAcquisition();
+    // The other heads follow, each tagging its frames as it acknowledges
+    for (std::size_t index = 1; index < pipelines.size(); ++index) {
+        SpectrometerPipeline* other = pipelines[index].get();
+        other->commands().submit(DeviceCommand::setExposure(exposure), [this, other, exposure](const DeviceCommandResult& result) {
+            if (result.succeeded) {
+                other->worker().changeExposureTime(exposure, result.acknowledgedNs);
+                return;
+            }
+            const QString serialNumber = QString::fromStdString(other->serialNumber());
+            QMetaObject::invokeMethod(this, [this, serialNumber, result]() {
+                QMessageBox::critical(this, "Error", QString("Failed to set exposure time on %1: %2")
+                                                         .arg(serialNumber, QString::fromStdString(result.error)));
+            }, Qt::QueuedConnection);
+        });
     }
-
-    qDebug() << "onSetExposureClicked completed successfully";
 }
 
 
@@ -1317,17 +2044,23 @@ void MainWindow::onSaveDataClicked() {
         return; // This shouldn't happen, but just in case
     }
 
+    // The export reads the recorded frames in place, so they must stop growing
+    if (saveAllFrames && isRecording && acquisitionWorker->isRunning()) {
+        QMessageBox::warning(this, tr("Export"), tr("Stop the acquisition before exporting all frames."));
+        return;
+    }
+
     QString selectedFilter;
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save Data File"),
                                                     QDir::homePath(),
-                                                    tr("CSV Files (*.csv);;Text Files (*.txt);;JSON Files (*.json)"),
+                                                    tr("CSV Files (*.csv);;Text Files (*.txt);;JSON Files (*.json);;Columnar JSON Files (*.json);;NumPy Files (*.npy)"),
                                                     &selectedFilter);
     if (fileName.isEmpty()) return;
 
     QFileInfo fileInfo(fileName);
     QString extension = fileInfo.suffix().toLower();
 
-    if (extension != "csv" && extension != "txt" && extension != "json") {
+    if (extension != "csv" && extension != "txt" && extension != "json" && extension != "npy") {
         // If no valid extension, default to the selected filter
         if (selectedFilter.contains("csv")) {
             fileName += ".csv";
@@ -1335,146 +2068,148 @@ void MainWindow::onSaveDataClicked() {
         } else if (selectedFilter.contains("txt")) {
             fileName += ".txt";
             extension = "txt";
+        } else if (selectedFilter.contains("npy")) {
+            fileName += ".npy";
+            extension = "npy";
         } else {
             fileName += ".json";
             extension = "json";
         }
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, tr("Error"), tr("Cannot open file for writing."));
-        return;
-    }
-
-    QTextStream out(&file);
-
-    if (extension == "csv" || extension == "txt") {
-        saveAsCSVorTXT(out, saveAllFrames, extension);
-    } else if (extension == "json") {
-        saveAsJSON(out, saveAllFrames);
+    ExportFormat format = ExportFormat::Json;
+    if (extension == "csv") {
+        format = ExportFormat::Csv;
+    } else if (extension == "txt") {
+        format = ExportFormat::Txt;
+    } else if (extension == "npy") {
+        format = ExportFormat::Npy;
+    } else if (selectedFilter.contains("Columnar")) {
+        format = ExportFormat::JsonColumnar;
     }
-
-    file.close();
-
-    QMessageBox::information(this, tr("Success"), tr("Data saved successfully."));
+    startExport(fileName, exportRequest(saveAllFrames, format));
 }
 
 
 
 
-void MainWindow::saveAsCSVorTXT(QTextStream& out, bool saveAllFrames, const QString& extension) {
-    QString separator = (extension == "csv") ? "," : "\t";
-    Statistics stats = calculateStatistics(series->points());
-    out << "Statistics:\n";
-    out << "Mean" << separator << stats.mean << "\n";
-    out << "Median" << separator << stats.median << "\n";
-    out << "Variance" << separator << stats.variance << "\n";
-    out << "Standard Deviation" << separator << stats.stdDev << "\n\n";
-    // Write the current series data
-    out << "Current Series Data:\n";
-    out << "Pixel" << separator << "Intensity\n";
-    for (const QPointF &point : series->points()) {
-        out << point.x() << separator << point.y() << "\n";
+ExportRequest MainWindow::exportRequest(bool saveAllFrames, ExportFormat format) const {
+    ExportRequest request;
+    request.format = format;
+    request.statistics = statisticsOf(displayedPoints);
+    request.currentSeries.reserve(displayedPoints.size());
+    for (const QPointF &point : displayedPoints) {
+        request.currentSeries.push_back({point.x(), point.y()});
+    }
+
+    // With a calibrated axis every pixel's value goes along, straight from the table
+    if (axisUnit != SpectralUnit::Pixel) {
+        const double* axisValues = calibration.table(axisUnit);
+        request.axisUnit = axisUnit;
+        request.axisValues.assign(axisValues, axisValues + SpectrumFrame::PixelCount);
     }
 
-    // Write recorded frames
-    if (!allFramesData.isEmpty()) {
+    if (!recordedFrames.isEmpty()) {
         if (saveAllFrames) {
-            out << "\nAll Recorded Frames:\n";
-            out << "Frame" << separator << "Pixel" << separator << "Intensity\n";
-            for (int frameIndex = 0; frameIndex < allFramesData.size(); ++frameIndex) {
-                const auto& frame = allFramesData[frameIndex];
-                for (const QPointF& point : frame) {
-                    out << frameIndex << separator << point.x() << separator << point.y() << "\n";
-                }
-            }
+            request.frames = &recordedFrames;
+            request.frameCount = recordedFrames.size();
         } else {
-            out << "\nLast Recorded Frame:\n";
-            out << "Pixel" << separator << "Intensity\n";
-            const auto& lastFrame = allFramesData.last();
-            for (const QPointF& point : lastFrame) {
-                out << point.x() << separator << point.y() << "\n";
-            }
+            request.hasLastFrame = true;
+            request.lastFrame = recordedFrames.last();
         }
     }
+    return request;
 }
 
-void MainWindow::saveAsJSON(QTextStream& out, bool saveAllFrames) {
-    QJsonObject rootObject;
-    // Add statistics
-    Statistics stats = calculateStatistics(series->points());
-    QJsonObject statsObject;
-    statsObject["mean"] = stats.mean;
-    statsObject["median"] = stats.median;
-    statsObject["variance"] = stats.variance;
-    statsObject["standardDeviation"] = stats.stdDev;
-    rootObject["statistics"] = statsObject;
-    // Save current series data
-    QJsonArray currentSeriesArray;
-    for (const QPointF &point : series->points()) {
-        QJsonObject pointObject;
-        pointObject["pixel"] = point.x();
-        pointObject["intensity"] = point.y();
-        currentSeriesArray.append(pointObject);
-    }
-    rootObject["currentSeriesData"] = currentSeriesArray;
-
-    // Save recorded frames
-    if (!allFramesData.isEmpty()) {
-        if (saveAllFrames) {
-            QJsonArray allFramesArray;
-            for (const auto & frame : allFramesData) {
-                QJsonArray frameArray;
-                for (const QPointF& point : frame) {
-                    QJsonObject pointObject;
-                    pointObject["pixel"] = point.x();
-                    pointObject["intensity"] = point.y();
-                    frameArray.append(pointObject);
-                }
-                allFramesArray.append(frameArray);
-            }
-            rootObject["allRecordedFrames"] = allFramesArray;
-        } else {
-            QJsonArray lastFrameArray;
-            const auto& lastFrame = allFramesData.last();
-            for (const QPointF& point : lastFrame) {
-                QJsonObject pointObject;
-                pointObject["pixel"] = point.x();
-                pointObject["intensity"] = point.y();
-                lastFrameArray.append(pointObject);
-            }
-            rootObject["lastRecordedFrame"] = lastFrameArray;
-        }
+void MainWindow::startExport(const QString& fileName, ExportRequest request) {
+    try {
+        exportJob.start(std::filesystem::path(fileName.toStdWString()), std::move(request));
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot export: %1").arg(e.what()));
+        return;
     }
+    exportFileName = fileName;
+
+    // Acquisition would clear the frames being written, and a second
+    // export would have to wait for this one
+    saveDataButton->setEnabled(false);
+    startButton->setEnabled(false);
 
-    QJsonDocument doc(rootObject);
-    out << doc.toJson();
+    exportProgressDialog = new QProgressDialog(tr("Exporting %1...").arg(QFileInfo(fileName).fileName()),
+                                               tr("Cancel"), 0, 1000, this);
+    exportProgressDialog->setAttribute(Qt::WA_DeleteOnClose);
+    exportProgressDialog->setWindowModality(Qt::NonModal);
+    exportProgressDialog->setAutoClose(false);
+    exportProgressDialog->setAutoReset(false);
+    exportProgressDialog->setMinimumDuration(0);
+    connect(exportProgressDialog, &QProgressDialog::canceled, this, [this]() { exportJob.cancel(); });
+    exportProgressDialog->show();
+    exportTimer->start();
 }
 
+void MainWindow::onExportTimer() {
+    const double megabytes = exportJob.bytesWritten() / 1e6;
+    if (exportJob.isRunning()) {
+        exportProgressDialog->setValue(static_cast<int>(exportJob.progress() * 1000));
+        exportProgressDialog->setLabelText(tr("Exporting %1...\n%2 MB at %3 MB/s")
+                                               .arg(QFileInfo(exportFileName).fileName())
+                                               .arg(megabytes, 0, 'f', 1)
+                                               .arg(exportJob.megabytesPerSecond(), 0, 'f', 1));
+        return;
+    }
+
+    exportTimer->stop();
+    const bool saved = exportJob.wait();
+    exportProgressDialog->close();
+    exportProgressDialog = nullptr;
+    saveDataButton->setEnabled(true);
+    startButton->setEnabled(!acquisitionWorker->isRunning());
+
+    qDebug() << "Export of" << exportFileName << "finished:" << megabytes << "MB in" << exportJob.elapsedSeconds()
+             << "s," << exportJob.megabytesPerSecond() << "MB/s";
+    if (saved) {
+        updateStatusBar(tr("Saved %1: %2 MB at %3 MB/s").arg(QFileInfo(exportFileName).fileName())
+                            .arg(megabytes, 0, 'f', 1).arg(exportJob.megabytesPerSecond(), 0, 'f', 1), 10000);
+        QMessageBox::information(this, tr("Success"), tr("Data saved successfully."));
+    } else if (exportJob.wasCancelled()) {
+        updateStatusBar(tr("Export cancelled"));
+    } else {
+        QMessageBox::warning(this, tr("Error"),
+                             tr("Export failed: %1").arg(QString::fromStdString(exportJob.errorMessage())));
+    }
+}
 
 void MainWindow::onSetBackgroundClicked() {
-    if (ftHandle == nullptr || fthandle_uart == nullptr) {
+    if (!device->isOpen()) {
         QMessageBox::critical(this, "Device Error", "Devices are not properly initialized. Please check the connection.");
         return;
     }
-    // Assuming 'series' is your QLineSeries with the current signal data
-    backgroundData = series->points(); // Copy the current points to the background buffer
-    if (backgroundData.size() > 1044) {
-        backgroundData.resize(1044);
+    // Copy the current signal into a flat per-pixel array; the series only
+    // holds the selected range, so it is indexed by x rather than position
+    backgroundLevels.assign(SpectrumFrame::PixelCount, 0.0f);
+    for (const QPointF& point : displayedPoints) {
+        const int pixel = qRound(point.x());
+        if (pixel >= 0 && pixel < SpectrumFrame::PixelCount) {
+            backgroundLevels[pixel] = static_cast<float>(point.y());
+        }
+    }
+
+    backgroundSamples.resize(backgroundLevels.size());
+    for (std::size_t pixel = 0; pixel < backgroundLevels.size(); ++pixel) {
+        backgroundSamples[pixel] = static_cast<uint16_t>(qBound(0.0f, backgroundLevels[pixel] + 0.5f, 65535.0f));
     }
 }
 
 void MainWindow::onToggleSubtractedValuesView() {
-    if (ftHandle == nullptr || fthandle_uart == nullptr) {
+    if (!device->isOpen()) {
         QMessageBox::critical(this, "Device Error", "Devices are not properly initialized. Please check the connection.");
         return;
     }
     // This flag tracks whether the subtracted values are currently being shown
     showSubtracted = !showSubtracted;
 
-    // Update the plot with the new state
-    updatePlot();
+    // Redraw with the new state
+    requestRender();
 }
 
 
@@ -1504,7 +2239,7 @@ void MainWindow::logError(const QString &message) {
 }
 
 void MainWindow::startRecording() {
-    allFramesData.clear();
+    recordedFrames.clear();
     isRecording = true;
     qDebug() << "Started recording frames";
 }
@@ -1515,49 +2250,203 @@ void MainWindow::stopRecording() {
     saveAllFrames();
 }
 
-void MainWindow::saveAllFrames() {
-    QString fileName = QFileDialog::getSaveFileName(this, tr("Save All Frames"),
-                                                    QDir::homePath(), tr("CSV Files (*.csv)"));
+void MainWindow::onRecordToFileToggled(bool checked) {
+    if (!checked) {
+        recordingFilePath.clear();
+        recordToFileButton->setText(tr("Record to File"));
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Record to File"),
+                                                    QDir::homePath(), tr("LaserSpectraVue Recordings (*.lsvrec)"));
+    if (fileName.isEmpty()) {
+        QSignalBlocker blocker(recordToFileButton);
+        recordToFileButton->setChecked(false);
+        return;
+    }
+    if (!fileName.endsWith(".lsvrec", Qt::CaseInsensitive)) {
+        fileName += ".lsvrec";
+    }
+
+    recordingFilePath = fileName;
+    recordToFileButton->setText(tr("Recording to %1").arg(QFileInfo(fileName).fileName()));
+    updateStatusBar(tr("The next acquisition will be recorded to %1").arg(fileName));
+}
+
+void MainWindow::onOpenRecordingClicked() {
+    if (acquisitionWorker->isRunning()) {
+        QMessageBox::information(this, "Playback", "Stop the data acquisition before opening a recording.");
+        return;
+    }
+
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Open Recording"),
+                                                          QDir::homePath(), tr("LaserSpectraVue Recordings (*.lsvrec)"));
     if (fileName.isEmpty()) return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, tr("Error"), tr("Cannot open file for writing."));
+    pausePlayback();
+    const quint64 opened = ++openedRecordings;
+    try {
+        recordingReader.open(std::filesystem::path(fileName.toStdWString()));
+    } catch (const std::exception& e) {
+        qDebug() << "Failed to open recording:" << e.what();
+        playback.setReader(nullptr);
+        playPauseButton->setEnabled(false);
+        playbackSlider->setEnabled(false);
+        playbackPositionLabel->setText("No recording");
+        QMessageBox::critical(this, "Error", QString("Failed to open recording: %1").arg(e.what()));
         return;
     }
 
-    QTextStream out(&file);
+    const quint64 frameCount = recordingReader.frameCount();
+    playback.setReader(&recordingReader);
+    playback.setSpeed(playbackSpeedComboBox->currentData().toDouble());
+    frameAverager.clear();
+    waterfallImage.clear();
 
-    out << "Frame,Pixel,Intensity\n";
+    {
+        QSignalBlocker blocker(playbackSlider);
+        playbackSlider->setRange(0, frameCount > 0 ? static_cast<int>(frameCount - 1) : 0);
+    }
+    playPauseButton->setEnabled(frameCount > 0);
+    playbackSlider->setEnabled(frameCount > 0);
 
-    for (int frameIndex = 0; frameIndex < allFramesData.size(); ++frameIndex) {
-        const auto& frame = allFramesData[frameIndex];
-        for (const QPointF& point : frame) {
-            out << frameIndex << "," << point.x() << "," << point.y() << "\n";
-        }
+    if (frameCount > 0) {
+        showPlaybackFrame();
+    } else {
+        playbackPositionLabel->setText("Empty recording");
     }
 
-    file.close();
+    const QString name = QFileInfo(fileName).fileName();
+    const bool complete = recordingReader.isComplete();
+    if (complete) {
+        updateStatusBar(tr("Opened %1: %2 frames").arg(name).arg(frameCount), 10000);
+    } else {
+        updateStatusBar(tr("Opened %1: recovered %2 frames from an unfinished recording").arg(name).arg(frameCount), 10000);
+    }
+
+    // Sequence numbers tell whether anything was lost while recording. They
+    // are spread over every index block, so they are read off the GUI thread
+    // and the status bar catches up when they are in.
+    recordingReader.scanTimingStats([this, opened, name, frameCount, complete](const FrameTimingStats& timing) {
+        QMetaObject::invokeMethod(this, [this, opened, name, frameCount, complete, timing]() {
+            if (opened != openedRecordings) return;
+
+            const QString losses = timing.isLossless()
+                ? tr("lossless")
+                : tr("%1 frames missing in %2 gaps").arg(timing.missingFrames).arg(timing.gaps);
+            if (complete) {
+                updateStatusBar(tr("Opened %1: %2 frames at %3 frames/s, %4").arg(name)
+                                    .arg(frameCount).arg(timing.frameRate(), 0, 'f', 1).arg(losses), 10000);
+            } else {
+                updateStatusBar(tr("Opened %1: recovered %2 frames from an unfinished recording, %3")
+                                    .arg(name).arg(frameCount).arg(losses), 10000);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
 
-    QMessageBox::information(this, tr("Success"), tr("All frames saved successfully."));
+void MainWindow::onPlayPauseClicked() {
+    if (playback.isPlaying()) {
+        pausePlayback();
+        return;
+    }
+
+    playback.play();
+    if (!playback.isPlaying()) return;
+
+    // play() rewinds when the last frame is showing
+    showPlaybackFrame();
+    playPauseButton->setText("Pause");
+    playbackClock.start();
+    playbackTimer->start();
+}
+
+void MainWindow::pausePlayback() {
+    playback.pause();
+    playbackTimer->stop();
+    playPauseButton->setText("Play");
 }
 
+void MainWindow::onPlaybackTimer() {
+    // Advance by the real time since the last tick, so a late tick skips
+    // frames instead of slowing playback down
+    const qint64 elapsedNs = playbackClock.nsecsElapsed();
+    playbackClock.restart();
 
-void MainWindow::onSetRangeClicked() {
-    int newMinRange = minRangeSpinBox->value();
-    int newMaxRange = maxRangeSpinBox->value();
+    if (playback.advance(elapsedNs)) {
+        showPlaybackFrame();
+    }
+    if (!playback.isPlaying()) {
+        pausePlayback();
+    }
+}
+
+void MainWindow::onPlaybackSliderMoved(int frame) {
+    if (!recordingReader.isOpen() || static_cast<quint64>(frame) == playback.position()) return;
+
+    playback.seek(static_cast<quint64>(frame));
+    showPlaybackFrame();
+}
+
+void MainWindow::onPlaybackSpeedChanged(int index) {
+    playback.setSpeed(playbackSpeedComboBox->itemData(index).toDouble());
+}
+
+void MainWindow::showPlaybackFrame() {
+    const quint64 position = playback.position();
+    recordingReader.readFrame(position, playbackFrame);
+
+    ingestFrame(playbackFrame);
+    presentFrame(playbackFrame);
+
+    {
+        QSignalBlocker blocker(playbackSlider);
+        playbackSlider->setValue(static_cast<int>(position));
+    }
+    const double seconds = (playbackFrame.timestampNs - recordingReader.timestampAt(0)) / 1e9;
+    playbackPositionLabel->setText(QString("Frame %1 / %2  %3 s  %4 μs")
+                                       .arg(position + 1)
+                                       .arg(recordingReader.frameCount())
+                                       .arg(seconds, 0, 'f', 2)
+                                       .arg(playbackFrame.exposureTime));
+}
+
+void MainWindow::saveAllFrames() {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save All Frames"),
+                                                    QDir::homePath(), tr("CSV Files (*.csv)"));
+    if (fileName.isEmpty()) return;
+
+    ExportRequest request;
+    request.includeSummary = false;
+    request.frames = &recordedFrames;
+    request.frameCount = recordedFrames.size();
+    startExport(fileName, std::move(request));
+}
 
-    if (newMinRange >= newMaxRange) {
+
+void MainWindow::onSetRangeClicked() {
+    if (minRangeSpinBox->value() >= maxRangeSpinBox->value()) {
         QMessageBox::warning(this, "Invalid Range", "Min range must be less than max range.");
         return;
     }
 
-    currentMinRange = newMinRange;
-    currentMaxRange = newMaxRange;
+    // The boxes are in the axis unit; a binary search of the calibration
+    // table finds the pixels, widened to whole pixels covering the range
+    const double first = calibration.pixelAt(minRangeSpinBox->value(), axisUnit);
+    const double second = calibration.pixelAt(maxRangeSpinBox->value(), axisUnit);
+    currentMinRange = static_cast<int>(std::floor(std::min(first, second)));
+    currentMaxRange = std::max(currentMinRange + 1, static_cast<int>(std::ceil(std::max(first, second))));
 
     // Update the chart's x-axis range
     if (auto axisX = dynamic_cast<QValueAxis*>(chart->axes(Qt::Horizontal).first())) {
-        axisX->setRange(currentMinRange, currentMaxRange);
+        const double axisFirst = toAxisX(currentMinRange);
+        const double axisLast = toAxisX(currentMaxRange);
+        axisX->setRange(std::min(axisFirst, axisLast), std::max(axisFirst, axisLast));
+    }
+    spectrumPlot->setXRange(currentMinRange, currentMaxRange);
+    waterfallView->setXRange(currentMinRange, currentMaxRange);
+    if (deviceSpectraView) {
+        deviceSpectraView->setXRange(currentMinRange, currentMaxRange);
     }
 
     // Update all series with the new range
@@ -1578,7 +2467,7 @@ void MainWindow::updateSaturationIndicator(bool isSaturating) const {
 }
 
 void MainWindow::onStoreTraceClicked() {
-    if (series->points().isEmpty()) {
+    if (displayedPoints.isEmpty()) {
         QMessageBox::warning(this, "Warning", "No data to store.");
         return;
     }
@@ -1590,17 +2479,12 @@ void MainWindow::onStoreTraceClicked() {
     }
 
     // Create a new series with only the points within the current range
-    QVector<QPointF> rangeFilteredPoints;
-    for (const auto& point : series->points()) {
-        if (point.x() >= currentMinRange && point.x() <= currentMaxRange) {
-            rangeFilteredPoints.append(point);
-        }
-    }
+    const QVector<QPointF> rangeFilteredPoints = filterPointsByRange(displayedPoints);
 
     storedTraces.append(rangeFilteredPoints);
 
     auto newSeries = QSharedPointer<QLineSeries>::create();
-    newSeries->replace(rangeFilteredPoints);
+    newSeries->replace(toAxisX(rangeFilteredPoints));
 
     // Set a different color for each stored trace
     int hue = (static_cast<int>(storedTraces.size()) * 60) % 360;  // Use 60 degree intervals, wrap around at 360
@@ -1613,34 +2497,23 @@ void MainWindow::onStoreTraceClicked() {
     newSeries->attachAxis(chart->axes(Qt::Vertical).first());
 
     storedSeries.append(newSeries);
+    spectrumPlot->setStoredTraces(storedTraces);
 
     // Update the chart
     chart->update();
 }
 
 void MainWindow::updateAllSeriesWithNewRange() {
-    // Update main series
-    QVector<QPointF> filteredPoints;
-    for (const auto& point : series->points()) {
-        if (point.x() >= currentMinRange && point.x() <= currentMaxRange) {
-            filteredPoints.append(point);
-        }
-    }
-    series->replace(filteredPoints);
-
     // Update stored traces
     for (int i = 0; i < storedTraces.size(); ++i) {
-        QVector<QPointF> filteredStoredPoints;
-        for (const auto& point : storedTraces[i]) {
-            if (point.x() >= currentMinRange && point.x() <= currentMaxRange) {
-                filteredStoredPoints.append(point);
-            }
-        }
-        storedSeries[i]->replace(filteredStoredPoints);
+        storedSeries[i]->replace(toAxisX(filterPointsByRange(storedTraces[i])));
     }
 
-    // Update peak indicator
-    updatePlotWithPoints(filteredPoints);
+    // Update main series and peak indicator, which filter the points themselves
+    updatePlotWithPoints(displayedPoints);
+
+    // Redraw the newest frame in full, including pixels a narrower range dropped
+    requestRender();
 }
 
 void MainWindow::saveChartImage() {
@@ -1665,8 +2538,9 @@ void MainWindow::saveChartImage() {
         }
     }
 
-    // Capture the entire window
-    QPixmap pixmap = chartView->grab();
+    // Capture whichever plot is showing
+    QWidget* plotView = useRasterPlot ? static_cast<QWidget*>(spectrumPlot) : chartView;
+    QPixmap pixmap = plotView->grab();
 
     bool success = false;
 
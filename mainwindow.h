@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QtCharts>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QTabWidget>
@@ -11,16 +12,40 @@
 #include <QLabel>
 #include <QPointF>
 #include <QGraphicsPixmapItem>
+#include <QScreen>
 #include <QList>
-#include "ftd2xx.h"
+#include "acquisitionworker.h"
+#include "autorange.h"
+#include "dataexport.h"
+#include "devicespectraview.h"
+#include "diagnosticspanel.h"
+#include "devicecommandqueue.h"
+#include "frameaverager.h"
+#include "framerecorder.h"
+#include "framestore.h"
+#include "peakdetection.h"
+#include "pipelinetelemetry.h"
+#include "recordingplayback.h"
+#include "recordingreader.h"
+#include "spectrumcorrection.h"
+#include "spectrumplotwidget.h"
+#include "spectrumstatistics.h"
+#include "spectrometerdevice.h"
+#include "spectrometerpipeline.h"
+#include "tracedecimation.h"
+#include "waterfallwidget.h"
+#include "wavelengthcalibration.h"
 #include <memory>
+#include <vector>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QTextStream>
 #include <QSpinBox>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonDocument>
+#include <QDoubleSpinBox>
+#include <QSlider>
+#include <QComboBox>
+#include <QTableWidget>
+#include <QProgressDialog>
 #include <QSvgGenerator>
 #include <QPainter>
 
@@ -29,7 +54,8 @@ class MainWindow final : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    // Takes at least one spectrometer; the first drives the main plot
+    explicit MainWindow(std::vector<std::unique_ptr<SpectrometerDevice>> spectrometers, QWidget *parent = nullptr);
     ~MainWindow() override;
 
 private slots:
@@ -44,6 +70,27 @@ private slots:
     void onSetRangeClicked();
     void onToggleAverageView();  // Added this line
     void onStoreTraceClicked();
+    void onRecordToFileToggled(bool checked);
+    void onOpenRecordingClicked();
+    void onPlayPauseClicked();
+    void onPlaybackTimer();
+    void onPlaybackSliderMoved(int frame);
+    void onPlaybackSpeedChanged(int index);
+    void onAverageModeChanged(int index);
+    void onAverageWindowChanged(int window);
+    void onPlotRendererChanged(int index);
+    void onWaterfallToggled(bool checked);
+    void onWaterfallDepthChanged(int depth);
+    void onOverloadPolicyChanged(int index);
+    void onLatencyBudgetChanged(int milliseconds);
+    void onExportTimer();
+    void onTelemetryTimer();
+    void onSaveDiagnosticsClicked();
+    void onPeakProminenceChanged(int prominence);
+    void onPeakCentreChanged(int index);
+    void onPeakTableToggled(bool checked);
+    void onAxisUnitChanged(int index);
+    void onCalibrationClicked();
 
 private:
 
@@ -56,12 +103,10 @@ private:
 
     // Add this new private slot
     void onToggleYRangeClicked();
-    static int findFrameStart(const QByteArray& data);
     void saveChartImage();
     void updateAllSeriesWithNewRange();
-    void saveAsCSVorTXT(QTextStream& out, bool saveAllFrames, const QString& extension);
-    void saveAsJSON(QTextStream& out, bool saveAllFrames);
-    QByteArray dataBuffer;
+    ExportRequest exportRequest(bool saveAllFrames, ExportFormat format) const;
+    void startExport(const QString& fileName, ExportRequest request);
     static constexpr int MAX_STORED_TRACES = 5;  // Maximum number of stored traces
     QVector<QVector<QPointF>> storedTraces;  // Container for stored traces
     QVector<QSharedPointer<QLineSeries>> storedSeries; // Series for stored traces
@@ -70,22 +115,135 @@ private:
     void updateSaturationIndicator(bool isSaturating) const;
     QPushButton *showAverageButton = nullptr;
     bool showingAverage = false;
-    QVector<QVector<QPointF>> lastTenFrames;
+    QComboBox *averageModeComboBox = nullptr;
+    QSpinBox *averageWindowSpinBox = nullptr;
+    FrameAverager frameAverager;  // Fed with every raw frame, shown when showingAverage
+    std::array<float, SpectrumFrame::PixelCount> averageValues{};
     void updateAveragePlot();
-    QVector<QPointF> processFrame(const QByteArray &frameData);
-    void updatePlotWithPoints(const QVector<QPointF>& points) const;  // Added this line
+    QVector<QPointF> processFrame(const SpectrumFrame &frame);
+    // Every frame is ingested: recorded in RAM, averaged and added to the
+    // waterfall. The overload policy picks the frames that are presented.
+    void ingestFrame(const SpectrumFrame &frame);
+    void presentFrame(const SpectrumFrame &frame);
+
+    // Presentation stage: only the newest presented frame is drawn, at most
+    // once per display refresh
+    void requestRender();
+    void renderDisplay();
+    SpectrumFrame newestFrame;
+    bool hasNewestFrame = false;
+    quint64 framesAwaitingRender = 0;  // Ingested since the last draw
+    bool saturatedSinceRender = false;
+    quint64 renderedFrames = 0;
+    quint64 skippedDisplayFrames = 0;  // Frames replaced by a newer one before they were drawn,
+                                       // including those the overload policy did not present
+    QTimer *renderTimer = nullptr;
+    QElapsedTimer renderClock;
+    int renderIntervalMs = 16;
+
+    // The live trace is drawn either by SpectrumPlotWidget or by QtCharts
+    SpectrumPlotWidget *spectrumPlot = nullptr;
+    QComboBox *plotRendererComboBox = nullptr;
+    QLabel *drawTimeLabel = nullptr;
+    QLabel *frameRateLabel = nullptr;
+    QElapsedTimer drawTimeLabelClock;
+    bool useRasterPlot = true;
+    AutoRange autoYRange;
+    QVector<QPointF> displayedPoints;  // Newest trace within the range, as drawn
+    void updateDrawTimeLabel();
+    void updateFrameRateLabel();
+
+    // Every frame becomes one row of the waterfall; drawing follows the plot
+    WaterfallImage waterfallImage;
+    WaterfallWidget *waterfallView = nullptr;
+    QPushButton *waterfallButton = nullptr;
+    QSpinBox *waterfallDepthSpinBox = nullptr;
+    std::vector<uint16_t> backgroundSamples;  // backgroundLevels as sensor counts, for the waterfall
+
+    // Newest spectrum of every head, shown when there is more than one
+    DeviceSpectraView *deviceSpectraView = nullptr;
+    void updateDeviceSpectrum(std::size_t index);
+
+    // What the display gives up when frames arrive faster than it keeps up
+    QComboBox *overloadPolicyComboBox = nullptr;
+    QSpinBox *latencyBudgetSpinBox = nullptr;
+
+    // Exports run on their own thread; the GUI polls their progress
+    ExportJob exportJob;
+    QTimer *exportTimer = nullptr;
+    QProgressDialog *exportProgressDialog = nullptr;
+    QString exportFileName;
+    static constexpr int ExportPollIntervalMs = 100;
+
+    // Pipeline telemetry: a summary next to the status bar and the full
+    // report in the diagnostics panel, both refreshed by telemetryTimer
+    LatencyHistogram displayLatency;  // Frame read to frame drawn
+    TelemetrySnapshot previousTelemetry;
+    bool hasPreviousTelemetry = false;
+    QTimer *telemetryTimer = nullptr;
+    QLabel *telemetryLabel = nullptr;
+    QPushButton *diagnosticsButton = nullptr;
+    DiagnosticsPanel *diagnosticsPanel = nullptr;
+    static constexpr int TelemetryIntervalMs = 500;
+    TelemetrySnapshot telemetrySnapshot() const;
+    void updatePlotWithPoints(const QVector<QPointF>& points);  // Added this line
     QVector<QPointF> filterPointsByRange(const QVector<QPointF> &points) const;
 
-    void updateMainSeries(const QVector<QPointF> &filteredPoints) const;
+    void updateMainSeries(const QVector<QPointF> &filteredPoints);
 
-    void updatePeakIndicator(const QVector<QPointF> &filteredPoints) const;
+    void updatePeakIndicator(const SpectrumStatistics &stats) const;
 
-    void updateAxisRanges(const QVector<QPointF> &filteredPoints) const;
+    // Every peak above the prominence threshold in the displayed trace,
+    // shown as markers, in the peak table and as the FWHM readout
+    PeakDetectionSettings peakSettings;
+    std::vector<SpectrumPeak> detectedPeaks;
+    QSpinBox *peakProminenceSpinBox = nullptr;
+    QComboBox *peakCentreComboBox = nullptr;
+    QPushButton *peakTableButton = nullptr;
+    QTableWidget *peakTable = nullptr;
+    QElapsedTimer peakTableClock;
+    static constexpr int PeakTableIntervalMs = 250;
+    void updateDetectedPeaks();
+    void updatePeakTable();
 
-    void updateLabels(const QVector<QPointF> &filteredPoints) const;
+    // The first head's calibration from its device profile. Traces stay at
+    // pixel positions; the axes, range selection, peak readouts and exports
+    // convert through the calibration's per-pixel tables.
+    WavelengthCalibration calibration;
+    SpectralUnit axisUnit = SpectralUnit::Pixel;
+    QComboBox *axisUnitComboBox = nullptr;
+    QPushButton *calibrationButton = nullptr;
+    QString profileDirectory() const;
+    void loadDeviceProfile();
+    void setCalibration(const WavelengthCalibration& updated);
+    void updateAxisUnitChoices();
+    void applyAxisUnit();
+    double toAxisX(double pixel) const;
+    QVector<QPointF> toAxisX(const QVector<QPointF> &points) const;
+    double axisWidth(const SpectrumPeak& peak) const;  // FWHM in axisUnit
 
-    QVector<QVector<QPointF>> allFramesData;
+    void updateAxisRanges(const SpectrumStatistics &stats);
+
+    void updateLabels(const SpectrumStatistics &stats) const;
+
+    SpectrumStatistics statisticsOf(const QVector<QPointF> &points) const;
+    mutable std::vector<float> statisticsValues;  // Scratch for statisticsOf()
+
+    FrameStore recordedFrames;  // Raw sensor values, before background subtraction
     bool isRecording = false;
+    FrameRecorder* frameRecorder = nullptr;  // The first head's
+    QString recordingFilePath;  // Empty unless the next acquisition streams to disk
+
+    // Playback of .lsvrec recordings through the live display path
+    RecordingReader recordingReader;
+    quint64 openedRecordings = 0;  // Tells a finished timing scan whether its recording is still the open one
+    RecordingPlayback playback;
+    SpectrumFrame playbackFrame;
+    QTimer *playbackTimer = nullptr;
+    QElapsedTimer playbackClock;
+    static constexpr int PlaybackIntervalMs = 16;
+    void showPlaybackFrame();
+    void pausePlayback();
     void startRecording();
     void stopRecording();
     void saveAllFrames();
@@ -94,10 +252,12 @@ private:
     static void setupButton(QPushButton* button, const QString& iconPath, const QString& tooltip);
     QLabel* createStylishLabel(const QString& text);
     void connectSignalsAndSlots();
-    void setupTimer();
-    FT_HANDLE ftHandle = nullptr;
-    FT_HANDLE fthandle_uart = nullptr;
-    FT_STATUS ft_status{};
+    // One pipeline per spectrometer head, each with its own acquisition and
+    // command threads. The first feeds the main plot, the analysis and the
+    // telemetry; device, commandQueue, acquisitionWorker and frameRecorder
+    // point into it.
+    std::vector<std::unique_ptr<SpectrometerPipeline>> pipelines;
+    SpectrometerDevice* device = nullptr;
     QByteArray frameData;
     QLabel *peakValueLabel{};
     QLabel *peakPixelLabel{};
@@ -105,6 +265,7 @@ private:
     std::unique_ptr<QChart> chart;
     std::unique_ptr<QLineSeries> series;
     std::unique_ptr<QLineSeries> peakLineSeries;
+    std::unique_ptr<QScatterSeries> peakMarkerSeries;  // Detected peaks on the QtCharts renderer
     QLabel *amplitudeLabel{};
     QLabel *meanLabel{};
     QLabel *stdDevLabel{};
@@ -113,56 +274,61 @@ private:
     QLabel *varianceLabel{};
     QLabel *medianLabel{};
 
-    // Add the Statistics struct
-    struct Statistics {
-        double variance{0.0};
-        double stdDev{0.0};
-        double mean{0.0};
-        double median{0.0};
-    };
-
-    // Add the calculation function
-    Statistics calculateStatistics(const QVector<QPointF>& points) const;
-
     static constexpr int Buffer_Size = 2088;
     static constexpr int Display_Frame_Count = 1;
     static constexpr int expectedFrameSize = 2088;
     static constexpr int maxBufferSize = expectedFrameSize * 10;
     QQueue<QVector<QPointF>> frameBuffer;
-    DWORD readbyte{};
-    DWORD writebyte{};
     int currentFrame = 0;
 
-    QChartView *chartView = nullptr;
-    QTimer *timer = nullptr;
+    TimedChartView *chartView = nullptr;
+    AcquisitionWorker* acquisitionWorker = nullptr;
+    QElapsedTimer acquisitionClock;
 
     QPushButton *startButton = nullptr;
     QPushButton *stopButton = nullptr;
+    QPushButton *recordToFileButton = nullptr;
+    QPushButton *openRecordingButton = nullptr;
+    QPushButton *playPauseButton = nullptr;
+    QSlider *playbackSlider = nullptr;
+    QComboBox *playbackSpeedComboBox = nullptr;
+    QLabel *playbackPositionLabel = nullptr;
     QLineEdit *exposureTimeInput = nullptr;
     QPushButton *setExposureButton = nullptr;
     QPushButton *saveDataButton = nullptr;
     QPushButton *setBackgroundButton = nullptr;
     QPushButton *showSubtractedValuesButton = nullptr;
 
-    QSpinBox *minRangeSpinBox = nullptr;
-    QSpinBox *maxRangeSpinBox = nullptr;
+    QDoubleSpinBox *minRangeSpinBox = nullptr;  // In axisUnit
+    QDoubleSpinBox *maxRangeSpinBox = nullptr;
     QPushButton *setRangeButton = nullptr;
-    int currentMinRange = 0;
+    int currentMinRange = 0;  // Pixels, whatever the axis shows
     int currentMaxRange = 1023;
+    static constexpr int LastRangePixel = 1023;  // Upper end of the range boxes
 
     uint32_t defaultExposureTime = 10000;
     uint8_t buffer[2088]{};
-    QVector<QPointF> backgroundData;
+    std::vector<float> backgroundLevels;  // Per pixel; empty until a background is set
+    std::array<float, SpectrumFrame::PixelCount> correctedValues{};
     bool showSubtracted = false;
 
     void setupDevice();
-    void setupDeviceHelper(const char* description, FT_HANDLE* handle);
 
     void setupChart();
     void setupUI();
-    void trig_on() const;
-    void trig_off() const;
-    void set_exp(uint32_t exp) const;
+
+    // Device commands run on commandQueue's thread; `finished` is called back
+    // on the GUI thread, and failures without one are reported in a dialog.
+    // The overload taking a pipeline sends the command to that head instead.
+    void submitDeviceCommand(const DeviceCommand& command,
+                             std::function<void(const DeviceCommandResult&)> finished = {});
+    void submitDeviceCommand(SpectrometerPipeline& pipeline, const DeviceCommand& command,
+                             std::function<void(const DeviceCommandResult&)> finished = {});
+    void onDeviceCommandFinished(const DeviceCommandResult& result,
+                                 const std::function<void(const DeviceCommandResult&)>& finished);
+    DeviceCommandQueue* commandQueue = nullptr;
+    quint64 acquisitionRun = 0;  // Tells a late start-up failure from the current acquisition
+    static constexpr int TriggerSettleMs = 100;  // Between the exposure and the trigger at start
     static void logError(const QString &message);
     static void showDiagnosticMessage(const QString& message, const QString& type);
 
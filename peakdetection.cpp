@@ -0,0 +1,161 @@
+#include "peakdetection.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Measures the peak at `top` between its valleys; false when it is not
+// prominent enough. A maximum at the start of the range has no rise before
+// it and fails here.
+template <typename T>
+bool measurePeak(const T* values, std::size_t top, std::size_t leftValley, std::size_t rightValley, int firstPixel,
+                 const PeakDetectionSettings& settings, SpectrumPeak& peak) {
+    const double height = values[top];
+    const double leftLevel = values[leftValley];
+    const double rightLevel = values[rightValley];
+    const double prominence = height - std::max(leftLevel, rightLevel);
+    if (prominence < settings.minProminence || prominence <= 0.0) {
+        return false;
+    }
+
+    // Half-prominence crossings, interpolated between the samples either
+    // side; the higher valley lies below the level, so both walks end
+    // before their valley
+    const double halfLevel = height - prominence / 2.0;
+    std::size_t left = top;
+    while (left > leftValley && values[left - 1] > halfLevel) {
+        --left;
+    }
+    double leftHalf = static_cast<double>(left);
+    if (left > leftValley) {
+        const double below = values[left - 1];
+        leftHalf -= (values[left] - halfLevel) / (values[left] - below);
+    }
+    std::size_t right = top;
+    while (right < rightValley && values[right + 1] > halfLevel) {
+        ++right;
+    }
+    double rightHalf = static_cast<double>(right);
+    if (right < rightValley) {
+        const double below = values[right + 1];
+        rightHalf += (values[right] - halfLevel) / (values[right] - below);
+    }
+
+    double centre = static_cast<double>(top);
+    if (settings.centre == PeakCentre::Centroid) {
+        double weight = 0.0;
+        double moment = 0.0;
+        for (std::size_t i = left; i <= right; ++i) {
+            const double above = values[i] - halfLevel;
+            weight += above;
+            moment += above * static_cast<double>(i);
+        }
+        if (weight > 0.0) {
+            centre = moment / weight;
+        }
+    } else {
+        // top is a strict maximum over its valleys, so both neighbours exist
+        const double before = values[top - 1];
+        const double after = values[top + 1];
+        const double curvature = before - 2.0 * height + after;
+        if (curvature < 0.0) {
+            centre += std::clamp(0.5 * (before - after) / curvature, -0.5, 0.5);
+        }
+    }
+
+    // Area above the straight line between the valleys
+    double area = 0.0;
+    const double slope = (rightLevel - leftLevel) / static_cast<double>(rightValley - leftValley);
+    for (std::size_t i = leftValley + 1; i < rightValley; ++i) {
+        const double baseline = leftLevel + slope * static_cast<double>(i - leftValley);
+        area += std::max(0.0, values[i] - baseline);
+    }
+
+    peak.pixel = firstPixel + static_cast<int>(top);
+    peak.centre = firstPixel + centre;
+    peak.height = height;
+    peak.prominence = prominence;
+    peak.leftHalf = firstPixel + leftHalf;
+    peak.rightHalf = firstPixel + rightHalf;
+    peak.fwhm = rightHalf - leftHalf;
+    peak.area = area;
+    return true;
+}
+
+template <typename T>
+void findPeaks(const T* values, std::size_t count, int firstPixel, const PeakDetectionSettings& settings,
+               std::vector<SpectrumPeak>& peaks) {
+    peaks.clear();
+    if (count < 3) {
+        return;
+    }
+
+    // A maximum is confirmed once the signal has dropped minProminence below
+    // it, a valley once it has risen minProminence above it. Each confirmed
+    // valley closes the peak before it, whose measurement only looks between
+    // the two valleys around it.
+    const double delta = std::max(settings.minProminence, 0.0);
+    bool lookingForMaximum = true;
+    std::size_t maximum = 0;
+    std::size_t lowest = 0;      // Lowest sample since the last valley
+    std::size_t leftValley = 0;  // Lowest sample before the current maximum
+    std::size_t top = 0;
+    std::size_t minimum = 0;
+    SpectrumPeak peak;
+
+    for (std::size_t i = 1; i < count; ++i) {
+        const double value = values[i];
+        if (lookingForMaximum) {
+            if (value < values[lowest]) {
+                lowest = i;
+            }
+            if (value > values[maximum]) {
+                maximum = i;
+                leftValley = lowest;
+            }
+            if (value < values[maximum] - delta) {
+                top = maximum;
+                minimum = i;
+                lookingForMaximum = false;
+            }
+        } else {
+            if (value < values[minimum]) {
+                minimum = i;
+            }
+            if (value > values[minimum] + delta) {
+                if (measurePeak(values, top, leftValley, minimum, firstPixel, settings, peak)) {
+                    peaks.push_back(peak);
+                }
+                leftValley = minimum;
+                lowest = minimum;
+                maximum = i;
+                lookingForMaximum = true;
+            }
+        }
+    }
+
+    // The last peak closes on the lowest sample after it
+    if (!lookingForMaximum && measurePeak(values, top, leftValley, minimum, firstPixel, settings, peak)) {
+        peaks.push_back(peak);
+    }
+
+    if (peaks.size() > settings.maxPeaks) {
+        std::nth_element(peaks.begin(), peaks.begin() + static_cast<std::ptrdiff_t>(settings.maxPeaks), peaks.end(),
+                         [](const SpectrumPeak& a, const SpectrumPeak& b) { return a.prominence > b.prominence; });
+        peaks.resize(settings.maxPeaks);
+        std::sort(peaks.begin(), peaks.end(),
+                  [](const SpectrumPeak& a, const SpectrumPeak& b) { return a.pixel < b.pixel; });
+    }
+}
+
+} // namespace
+
+void detectPeaks(const float* values, std::size_t count, int firstPixel, const PeakDetectionSettings& settings,
+                 std::vector<SpectrumPeak>& peaks) {
+    findPeaks(values, count, firstPixel, settings, peaks);
+}
+
+void detectPeaks(const uint16_t* samples, std::size_t count, int firstPixel, const PeakDetectionSettings& settings,
+                 std::vector<SpectrumPeak>& peaks) {
+    findPeaks(samples, count, firstPixel, settings, peaks);
+}
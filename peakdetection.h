@@ -0,0 +1,45 @@
+#ifndef PEAKDETECTION_H
+#define PEAKDETECTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One peak of a spectrum. Positions are in pixels and may be fractional.
+struct SpectrumPeak {
+    int pixel = 0;            // Sample at the top
+    double centre = 0.0;      // Sub-pixel centre
+    double height = 0.0;      // Value at the top
+    double prominence = 0.0;  // Height above the higher of its two valleys
+    double leftHalf = 0.0;    // Where the peak crosses half its prominence
+    double rightHalf = 0.0;
+    double fwhm = 0.0;        // rightHalf - leftHalf
+    double area = 0.0;        // Above the line joining the two valleys, counts x pixels
+};
+
+enum class PeakCentre {
+    Parabolic,  // Vertex of the parabola through the top sample and its neighbours
+    Centroid    // Intensity-weighted mean of the samples above half prominence
+};
+
+struct PeakDetectionSettings {
+    double minProminence = 500.0;  // Counts; also the drop that separates two peaks
+    PeakCentre centre = PeakCentre::Parabolic;
+    std::size_t maxPeaks = 64;     // The most prominent are kept when more are found
+};
+
+// Finds the peaks of a spectrum in one forward pass: the signal has to rise
+// and fall by minProminence around a maximum for it to count, so noise
+// smaller than that never splits a peak. Width, centre and area are measured
+// between each peak's two valleys, which neighbouring peaks share, so the
+// whole search stays linear in the number of samples. Maxima at either end
+// of the range are not peaks. values[0] belongs to pixel firstPixel; peaks
+// are returned in pixel order.
+void detectPeaks(const float* values, std::size_t count, int firstPixel, const PeakDetectionSettings& settings,
+                 std::vector<SpectrumPeak>& peaks);
+
+// Same for raw samples
+void detectPeaks(const uint16_t* samples, std::size_t count, int firstPixel, const PeakDetectionSettings& settings,
+                 std::vector<SpectrumPeak>& peaks);
+
+#endif // PEAKDETECTION_H
@@ -0,0 +1,248 @@
+#include "pipelinetelemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "acquisitionworker.h"
+#include "devicecommandqueue.h"
+#include "framerecorder.h"
+
+namespace {
+
+template <typename... Arguments>
+void appendFormatted(std::string& text, const char* format, Arguments... arguments) {
+    char line[256];
+    std::snprintf(line, sizeof(line), format, arguments...);
+    text += line;
+}
+
+unsigned long long asPrintable(uint64_t value) {
+    return static_cast<unsigned long long>(value);
+}
+
+} // namespace
+
+int LatencyHistogram::bucketFor(int64_t durationNs) {
+    // In quarter microseconds, so even the first octave has a bit for each quarter
+    const auto quarters = static_cast<uint64_t>(durationNs > 0 ? durationNs / 250 : 0);
+    if (quarters < SubBuckets) {
+        return 0;
+    }
+
+    int leadingBit = 2;
+    while ((quarters >> (leadingBit + 1)) != 0) {
+        ++leadingBit;
+    }
+    const int octave = leadingBit - 2;
+    if (octave >= Octaves) {
+        return BucketCount - 1;
+    }
+
+    // The two bits below the leading one pick the quarter of the octave
+    const auto quarter = static_cast<int>((quarters >> (leadingBit - 2)) & 3);
+    return 1 + octave * SubBuckets + quarter;
+}
+
+double LatencyHistogram::bucketLowerMicroseconds(int bucket) {
+    if (bucket <= 0) {
+        return 0.0;
+    }
+    if (bucket >= BucketCount - 1) {
+        return std::ldexp(1.0, Octaves);
+    }
+    const int octave = (bucket - 1) / SubBuckets;
+    const int quarter = (bucket - 1) % SubBuckets;
+    return std::ldexp(1.0 + quarter / static_cast<double>(SubBuckets), octave);
+}
+
+double LatencyHistogram::bucketUpperMicroseconds(int bucket) {
+    if (bucket <= 0) {
+        return 1.0;
+    }
+    if (bucket >= BucketCount - 1) {
+        return HUGE_VAL;
+    }
+    return bucketLowerMicroseconds(bucket + 1);
+}
+
+void LatencyHistogram::record(int64_t durationNs) {
+    counts[bucketFor(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+
+    int64_t largest = maxNs.load(std::memory_order_relaxed);
+    while (durationNs > largest && !maxNs.compare_exchange_weak(largest, durationNs, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    samples.store(0, std::memory_order_relaxed);
+    totalNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    // Not one atomic read, but every field is at most a sample or two behind
+    Snapshot result;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        result.counts[bucket] = counts[bucket].load(std::memory_order_relaxed);
+        result.samples += result.counts[bucket];
+    }
+    result.totalNs = totalNs.load(std::memory_order_relaxed);
+    result.maxNs = maxNs.load(std::memory_order_relaxed);
+    return result;
+}
+
+double LatencyHistogram::Snapshot::percentileMicroseconds(double fraction) const {
+    if (samples == 0) {
+        return 0.0;
+    }
+    const auto target = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(samples)));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= target && counts[bucket] > 0) {
+            return std::min(bucketUpperMicroseconds(bucket), maxMicroseconds());
+        }
+    }
+    return maxMicroseconds();
+}
+
+TelemetrySnapshot collectTelemetry(const AcquisitionWorker& worker, const FrameRecorder* recorder,
+                                   const DeviceCommandQueue* commands) {
+    TelemetrySnapshot snapshot;
+    snapshot.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    const FrameSynchronizer& sync = worker.frameSync();
+    snapshot.bytesRead = worker.bytesRead();
+    snapshot.framesParsed = worker.parsedFrames();
+    snapshot.framesLost = worker.lostFrames();
+    snapshot.framesDropped = worker.droppedFrames();
+    snapshot.framesShed = worker.shedFrames();
+    snapshot.framesBacklogged = worker.backlogFrames();
+    snapshot.overloadPolicy = AcquisitionWorker::overloadPolicyName(worker.overloadPolicy());
+    if (worker.overloadPolicy() == AcquisitionWorker::OverloadPolicy::BoundedLatency) {
+        snapshot.latencyBudgetMs = worker.latencyBudgetMs();
+    }
+    snapshot.resyncs = sync.resyncs();
+    snapshot.bytesDiscarded = sync.bytesDiscarded();
+    snapshot.framesRejected = sync.framesRejected();
+    snapshot.displayQueueDepth = worker.queueDepth();
+    snapshot.displayQueueCapacity = worker.queueCapacity();
+
+    if (recorder != nullptr) {
+        snapshot.recording = recorder->isOpen();
+        snapshot.framesRecorded = recorder->framesWritten();
+        snapshot.recorderDropped = recorder->framesDropped();
+        snapshot.bytesRecorded = recorder->bytesWritten();
+        snapshot.recorderQueueDepth = recorder->queueDepth();
+        snapshot.recorderQueueCapacity = recorder->queueCapacity();
+    }
+
+    if (commands != nullptr) {
+        snapshot.commandsCompleted = commands->commandsCompleted();
+        snapshot.commandsFailed = commands->commandsFailed();
+        snapshot.commandRetries = commands->retries();
+        snapshot.commandRoundTripMs = commands->meanRoundTripMs();
+    }
+    return snapshot;
+}
+
+std::string formatTelemetryReport(const TelemetrySnapshot& current, const TelemetrySnapshot* previous) {
+    std::string report;
+    const double seconds = previous != nullptr ? (current.timeNs - previous->timeNs) / 1e9 : 0.0;
+    const auto rate = [&](uint64_t now, uint64_t before) {
+        return seconds > 0.0 && now >= before ? static_cast<double>(now - before) / seconds : 0.0;
+    };
+
+    report += "Acquisition\n";
+    appendFormatted(report, "  Bytes read            %llu", asPrintable(current.bytesRead));
+    if (previous != nullptr) {
+        appendFormatted(report, "  (%.2f MB/s)", rate(current.bytesRead, previous->bytesRead) / 1e6);
+    }
+    report += '\n';
+    appendFormatted(report, "  Frames parsed         %llu", asPrintable(current.framesParsed));
+    if (previous != nullptr) {
+        appendFormatted(report, "  (%.1f frames/s)", rate(current.framesParsed, previous->framesParsed));
+    }
+    report += '\n';
+    appendFormatted(report, "  Frames lost in stream %llu\n", asPrintable(current.framesLost));
+    appendFormatted(report, "  Overload policy       %s", current.overloadPolicy.c_str());
+    if (current.latencyBudgetMs > 0) {
+        appendFormatted(report, "  (budget %d ms)", current.latencyBudgetMs);
+    }
+    report += '\n';
+    appendFormatted(report, "  Frames dropped        %llu  (display queue full)\n", asPrintable(current.framesDropped));
+    appendFormatted(report, "  Frames shed           %llu  (overload policy)\n", asPrintable(current.framesShed));
+    appendFormatted(report, "  Frames held back      %llu  (display queue full, lossless)\n", asPrintable(current.framesBacklogged));
+    appendFormatted(report, "  Resyncs               %llu\n", asPrintable(current.resyncs));
+    appendFormatted(report, "  Bytes discarded       %llu\n", asPrintable(current.bytesDiscarded));
+    appendFormatted(report, "  Frames rejected       %llu\n", asPrintable(current.framesRejected));
+    appendFormatted(report, "  Display queue         %llu / %llu\n", asPrintable(current.displayQueueDepth),
+                    asPrintable(current.displayQueueCapacity));
+
+    report += "Recording\n";
+    if (current.recording || current.framesRecorded > 0) {
+        appendFormatted(report, "  Frames written        %llu\n", asPrintable(current.framesRecorded));
+        appendFormatted(report, "  Frames dropped        %llu\n", asPrintable(current.recorderDropped));
+        appendFormatted(report, "  Bytes written         %llu", asPrintable(current.bytesRecorded));
+        if (previous != nullptr) {
+            appendFormatted(report, "  (%.2f MB/s)", rate(current.bytesRecorded, previous->bytesRecorded) / 1e6);
+        }
+        report += '\n';
+        appendFormatted(report, "  Writer queue          %llu / %llu\n", asPrintable(current.recorderQueueDepth),
+                        asPrintable(current.recorderQueueCapacity));
+    } else {
+        report += "  Not recording to disk\n";
+    }
+
+    report += "Device commands\n";
+    appendFormatted(report, "  Completed             %llu\n", asPrintable(current.commandsCompleted));
+    appendFormatted(report, "  Failed                %llu\n", asPrintable(current.commandsFailed));
+    appendFormatted(report, "  Retries               %llu\n", asPrintable(current.commandRetries));
+    appendFormatted(report, "  Mean round trip       %.2f ms\n", current.commandRoundTripMs);
+
+    report += "Display\n";
+    appendFormatted(report, "  Frames drawn          %llu", asPrintable(current.framesDrawn));
+    if (previous != nullptr) {
+        appendFormatted(report, "  (%.1f frames/s)", rate(current.framesDrawn, previous->framesDrawn));
+    }
+    report += '\n';
+    appendFormatted(report, "  Frames skipped        %llu\n", asPrintable(current.framesSkippedForDisplay));
+
+    const LatencyHistogram::Snapshot& latency = current.displayLatency;
+    report += "Read-to-display latency\n";
+    if (latency.samples == 0) {
+        report += "  No frames drawn\n";
+        return report;
+    }
+    appendFormatted(report, "  Samples %llu, mean %.0f us, p50 %.0f us, p99 %.0f us, max %.0f us\n",
+                    asPrintable(latency.samples), latency.meanMicroseconds(), latency.percentileMicroseconds(0.5),
+                    latency.percentileMicroseconds(0.99), latency.maxMicroseconds());
+    for (int bucket = 0; bucket < LatencyHistogram::BucketCount; ++bucket) {
+        if (latency.counts[bucket] == 0) {
+            continue;
+        }
+        appendFormatted(report, "  %10.0f - %10.0f us  %llu\n", LatencyHistogram::bucketLowerMicroseconds(bucket),
+                        LatencyHistogram::bucketUpperMicroseconds(bucket), asPrintable(latency.counts[bucket]));
+    }
+    return report;
+}
+
+void saveTelemetryReport(const std::filesystem::path& path, const std::string& report) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+    file << report;
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Writing " + path.string() + " failed");
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef PIPELINETELEMETRY_H
+#define PIPELINETELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+class AcquisitionWorker;
+class DeviceCommandQueue;
+class FrameRecorder;
+
+// Log-scale histogram of durations. Recording is a few relaxed atomic
+// operations and never locks, so any thread may record while another takes
+// snapshots. Each power of two from 1 us to about a minute is split into
+// four buckets, which bounds the error of a percentile to 25%.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBuckets = 4;
+    static constexpr int Octaves = 26;
+    static constexpr int BucketCount = 1 + Octaves * SubBuckets + 1;  // Under 1 us, ..., overflow
+
+    struct Snapshot {
+        std::array<uint64_t, BucketCount> counts{};
+        uint64_t samples = 0;
+        int64_t totalNs = 0;
+        int64_t maxNs = 0;
+
+        double meanMicroseconds() const { return samples > 0 ? totalNs / 1e3 / static_cast<double>(samples) : 0.0; }
+        double maxMicroseconds() const { return maxNs / 1e3; }
+        // Upper edge of the bucket holding the given fraction of samples
+        double percentileMicroseconds(double fraction) const;
+    };
+
+    void record(int64_t durationNs);
+    void reset();
+    Snapshot snapshot() const;
+
+    static double bucketLowerMicroseconds(int bucket);
+    static double bucketUpperMicroseconds(int bucket);
+
+private:
+    static int bucketFor(int64_t durationNs);
+
+    std::array<std::atomic<uint64_t>, BucketCount> counts{};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<int64_t> totalNs{0};
+    std::atomic<int64_t> maxNs{0};
+};
+
+// Counters of the acquisition pipeline at one moment, gathered from the
+// stages that own them. Rates come from the difference of two snapshots.
+struct TelemetrySnapshot {
+    int64_t timeNs = 0;  // Steady clock
+
+    // Acquisition thread
+    uint64_t bytesRead = 0;
+    uint64_t framesParsed = 0;
+    uint64_t framesLost = 0;           // In the stream, see AcquisitionWorker::lostFrames()
+    uint64_t framesDropped = 0;        // GUI queue full
+    uint64_t framesShed = 0;           // Not presented under the overload policy
+    uint64_t framesBacklogged = 0;     // Held back while the GUI queue was full (lossless)
+    std::string overloadPolicy;
+    int latencyBudgetMs = 0;           // Bounded latency only
+    uint64_t resyncs = 0;
+    uint64_t bytesDiscarded = 0;
+    uint64_t framesRejected = 0;
+    std::size_t displayQueueDepth = 0;
+    std::size_t displayQueueCapacity = 0;
+
+    // Recording writer
+    bool recording = false;
+    uint64_t framesRecorded = 0;
+    uint64_t recorderDropped = 0;
+    uint64_t bytesRecorded = 0;
+    std::size_t recorderQueueDepth = 0;
+    std::size_t recorderQueueCapacity = 0;
+
+    // Command channel
+    uint64_t commandsCompleted = 0;
+    uint64_t commandsFailed = 0;
+    uint64_t commandRetries = 0;
+    double commandRoundTripMs = 0.0;  // Mean
+
+    // Display, filled in by whoever draws
+    uint64_t framesDrawn = 0;
+    uint64_t framesSkippedForDisplay = 0;
+    LatencyHistogram::Snapshot displayLatency;  // Frame read to frame drawn
+};
+
+// Acquisition, recorder and command counters; recorder and commands may be null
+TelemetrySnapshot collectTelemetry(const AcquisitionWorker& worker, const FrameRecorder* recorder,
+                                   const DeviceCommandQueue* commands);
+
+// Human-readable report; rates are over the interval since `previous`,
+// when there is one
+std::string formatTelemetryReport(const TelemetrySnapshot& current, const TelemetrySnapshot* previous = nullptr);
+
+// Throws std::runtime_error when the file cannot be written
+void saveTelemetryReport(const std::filesystem::path& path, const std::string& report);
+
+#endif // PIPELINETELEMETRY_H
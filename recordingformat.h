@@ -0,0 +1,84 @@
+#ifndef RECORDINGFORMAT_H
+#define RECORDINGFORMAT_H
+
+#include <cstdint>
+
+// On-disk layout of a .lsvrec recording. All fields are little-endian.
+//
+//   RecordingHeader
+//   block 0: IndexInterval frame records, then an index block for them
+//   block 1: ...
+//   last block: up to IndexInterval frame records, then its index block
+//
+// A frame record is a FrameRecordHeader followed by the pixel samples, so
+// every record has the same size and frame N sits at a fixed offset. Every
+// block but the last is full, which keeps seeking arithmetic; the index
+// blocks carry each frame's sequence number and timestamp so a reader can
+// scrub by time without touching the pixel data. A recording cut short by a
+// crash simply ends without its last index block; the complete records
+// before that point are still recognised by their magic.
+namespace RecordingFormat {
+
+constexpr char Magic[8] = {'L', 'S', 'V', 'R', 'E', 'C', '\r', '\n'};
+constexpr uint32_t Version = 1;
+constexpr uint32_t FrameMagic = 0x4656534C;  // "LSVF" on disk
+constexpr uint32_t IndexMagic = 0x4956534C;  // "LSVI" on disk
+constexpr uint32_t IndexInterval = 1024;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint32_t pixelCount;
+    uint32_t bitsPerSample;
+    uint32_t frameRecordBytes;
+    uint32_t indexInterval;
+    int64_t startTimeNs;       // Wall-clock time the recording was opened, ns since the Unix epoch
+    int64_t startTimestampNs;  // Frame timestamp clock at the same moment
+    uint8_t reserved[16];
+};
+
+struct FrameRecordHeader {
+    uint32_t magic;
+    uint32_t exposureTime;
+    uint64_t sequence;
+    int64_t timestampNs;
+};
+
+struct IndexBlockHeader {
+    uint32_t magic;
+    uint32_t frameCount;
+    uint64_t firstFrame;
+};
+
+struct IndexEntry {
+    uint64_t sequence;
+    int64_t timestampNs;
+};
+
+static_assert(sizeof(RecordingHeader) == 64, "RecordingHeader must be packed");
+static_assert(sizeof(FrameRecordHeader) == 24, "FrameRecordHeader must be packed");
+static_assert(sizeof(IndexBlockHeader) == 16, "IndexBlockHeader must be packed");
+static_assert(sizeof(IndexEntry) == 16, "IndexEntry must be packed");
+
+constexpr uint64_t frameRecordBytes(uint32_t pixelCount) {
+    return sizeof(FrameRecordHeader) + uint64_t{pixelCount} * sizeof(uint16_t);
+}
+
+constexpr uint64_t indexBlockBytes(uint32_t frameCount) {
+    return sizeof(IndexBlockHeader) + uint64_t{frameCount} * sizeof(IndexEntry);
+}
+
+constexpr uint64_t fullBlockBytes(const RecordingHeader& header) {
+    return header.indexInterval * uint64_t{header.frameRecordBytes} + indexBlockBytes(header.indexInterval);
+}
+
+// File offset of frame `index`'s record
+constexpr uint64_t frameOffset(const RecordingHeader& header, uint64_t index) {
+    return header.headerBytes + (index / header.indexInterval) * fullBlockBytes(header) +
+           (index % header.indexInterval) * header.frameRecordBytes;
+}
+
+} // namespace RecordingFormat
+
+#endif // RECORDINGFORMAT_H
@@ -0,0 +1,46 @@
+#include "recordingplayback.h"
+#include <algorithm>
+
+void RecordingPlayback::setReader(const RecordingReader* recording) {
+    reader = recording;
+    playing = false;
+    seek(0);
+}
+
+void RecordingPlayback::play() {
+    if (reader == nullptr || reader->frameCount() == 0) {
+        return;
+    }
+    if (atEnd()) {
+        seek(0);
+    }
+    playing = true;
+}
+
+void RecordingPlayback::seek(uint64_t frame) {
+    if (reader == nullptr || reader->frameCount() == 0) {
+        currentFrame = 0;
+        playbackTimeNs = 0.0;
+        return;
+    }
+    currentFrame = std::min(frame, reader->frameCount() - 1);
+    playbackTimeNs = static_cast<double>(reader->timestampAt(currentFrame));
+}
+
+bool RecordingPlayback::atEnd() const {
+    return reader == nullptr || currentFrame + 1 >= reader->frameCount();
+}
+
+bool RecordingPlayback::advance(int64_t elapsedNs) {
+    if (!playing || reader == nullptr) {
+        return false;
+    }
+
+    playbackTimeNs += static_cast<double>(elapsedNs) * speedFactor;
+    const uint64_t previousFrame = currentFrame;
+    currentFrame = std::max(currentFrame, reader->frameAtTimestamp(static_cast<int64_t>(playbackTimeNs)));
+    if (atEnd()) {
+        playing = false;
+    }
+    return currentFrame != previousFrame;
+}
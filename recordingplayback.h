@@ -0,0 +1,40 @@
+#ifndef RECORDINGPLAYBACK_H
+#define RECORDINGPLAYBACK_H
+
+#include <cstdint>
+#include "recordingreader.h"
+
+// Playback position over an open recording. Time advances in recording time
+// (scaled by the playback speed), so frames are shown at the rate they were
+// acquired and gaps in the recording are kept; frames that fall between two
+// display updates are skipped rather than queued.
+class RecordingPlayback
+{
+public:
+    // Rewinds to the first frame, paused
+    void setReader(const RecordingReader* recording);
+
+    void play();
+    void pause() { playing = false; }
+    bool isPlaying() const { return playing; }
+
+    void setSpeed(double factor) { speedFactor = factor; }
+    double speed() const { return speedFactor; }
+
+    void seek(uint64_t frame);
+    uint64_t position() const { return currentFrame; }
+    bool atEnd() const;
+
+    // Moves the position on by elapsedNs of wall-clock time and returns true
+    // when it changed. Pauses on the last frame.
+    bool advance(int64_t elapsedNs);
+
+private:
+    const RecordingReader* reader = nullptr;
+    bool playing = false;
+    double speedFactor = 1.0;
+    uint64_t currentFrame = 0;
+    double playbackTimeNs = 0.0;  // Recording timestamp playback has reached
+};
+
+#endif // RECORDINGPLAYBACK_H
@@ -0,0 +1,261 @@
+#include "recordingreader.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace RecordingFormat;
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+void RecordingReader::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error(path.string() + " is empty");
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Cannot map " + path.string());
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    fileSize = static_cast<uint64_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    struct stat status {};
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error(path.string() + " is empty");
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path.string());
+    }
+    fileSize = static_cast<uint64_t>(status.st_size);
+#endif
+    data = static_cast<const uint8_t*>(view);
+
+    try {
+        locateFrames();
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+void RecordingReader::close() {
+    stopTimingScan();
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(data), static_cast<std::size_t>(fileSize));
+#endif
+    data = nullptr;
+    fileSize = 0;
+    fullBlocks = 0;
+    lastBlockFrames = 0;
+    totalFrames = 0;
+    lastBlockIndexed = true;
+}
+
+void RecordingReader::locateFrames() {
+    if (fileSize < sizeof(RecordingHeader)) {
+        throw std::runtime_error("Not a LaserSpectraVue recording");
+    }
+    std::memcpy(&fileHeader, data, sizeof(fileHeader));
+    if (std::memcmp(fileHeader.magic, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("Not a LaserSpectraVue recording");
+    }
+    if (fileHeader.version != Version) {
+        throw std::runtime_error("Unsupported recording version " + std::to_string(fileHeader.version));
+    }
+    if (fileHeader.pixelCount != SpectrumFrame::PixelCount || fileHeader.bitsPerSample != 16 ||
+        fileHeader.frameRecordBytes != frameRecordBytes(fileHeader.pixelCount) ||
+        fileHeader.indexInterval == 0 || fileHeader.headerBytes < sizeof(RecordingHeader) ||
+        fileHeader.headerBytes > fileSize) {
+        throw std::runtime_error("Unsupported sensor geometry in recording");
+    }
+
+    // Every block but the last is full, so only the tail needs inspecting
+    const uint64_t payload = fileSize - fileHeader.headerBytes;
+    const uint64_t blockBytes = fullBlockBytes(fileHeader);
+    fullBlocks = payload / blockBytes;
+    const uint64_t remainder = payload % blockBytes;
+    const uint8_t* lastBlock = data + fileHeader.headerBytes + fullBlocks * blockBytes;
+
+    lastBlockFrames = 0;
+    lastBlockIndexed = true;
+    if (remainder > 0) {
+        // A closed recording ends with k records and an index block for them
+        const uint64_t perFrame = fileHeader.frameRecordBytes + sizeof(IndexEntry);
+        bool indexed = false;
+        if (remainder >= sizeof(IndexBlockHeader) && (remainder - sizeof(IndexBlockHeader)) % perFrame == 0) {
+            const uint64_t frames = (remainder - sizeof(IndexBlockHeader)) / perFrame;
+            IndexBlockHeader index;
+            std::memcpy(&index, lastBlock + frames * fileHeader.frameRecordBytes, sizeof(index));
+            if (index.magic == IndexMagic && index.frameCount == frames) {
+                lastBlockFrames = frames;
+                indexed = true;
+            }
+        }
+
+        // Otherwise the writer stopped mid-block: keep the complete records
+        if (!indexed) {
+            lastBlockIndexed = false;
+            lastBlockFrames = std::min<uint64_t>(remainder / fileHeader.frameRecordBytes, fileHeader.indexInterval);
+            while (lastBlockFrames > 0) {
+                uint32_t magic;
+                std::memcpy(&magic, lastBlock + (lastBlockFrames - 1) * fileHeader.frameRecordBytes, sizeof(magic));
+                if (magic == FrameMagic) {
+                    break;
+                }
+                --lastBlockFrames;
+            }
+        }
+    }
+
+    totalFrames = fullBlocks * fileHeader.indexInterval + lastBlockFrames;
+}
+
+FrameRecordHeader RecordingReader::recordHeader(uint64_t index) const {
+    // Records are only 4-byte aligned, so copy rather than cast
+    FrameRecordHeader record;
+    std::memcpy(&record, data + frameOffset(fileHeader, index), sizeof(record));
+    return record;
+}
+
+void RecordingReader::readFrame(uint64_t index, SpectrumFrame& frame) const {
+    if (index >= totalFrames) {
+        throw std::out_of_range("Frame index out of range");
+    }
+    const FrameRecordHeader record = recordHeader(index);
+    frame.sequence = record.sequence;
+    frame.timestampNs = record.timestampNs;
+    frame.exposureTime = record.exposureTime;
+    std::memcpy(frame.pixels.data(), data + frameOffset(fileHeader, index) + sizeof(record), sizeof(frame.pixels));
+    const SampleRange range = measureSampleRange(frame.pixels.data(), frame.pixels.size());
+    frame.minimum = range.minimum;
+    frame.maximum = range.maximum;
+}
+
+RecordingFormat::IndexEntry RecordingReader::indexEntry(uint64_t index) const {
+    if (index >= totalFrames) {
+        throw std::out_of_range("Frame index out of range");
+    }
+
+    // Prefer the index block, which keeps scrubbing off the pixel pages
+    const uint64_t block = index / fileHeader.indexInterval;
+    if (block < fullBlocks || lastBlockIndexed) {
+        const uint64_t blockFrames = block < fullBlocks ? fileHeader.indexInterval : lastBlockFrames;
+        const uint64_t entryOffset = fileHeader.headerBytes + block * fullBlockBytes(fileHeader) +
+                                     blockFrames * fileHeader.frameRecordBytes + sizeof(IndexBlockHeader) +
+                                     (index % fileHeader.indexInterval) * sizeof(IndexEntry);
+        IndexEntry entry;
+        std::memcpy(&entry, data + entryOffset, sizeof(entry));
+        return entry;
+    }
+    const FrameRecordHeader record = recordHeader(index);
+    return {record.sequence, record.timestampNs};
+}
+
+int64_t RecordingReader::timestampAt(uint64_t index) const {
+    return indexEntry(index).timestampNs;
+}
+
+uint64_t RecordingReader::sequenceAt(uint64_t index) const {
+    return indexEntry(index).sequence;
+}
+
+FrameTimingStats RecordingReader::timingStats() const {
+    FrameTiming timing;
+    collectTiming(timing, nullptr);
+    return timing.stats();
+}
+
+bool RecordingReader::collectTiming(FrameTiming& timing, const std::atomic<bool>* cancel) const {
+    for (uint64_t index = 0; index < totalFrames; ++index) {
+        // Checked once per block
+        if (cancel != nullptr && index % fileHeader.indexInterval == 0 && cancel->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const IndexEntry entry = indexEntry(index);
+        timing.record(entry.sequence, entry.timestampNs);
+    }
+    return true;
+}
+
+void RecordingReader::scanTimingStats(TimingCallback finished) {
+    stopTimingScan();
+    if (data == nullptr) {
+        return;
+    }
+
+    // The mapping stays put until close(), which joins the scan first
+    timingScanCancelled.store(false, std::memory_order_relaxed);
+    timingScan = std::thread([this, finished = std::move(finished)]() {
+        FrameTiming timing;
+        if (collectTiming(timing, &timingScanCancelled)) {
+            finished(timing.stats());
+        }
+    });
+}
+
+void RecordingReader::stopTimingScan() {
+    if (!timingScan.joinable()) {
+        return;
+    }
+    timingScanCancelled.store(true, std::memory_order_relaxed);
+    timingScan.join();
+}
+
+uint64_t RecordingReader::frameAtTimestamp(int64_t timestampNs) const {
+    // Binary search for the first frame after timestampNs
+    uint64_t low = 0;
+    uint64_t high = totalFrames;
+    while (low < high) {
+        const uint64_t middle = low + (high - low) / 2;
+        if (timestampAt(middle) <= timestampNs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low > 0 ? low - 1 : 0;
+}
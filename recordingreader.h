@@ -0,0 +1,82 @@
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include "frametiming.h"
+#include "recordingformat.h"
+#include "spectrumframe.h"
+
+// Random access to a .lsvrec recording through a read-only memory mapping.
+// Opening only looks at the header and the tail of the file, so it takes
+// the same time for any recording size; frame N is located arithmetically
+// and its pages are faulted in when it is read. A recording cut short by a
+// crash opens with every complete frame it contains.
+class RecordingReader
+{
+public:
+    using TimingCallback = std::function<void(const FrameTimingStats&)>;
+
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    // Throws std::runtime_error when the file cannot be mapped or is not a
+    // recording this build can read.
+    void open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    const RecordingFormat::RecordingHeader& header() const { return fileHeader; }
+    uint64_t frameCount() const { return totalFrames; }
+
+    // False when the recording did not end with its final index block
+    bool isComplete() const { return lastBlockIndexed; }
+
+    void readFrame(uint64_t index, SpectrumFrame& frame) const;
+    int64_t timestampAt(uint64_t index) const;
+    uint64_t sequenceAt(uint64_t index) const;
+
+    // Rate, jitter and sequence gaps over the whole recording, read from
+    // the index blocks. That touches every block, and the frame headers of an
+    // unfinished last one, so it takes a while on a long recording.
+    FrameTimingStats timingStats() const;
+
+    // Works out timingStats() on a thread of its own and hands them to
+    // `finished` from that thread. close(), open() and the next scan abandon
+    // a scan still running, which then does not call back.
+    void scanTimingStats(TimingCallback finished);
+
+    // Last frame acquired at or before timestampNs, or 0 if there is none
+    uint64_t frameAtTimestamp(int64_t timestampNs) const;
+
+private:
+    RecordingFormat::FrameRecordHeader recordHeader(uint64_t index) const;
+    RecordingFormat::IndexEntry indexEntry(uint64_t index) const;
+    void locateFrames();
+    bool collectTiming(FrameTiming& timing, const std::atomic<bool>* cancel) const;
+    void stopTimingScan();
+
+    const uint8_t* data = nullptr;
+    uint64_t fileSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    RecordingFormat::RecordingHeader fileHeader{};
+    uint64_t fullBlocks = 0;
+    uint64_t lastBlockFrames = 0;
+    uint64_t totalFrames = 0;
+    bool lastBlockIndexed = true;
+
+    std::thread timingScan;
+    std::atomic<bool> timingScanCancelled{false};
+};
+
+#endif // RECORDINGREADER_H
@@ -0,0 +1,33 @@
+#ifndef SIMDSUPPORT_H
+#define SIMDSUPPORT_H
+
+// x86 SIMD levels available to the per-frame kernels. SSE2 is the x86-64
+// baseline. AVX2 is compiled in with a target attribute on GCC/Clang and
+// picked at runtime with cpuHasAvx2(); MSVC only gets it when the whole
+// build targets AVX2.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LSV_SIMD_SSE2 1
+#include <immintrin.h>
+#endif
+
+#if defined(LSV_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define LSV_SIMD_AVX2 1
+#define LSV_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(LSV_SIMD_SSE2) && defined(__AVX2__)
+#define LSV_SIMD_AVX2 1
+#define LSV_AVX2_TARGET
+#endif
+
+#ifdef LSV_SIMD_AVX2
+inline bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    // May run from static initialisers, before the CPU model is set up
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return true;
+#endif
+}
+#endif
+
+#endif // SIMDSUPPORT_H
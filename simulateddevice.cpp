@@ -0,0 +1,258 @@
+#include "simulateddevice.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+struct SimulatedPeak {
+    double centre;
+    double width;
+    double amplitude;
+};
+
+// Amplitudes at the default 10 ms exposure; they scale linearly with exposure
+// so long exposures saturate like the real sensor
+constexpr std::array<SimulatedPeak, 3> SimulatedPeaks{{
+    {300.0, 6.0, 12000.0},
+    {520.0, 3.0, 30000.0},
+    {780.0, 10.0, 6000.0},
+}};
+constexpr double SimulatedBaseline = 1000.0;
+constexpr int SimulatedNoise = 30;
+
+// Pixel values below 256 could form a 00 00 00 01 pattern inside the payload
+constexpr int MinimumPixelValue = 256;
+
+} // namespace
+
+SimulatedDevice::SimulatedDevice(const SimulationSettings& settings) :
+    settings(settings),
+    rng(settings.seed)
+{
+    pending.reserve(MaxPendingBytes + FrameSize);
+    updateProfile();
+}
+
+void SimulatedDevice::open() {
+    std::lock_guard<std::mutex> lock(mutex);
+    opened = true;
+    triggered = false;
+    responses.clear();
+    pending.clear();
+    pendingStart = 0;
+}
+
+void SimulatedDevice::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    opened = false;
+    triggered = false;
+    dataReady.notify_all();
+}
+
+bool SimulatedDevice::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return opened;
+}
+
+bool SimulatedDevice::writeCommand(const void* data, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!opened || size != sizeof(uint32_t)) {
+        return false;
+    }
+
+    // Commands are 4-byte little-endian words: 2 and 3 switch the trigger,
+    // any other value is an exposure time in microseconds
+    uint32_t command = 0;
+    std::memcpy(&command, data, sizeof(command));
+
+    if (command == 2) {
+        triggered = true;
+        streamStart = Clock::now();
+        framesDue = 0;
+        responses.push_back('t');
+        dataReady.notify_all();
+    } else if (command == 3) {
+        triggered = false;
+        responses.push_back('t');
+    } else {
+        exposureTime = command;
+        updateProfile();
+        responses.push_back('A');
+    }
+    return true;
+}
+
+bool SimulatedDevice::readCommandResponse(char& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (responses.empty()) {
+        return false;
+    }
+    response = responses.front();
+    responses.pop_front();
+    return true;
+}
+
+void SimulatedDevice::purgeCommandChannel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    responses.clear();
+}
+
+uint32_t SimulatedDevice::waitForData(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true) {
+        generateDueFrames();
+        if (pendingBytes() > 0 || cancelRequested || !opened) {
+            break;
+        }
+
+        const Clock::time_point now = Clock::now();
+        if (now >= deadline) {
+            break;
+        }
+
+        Clock::time_point wakeTime = deadline;
+        if (triggered && settings.frameRate > 0.0) {
+            const auto nextFrame = streamStart + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>((static_cast<double>(framesDue) + 1.0) / settings.frameRate));
+            wakeTime = std::min(wakeTime, nextFrame);
+        }
+        dataReady.wait_until(lock, wakeTime);
+    }
+
+    cancelRequested = false;
+    return static_cast<uint32_t>(std::min<std::size_t>(pendingBytes(), UINT32_MAX));
+}
+
+void SimulatedDevice::cancelWait() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelRequested = true;
+    dataReady.notify_all();
+}
+
+bool SimulatedDevice::readData(uint8_t* destination, uint32_t maxBytes, uint32_t& bytesRead) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!opened) {
+        bytesRead = 0;
+        return false;
+    }
+
+    generateDueFrames();
+    const std::size_t count = std::min<std::size_t>(maxBytes, pendingBytes());
+    std::memcpy(destination, pending.data() + pendingStart, count);
+    pendingStart += count;
+    bytesRead = static_cast<uint32_t>(count);
+
+    if (pendingStart == pending.size()) {
+        pending.clear();
+        pendingStart = 0;
+    }
+    return true;
+}
+
+bool SimulatedDevice::purgeDataChannel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+    pendingStart = 0;
+    return opened;
+}
+
+bool SimulatedDevice::resetDataChannel() {
+    return purgeDataChannel();
+}
+
+uint64_t SimulatedDevice::framesGenerated() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generated;
+}
+
+uint64_t SimulatedDevice::framesOverflowed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return overflowed;
+}
+
+void SimulatedDevice::generateDueFrames() {
+    if (!opened || !triggered) {
+        return;
+    }
+
+    if (settings.frameRate <= 0.0) {
+        // Unthrottled: keep a small batch queued so the reader is never starved
+        if (pendingBytes() == 0) {
+            for (int i = 0; i < UnthrottledBatchFrames; ++i) {
+                appendFrame();
+            }
+        }
+        return;
+    }
+
+    const std::chrono::duration<double> elapsed = Clock::now() - streamStart;
+    const auto due = static_cast<uint64_t>(elapsed.count() * settings.frameRate);
+    while (framesDue < due) {
+        appendFrame();
+        ++framesDue;
+    }
+}
+
+void SimulatedDevice::appendFrame() {
+    if (pendingBytes() + 2 * FrameSize > MaxPendingBytes) {
+        // Nobody is draining the channel; like the real driver, new data is lost
+        ++overflowed;
+        return;
+    }
+
+    // Reclaim consumed space before it forces a reallocation
+    if (pendingStart > 0 && pending.size() + 2 * FrameSize > pending.capacity()) {
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pendingStart));
+        pendingStart = 0;
+    }
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    if (settings.misalignmentRate > 0.0 && chance(rng) < settings.misalignmentRate) {
+        const int strayBytes = 1 + static_cast<int>(rng() % 32);
+        for (int i = 0; i < strayBytes; ++i) {
+            pending.push_back(static_cast<uint8_t>(rng()));
+        }
+    }
+
+    const std::size_t frameStart = pending.size();
+    pending.resize(frameStart + FrameSize);
+    uint8_t* frame = pending.data() + frameStart;
+    frame[0] = 0x00;
+    frame[1] = 0x00;
+    frame[2] = 0x00;
+    frame[3] = 0x01;
+
+    for (int pixel = 0; pixel < PixelCount; ++pixel) {
+        const int noise = static_cast<int>(rng() % (2 * SimulatedNoise + 1)) - SimulatedNoise;
+        const int value = std::clamp(static_cast<int>(profile[pixel]) + noise, MinimumPixelValue, 65535);
+        frame[4 + 2 * pixel] = static_cast<uint8_t>(value >> 8);
+        frame[5 + 2 * pixel] = static_cast<uint8_t>(value & 0xFF);
+    }
+
+    if (settings.byteLossRate > 0.0 && chance(rng) < settings.byteLossRate) {
+        const std::size_t lost = 1 + rng() % 64;
+        const std::size_t offset = rng() % (FrameSize - lost);
+        auto first = pending.begin() + static_cast<std::ptrdiff_t>(frameStart + offset);
+        pending.erase(first, first + static_cast<std::ptrdiff_t>(lost));
+    }
+
+    ++generated;
+}
+
+void SimulatedDevice::updateProfile() {
+    const double scale = static_cast<double>(exposureTime) / 10000.0;
+    profile.assign(PixelCount, SimulatedBaseline);
+    for (int pixel = 0; pixel < PixelCount; ++pixel) {
+        double value = SimulatedBaseline;
+        for (const auto& peak : SimulatedPeaks) {
+            const double distance = (pixel - peak.centre) / peak.width;
+            value += peak.amplitude * scale * std::exp(-0.5 * distance * distance);
+        }
+        profile[pixel] = std::min(value, 65535.0);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef SIMULATEDDEVICE_H
+#define SIMULATEDDEVICE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "spectrometerdevice.h"
+
+struct SimulationSettings {
+    double frameRate = 100.0;       // Frames per second while triggered; 0 streams as fast as it is read
+    double byteLossRate = 0.0;      // Probability per frame that a run of bytes is lost in transit
+    double misalignmentRate = 0.0;  // Probability per frame that stray bytes precede the sync header
+    uint32_t seed = 1;
+    std::string serialNumber = "SIM0001";
+};
+
+// Hardware-free stand-in for an MD_HS_V1 head. The command channel speaks the
+// UART protocol (a 4-byte exposure write is acknowledged with 'A', trigger
+// on/off with 't'), and while triggered the data channel produces 2088-byte
+// frames with the 00 00 00 01 sync header at the configured rate.
+class SimulatedDevice final : public SpectrometerDevice
+{
+public:
+    explicit SimulatedDevice(const SimulationSettings& settings = {});
+
+    void open() override;
+    void close() override;
+    bool isOpen() const override;
+    std::string serialNumber() const override { return settings.serialNumber; }
+
+    bool writeCommand(const void* data, uint32_t size) override;
+    bool readCommandResponse(char& response) override;
+    void purgeCommandChannel() override;
+
+    uint32_t waitForData(int timeoutMs) override;
+    void cancelWait() override;
+    bool readData(uint8_t* destination, uint32_t maxBytes, uint32_t& bytesRead) override;
+    bool purgeDataChannel() override;
+    bool resetDataChannel() override;
+
+    uint64_t framesGenerated() const;
+    uint64_t framesOverflowed() const;
+
+    static constexpr int FrameSize = 2088;
+    static constexpr int PixelCount = (FrameSize - 4) / 2;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void generateDueFrames();
+    void appendFrame();
+    void updateProfile();
+    std::size_t pendingBytes() const { return pending.size() - pendingStart; }
+
+    // Bytes the driver would hold before the device starts losing data
+    static constexpr std::size_t MaxPendingBytes = 4 * 1024 * 1024;
+    static constexpr int UnthrottledBatchFrames = 16;
+
+    SimulationSettings settings;
+    mutable std::mutex mutex;
+    std::condition_variable dataReady;
+
+    bool opened = false;
+    bool triggered = false;
+    bool cancelRequested = false;
+    uint32_t exposureTime = 10000;
+    std::deque<char> responses;
+
+    std::vector<double> profile;
+    std::vector<uint8_t> pending;
+    std::size_t pendingStart = 0;
+    Clock::time_point streamStart;
+    uint64_t framesDue = 0;
+    uint64_t generated = 0;
+    uint64_t overflowed = 0;
+
+    std::minstd_rand rng;
+};
+
+#endif // SIMULATEDDEVICE_H
@@ -0,0 +1,41 @@
+#ifndef SPECTROMETERDEVICE_H
+#define SPECTROMETERDEVICE_H
+
+#include <cstdint>
+#include <string>
+
+// Transport for one spectrometer head. The head exposes two channels: a UART
+// command channel ("MD_HS_V1 A") that acknowledges every command with a single
+// byte, and a streaming data channel ("MD_HS_V1 B") carrying 2088-byte frames.
+//
+// open() throws std::runtime_error on failure; the per-call channel operations
+// report failure through their return value, like the FTDI calls they wrap.
+class SpectrometerDevice
+{
+public:
+    virtual ~SpectrometerDevice() = default;
+
+    virtual void open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    // Identifies the head among several; may be empty until open()
+    virtual std::string serialNumber() const = 0;
+
+    // Command channel. readCommandResponse() does not wait: it returns false
+    // when no response byte has arrived yet.
+    virtual bool writeCommand(const void* data, uint32_t size) = 0;
+    virtual bool readCommandResponse(char& response) = 0;
+    virtual void purgeCommandChannel() = 0;
+
+    // Data channel. waitForData() blocks until bytes are queued, the timeout
+    // expires or cancelWait() is called from another thread, and returns the
+    // number of bytes that can be read without blocking.
+    virtual uint32_t waitForData(int timeoutMs) = 0;
+    virtual void cancelWait() = 0;
+    virtual bool readData(uint8_t* destination, uint32_t maxBytes, uint32_t& bytesRead) = 0;
+    virtual bool purgeDataChannel() = 0;
+    virtual bool resetDataChannel() = 0;
+};
+
+#endif // SPECTROMETERDEVICE_H
@@ -0,0 +1,81 @@
+#include "spectrometerpipeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#ifdef LSV_HAVE_FTD2XX
+#include "ftdidevice.h"
+#endif
+
+SpectrometerPipeline::SpectrometerPipeline(std::unique_ptr<SpectrometerDevice> spectrometer) :
+    spectrometer(std::move(spectrometer))
+{
+}
+
+SpectrometerPipeline::~SpectrometerPipeline() {
+    close();
+}
+
+void SpectrometerPipeline::open() {
+    spectrometer->open();
+    commandQueue.start(spectrometer.get());
+}
+
+void SpectrometerPipeline::close() {
+    acquisitionWorker.stop();
+    frameRecorder.close();
+    commandQueue.stop();
+    spectrometer->close();
+}
+
+std::vector<std::unique_ptr<SpectrometerDevice>> createSpectrometers(const DeviceSelection& selection) {
+    std::vector<std::unique_ptr<SpectrometerDevice>> devices;
+
+#ifdef LSV_HAVE_FTD2XX
+    if (!selection.simulate) {
+        const std::vector<FtdiDevice::Head> heads = FtdiDevice::enumerate();
+        if (selection.serialNumbers.empty()) {
+            for (const FtdiDevice::Head& head : heads) {
+                devices.push_back(std::make_unique<FtdiDevice>(head));
+            }
+            if (devices.empty()) {
+                devices.push_back(std::make_unique<FtdiDevice>());
+            }
+            return devices;
+        }
+        for (const std::string& serialNumber : selection.serialNumbers) {
+            const auto head = std::find_if(heads.begin(), heads.end(), [&](const FtdiDevice::Head& candidate) {
+                return candidate.serialNumber == serialNumber;
+            });
+            if (head == heads.end()) {
+                throw std::runtime_error("No spectrometer with serial number " + serialNumber + " is attached");
+            }
+            devices.push_back(std::make_unique<FtdiDevice>(*head));
+        }
+        return devices;
+    }
+#endif
+
+    // Simulated heads are numbered SIM0001, SIM0002, ...; asking for serial
+    // numbers picks among them as it would among attached heads
+    std::vector<std::string> serialNumbers = selection.serialNumbers;
+    if (serialNumbers.empty()) {
+        for (int index = 0; index < std::max(1, selection.simulatedDevices); ++index) {
+            char serialNumber[16];
+            std::snprintf(serialNumber, sizeof(serialNumber), "SIM%04d", index + 1);
+            serialNumbers.push_back(serialNumber);
+        }
+    }
+    for (std::size_t index = 0; index < serialNumbers.size(); ++index) {
+        SimulationSettings settings = selection.simulation;
+        settings.seed += static_cast<uint32_t>(index);
+        settings.serialNumber = serialNumbers[index];
+        devices.push_back(std::make_unique<SimulatedDevice>(settings));
+    }
+    return devices;
+}
+
+std::filesystem::path devicePath(const std::filesystem::path& path, const std::string& serialNumber) {
+    std::filesystem::path result = path;
+    result.replace_filename(path.stem().string() + "_" + serialNumber + path.extension().string());
+    return result;
+}
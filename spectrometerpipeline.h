@@ -0,0 +1,66 @@
+#ifndef SPECTROMETERPIPELINE_H
+#define SPECTROMETERPIPELINE_H
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "acquisitionworker.h"
+#include "devicecommandqueue.h"
+#include "framerecorder.h"
+#include "simulateddevice.h"
+#include "spectrometerdevice.h"
+
+// One spectrometer head with everything that serves it: its command thread,
+// its acquisition thread with the stream parser, and its recorder. Pipelines
+// share no state, so several heads acquire on separate cores without
+// contending on a common lock; only their consumers decide how the frames
+// meet again.
+class SpectrometerPipeline
+{
+public:
+    explicit SpectrometerPipeline(std::unique_ptr<SpectrometerDevice> spectrometer);
+    ~SpectrometerPipeline();
+
+    SpectrometerPipeline(const SpectrometerPipeline&) = delete;
+    SpectrometerPipeline& operator=(const SpectrometerPipeline&) = delete;
+
+    // Opens the device and starts its command thread; throws
+    // std::runtime_error when the device cannot be opened
+    void open();
+    // Stops acquiring, finishes any recording and closes the device
+    void close();
+
+    std::string serialNumber() const { return spectrometer->serialNumber(); }
+    SpectrometerDevice& device() { return *spectrometer; }
+    DeviceCommandQueue& commands() { return commandQueue; }
+    AcquisitionWorker& worker() { return acquisitionWorker; }
+    FrameRecorder& recorder() { return frameRecorder; }
+
+private:
+    std::unique_ptr<SpectrometerDevice> spectrometer;
+    DeviceCommandQueue commandQueue;
+    FrameRecorder frameRecorder;
+    AcquisitionWorker acquisitionWorker;  // Declared last: stops before the recorder it feeds goes
+};
+
+// Which heads to drive
+struct DeviceSelection {
+    bool simulate = false;
+    int simulatedDevices = 1;
+    SimulationSettings simulation;           // Each simulated head gets its own seed and serial
+    std::vector<std::string> serialNumbers;  // Empty: every head attached, or simulatedDevices
+};
+
+// Devices for the selection, unopened. Without the FTDI driver, or with
+// simulate set, simulated heads are returned. When no head is attached and
+// none was asked for by serial number, the single head found by its channel
+// descriptions is returned, so open() reports what is wrong. Throws
+// std::runtime_error when a requested serial number is not attached.
+std::vector<std::unique_ptr<SpectrometerDevice>> createSpectrometers(const DeviceSelection& selection);
+
+// "run.lsvrec" and "FT1234" give "run_FT1234.lsvrec"; used for every head
+// but the first when several record at once
+std::filesystem::path devicePath(const std::filesystem::path& path, const std::string& serialNumber);
+
+#endif // SPECTROMETERPIPELINE_H
@@ -0,0 +1,79 @@
+#include "spectrumcorrection.h"
+#include <algorithm>
+#include <limits>
+#include "simdsupport.h"
+
+namespace {
+
+template <bool Subtract>
+ValueRange correctScalar(const uint16_t* pixels, const float* background, float* values, std::size_t count,
+                         ValueRange range) {
+    for (std::size_t i = 0; i < count; ++i) {
+        float value = static_cast<float>(pixels[i]);
+        if (Subtract) {
+            value -= background[i];
+        }
+        values[i] = value;
+        range.minimum = std::min(range.minimum, value);
+        range.maximum = std::max(range.maximum, value);
+    }
+    return range;
+}
+
+#ifdef LSV_SIMD_SSE2
+// Eight samples per step: widen to 32 bits, convert, subtract
+template <bool Subtract>
+ValueRange correctSse2(const uint16_t* pixels, const float* background, float* values, std::size_t count,
+                       ValueRange range) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128 low = _mm_set1_ps(range.minimum);
+    __m128 high = _mm_set1_ps(range.maximum);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        __m128 first = _mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, zero));
+        __m128 second = _mm_cvtepi32_ps(_mm_unpackhi_epi16(raw, zero));
+        if (Subtract) {
+            first = _mm_sub_ps(first, _mm_loadu_ps(background + i));
+            second = _mm_sub_ps(second, _mm_loadu_ps(background + i + 4));
+        }
+        _mm_storeu_ps(values + i, first);
+        _mm_storeu_ps(values + i + 4, second);
+        low = _mm_min_ps(low, _mm_min_ps(first, second));
+        high = _mm_max_ps(high, _mm_max_ps(first, second));
+    }
+
+    alignas(16) float lows[4];
+    alignas(16) float highs[4];
+    _mm_store_ps(lows, low);
+    _mm_store_ps(highs, high);
+    range.minimum = *std::min_element(lows, lows + 4);
+    range.maximum = *std::max_element(highs, highs + 4);
+    return correctScalar<Subtract>(pixels + i, background + (Subtract ? i : 0), values + i, count - i, range);
+}
+#endif
+
+template <bool Subtract>
+ValueRange correct(const uint16_t* pixels, const float* background, float* values, std::size_t count) {
+    ValueRange range{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()};
+#ifdef LSV_SIMD_SSE2
+    range = correctSse2<Subtract>(pixels, background, values, count, range);
+#else
+    range = correctScalar<Subtract>(pixels, background, values, count, range);
+#endif
+    return count > 0 ? range : ValueRange{};
+}
+
+} // namespace
+
+ValueRange correctSpectrum(const uint16_t* pixels, const float* background, float* values, std::size_t count) {
+    return background != nullptr ? correct<true>(pixels, background, values, count)
+                                 : correct<false>(pixels, nullptr, values, count);
+}
+
+ValueRange correctSpectrumScalar(const uint16_t* pixels, const float* background, float* values, std::size_t count) {
+    const ValueRange initial{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()};
+    const ValueRange range = background != nullptr ? correctScalar<true>(pixels, background, values, count, initial)
+                                                   : correctScalar<false>(pixels, nullptr, values, count, initial);
+    return count > 0 ? range : ValueRange{};
+}
@@ -0,0 +1,20 @@
+#ifndef SPECTRUMCORRECTION_H
+#define SPECTRUMCORRECTION_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct ValueRange {
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+};
+
+// Converts raw samples to display values and subtracts a per-pixel
+// background (nullptr for none) in a single SIMD pass, returning the range
+// of the result. The background is a flat array indexed by pixel.
+ValueRange correctSpectrum(const uint16_t* pixels, const float* background, float* values, std::size_t count);
+
+// Scalar reference implementation of correctSpectrum()
+ValueRange correctSpectrumScalar(const uint16_t* pixels, const float* background, float* values, std::size_t count);
+
+#endif // SPECTRUMCORRECTION_H
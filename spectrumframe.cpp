@@ -0,0 +1,161 @@
+#include "spectrumframe.h"
+#include <algorithm>
+#include "simdsupport.h"
+
+namespace {
+
+using Decoder = SampleRange (*)(const uint8_t*, std::size_t, uint16_t*, SampleRange);
+
+SampleRange merge(SampleRange range, uint16_t minimum, uint16_t maximum) {
+    range.minimum = std::min(range.minimum, minimum);
+    range.maximum = std::max(range.maximum, maximum);
+    return range;
+}
+
+SampleRange decodeScalar(const uint8_t* data, std::size_t count, uint16_t* pixels, SampleRange range) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto value = static_cast<uint16_t>((data[2 * i] << 8) | data[2 * i + 1]);
+        pixels[i] = value;
+        range = merge(range, value, value);
+    }
+    return range;
+}
+
+#ifdef LSV_SIMD_SSE2
+// SSE2 has no unsigned 16-bit min/max, so values are biased by 0x8000 and
+// compared as signed
+inline __m128i biased(__m128i values) {
+    return _mm_xor_si128(values, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+
+SampleRange reduceBiased(SampleRange range, __m128i low, __m128i high) {
+    alignas(16) uint16_t lows[8];
+    alignas(16) uint16_t highs[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lows), biased(low));
+    _mm_store_si128(reinterpret_cast<__m128i*>(highs), biased(high));
+    for (int lane = 0; lane < 8; ++lane) {
+        range = merge(range, lows[lane], highs[lane]);
+    }
+    return range;
+}
+
+// Eight samples per step; the byte swap is a pair of 16-bit shifts
+SampleRange decodeSse2(const uint8_t* data, std::size_t count, uint16_t* pixels, SampleRange range) {
+    __m128i low = biased(_mm_set1_epi16(-1));
+    __m128i high = biased(_mm_setzero_si128());
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * i));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(raw, 8), _mm_srli_epi16(raw, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), swapped);
+        low = _mm_min_epi16(low, biased(swapped));
+        high = _mm_max_epi16(high, biased(swapped));
+    }
+    range = reduceBiased(range, low, high);
+    return decodeScalar(data + 2 * i, count - i, pixels + i, range);
+}
+#endif
+
+#ifdef LSV_SIMD_AVX2
+// Sixteen samples per step with a byte shuffle and native unsigned min/max
+LSV_AVX2_TARGET
+SampleRange decodeAvx2(const uint8_t* data, std::size_t count, uint16_t* pixels, SampleRange range) {
+    const __m256i swapBytes = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    __m256i low = _mm256_set1_epi16(-1);
+    __m256i high = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 2 * i));
+        const __m256i swapped = _mm256_shuffle_epi8(raw, swapBytes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i), swapped);
+        low = _mm256_min_epu16(low, swapped);
+        high = _mm256_max_epu16(high, swapped);
+    }
+
+    alignas(32) uint16_t lows[16];
+    alignas(32) uint16_t highs[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lows), low);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(highs), high);
+    for (int lane = 0; lane < 16; ++lane) {
+        range = merge(range, lows[lane], highs[lane]);
+    }
+    return decodeSse2(data + 2 * i, count - i, pixels + i, range);
+}
+#endif
+
+Decoder selectDecoder() {
+#if defined(LSV_SIMD_AVX2)
+    if (cpuHasAvx2()) {
+        return decodeAvx2;
+    }
+    return decodeSse2;
+#elif defined(LSV_SIMD_SSE2)
+    return decodeSse2;
+#else
+    return decodeScalar;
+#endif
+}
+
+const Decoder decoder = selectDecoder();
+
+} // namespace
+
+SampleRange decodeSamples(const uint8_t* data, std::size_t count, uint16_t* pixels) {
+    return decoder(data, count, pixels, SampleRange{});
+}
+
+SampleRange decodeSamplesScalar(const uint8_t* data, std::size_t count, uint16_t* pixels) {
+    return decodeScalar(data, count, pixels, SampleRange{});
+}
+
+SampleRange measureSampleRange(const uint16_t* pixels, std::size_t count) {
+    SampleRange range;
+    std::size_t i = 0;
+#ifdef LSV_SIMD_SSE2
+    __m128i low = biased(_mm_set1_epi16(-1));
+    __m128i high = biased(_mm_setzero_si128());
+    for (; i + 8 <= count; i += 8) {
+        const __m128i values = biased(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)));
+        low = _mm_min_epi16(low, values);
+        high = _mm_max_epi16(high, values);
+    }
+    range = reduceBiased(range, low, high);
+#endif
+    for (; i < count; ++i) {
+        range = merge(range, pixels[i], pixels[i]);
+    }
+    return range;
+}
+
+SampleRange decodeFramePixels(const RingSpan& frame, uint16_t* pixels) {
+    // Skip the sync header, which may itself straddle the wrap point
+    RingSpan samples = frame;
+    std::size_t skip = SpectrumFrame::HeaderBytes;
+    if (samples.firstSize <= skip) {
+        skip -= samples.firstSize;
+        samples.first = samples.second + skip;
+        samples.firstSize = samples.secondSize - skip;
+        samples.secondSize = 0;
+    } else {
+        samples.first += skip;
+        samples.firstSize -= skip;
+    }
+
+    std::size_t decoded = samples.firstSize / 2;
+    SampleRange range = decoder(samples.first, decoded, pixels, SampleRange{});
+    if (samples.isContiguous()) {
+        return range;
+    }
+
+    const uint8_t* tail = samples.second;
+    std::size_t tailSize = samples.secondSize;
+    if (samples.firstSize % 2 != 0) {
+        const auto value = static_cast<uint16_t>((samples.first[samples.firstSize - 1] << 8) | tail[0]);
+        pixels[decoded++] = value;
+        range = merge(range, value, value);
+        ++tail;
+        --tailSize;
+    }
+    return decoder(tail, tailSize / 2, pixels + decoded, range);
+}
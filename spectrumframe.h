@@ -0,0 +1,47 @@
+#ifndef SPECTRUMFRAME_H
+#define SPECTRUMFRAME_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "bytering.h"
+
+// One sensor frame decoded to native-endian pixel values, plus where it came
+// from. On the wire a frame is the 00 00 00 01 sync header followed by 1042
+// big-endian 16-bit samples; decoded it takes about 2 KB, an eighth of the
+// equivalent QVector<QPointF>.
+struct SpectrumFrame {
+    static constexpr int FrameBytes = 2088;
+    static constexpr int HeaderBytes = 4;
+    static constexpr int PixelCount = (FrameBytes - HeaderBytes) / 2;
+    static constexpr uint16_t SaturationLevel = 65535;
+
+    uint64_t sequence = 0;      // Position in the acquisition, counting from 0
+    int64_t timestampNs = 0;    // Steady-clock time the frame was parsed
+    uint32_t exposureTime = 0;  // Microseconds
+    uint16_t minimum = 0;       // Smallest and largest raw sample
+    uint16_t maximum = 0;
+    std::array<uint16_t, PixelCount> pixels{};
+
+    bool isSaturated() const { return maximum >= SaturationLevel; }
+};
+
+struct SampleRange {
+    uint16_t minimum = 0xFFFF;
+    uint16_t maximum = 0;
+};
+
+// Decodes the samples of a complete wire frame (header included) straight
+// from the stream ring and returns their range, found in the same pass; a
+// sample split across the ring's wrap point is reassembled from both pieces.
+SampleRange decodeFramePixels(const RingSpan& frame, uint16_t* pixels);
+
+// Byte-swaps `count` big-endian samples with SSE2 or AVX2 and returns their
+// range. decodeSamplesScalar() is the byte-at-a-time reference.
+SampleRange decodeSamples(const uint8_t* data, std::size_t count, uint16_t* pixels);
+SampleRange decodeSamplesScalar(const uint8_t* data, std::size_t count, uint16_t* pixels);
+
+// Range of already decoded samples, e.g. frames read back from a recording
+SampleRange measureSampleRange(const uint16_t* pixels, std::size_t count);
+
+#endif // SPECTRUMFRAME_H
@@ -0,0 +1,357 @@
+#include "spectrumplotwidget.h"
+#include "tracedecimation.h"
+#include <QElapsedTimer>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Margins around the plot area, leaving room for labels and titles
+constexpr int LeftMargin = 64;
+constexpr int RightMargin = 16;
+constexpr int TopMargin = 32;
+constexpr int BottomMargin = 48;
+
+const QColor BackgroundColor(24, 24, 24);
+const QColor PlotAreaColor(255, 255, 255);
+const QColor GridColor(200, 200, 200);
+const QColor TextColor(236, 236, 236);
+const QColor TraceColor(0, 0, 255);
+const QColor DetectedPeakColor(255, 140, 0);
+
+// 1, 2 or 5 times a power of ten, giving at most maxTicks intervals
+double tickStep(double span, int maxTicks) {
+    const double rough = span / maxTicks;
+    const double magnitude = std::pow(10.0, std::floor(std::log10(rough)));
+    const double normalized = rough / magnitude;
+    if (normalized <= 1.0) return magnitude;
+    if (normalized <= 2.0) return 2.0 * magnitude;
+    if (normalized <= 5.0) return 5.0 * magnitude;
+    return 10.0 * magnitude;
+}
+
+QString tickLabel(double value, double step) {
+    return step >= 1.0 ? QString::number(qRound64(value)) : QString::number(value, 'g', 6);
+}
+
+} // namespace
+
+void PaintTimer::record(qint64 nanoseconds) {
+    durations[next] = nanoseconds;
+    next = (next + 1) % Samples;
+    count = std::min(count + 1, Samples);
+}
+
+double PaintTimer::averageMicroseconds() const {
+    if (count == 0) {
+        return 0.0;
+    }
+    qint64 total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += durations[i];
+    }
+    return static_cast<double>(total) / count / 1000.0;
+}
+
+void TimedChartView::paintEvent(QPaintEvent* event) {
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QChartView::paintEvent(event);
+    timer.record(elapsed.nsecsElapsed());
+}
+
+SpectrumPlotWidget::SpectrumPlotWidget(QWidget* parent) :
+    QWidget(parent)
+{
+    // Every paint covers the whole widget
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    liveTrace.color = TraceColor;
+}
+
+void SpectrumPlotWidget::setTitle(const QString& title) {
+    plotTitle = title;
+    invalidateStaticLayer();
+}
+
+void SpectrumPlotWidget::setAxisTitles(const QString& xTitle, const QString& yTitle) {
+    xAxisTitle = xTitle;
+    yAxisTitle = yTitle;
+    invalidateStaticLayer();
+}
+
+void SpectrumPlotWidget::setXRange(double minimum, double maximum) {
+    if (minimum == xMin && maximum == xMax) return;
+    xMin = minimum;
+    xMax = maximum;
+    invalidateStaticLayer();
+}
+
+void SpectrumPlotWidget::setYRange(double minimum, double maximum) {
+    if (minimum == yMin && maximum == yMax) return;
+    yMin = minimum;
+    yMax = maximum;
+    invalidateStaticLayer();
+}
+
+void SpectrumPlotWidget::setXAxisCalibration(const WavelengthCalibration& calibration, SpectralUnit unit) {
+    axisCalibration = calibration;
+    axisUnit = calibration.supports(unit) ? unit : SpectralUnit::Pixel;
+    invalidateStaticLayer();
+}
+
+void SpectrumPlotWidget::assignTrace(Trace& trace, const QVector<QPointF>& points) {
+    trace.firstX = points.isEmpty() ? 0.0 : points.first().x();
+    trace.values.resize(points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        trace.values[i] = static_cast<float>(points[i].y());
+    }
+}
+
+void SpectrumPlotWidget::setTrace(const QVector<QPointF>& points) {
+    assignTrace(liveTrace, points);
+    update();
+}
+
+void SpectrumPlotWidget::setStoredTraces(const QVector<QVector<QPointF>>& traces) {
+    storedTraces.resize(traces.size());
+    for (qsizetype i = 0; i < traces.size(); ++i) {
+        assignTrace(storedTraces[i], traces[i]);
+
+        // Same colours as the stored chart series
+        QColor color = QColor::fromHsv(static_cast<int>((i + 1) * 60) % 360, 255, 255);
+        color.setAlphaF(0.5);
+        storedTraces[i].color = color;
+    }
+    update();
+}
+
+void SpectrumPlotWidget::setTraceColor(const QColor& color) {
+    liveTrace.color = color;
+    update();
+}
+
+void SpectrumPlotWidget::setOverlayTraces(const QVector<QVector<QPointF>>& traces, const QVector<QColor>& colors) {
+    overlayTraces.resize(traces.size());
+    for (qsizetype i = 0; i < traces.size(); ++i) {
+        assignTrace(overlayTraces[i], traces[i]);
+        overlayTraces[i].color = i < colors.size() ? colors[i] : TraceColor;
+    }
+    update();
+}
+
+void SpectrumPlotWidget::setPeakMarker(double x, double y) {
+    hasPeak = true;
+    peak = QPointF(x, y);
+    update();
+}
+
+void SpectrumPlotWidget::clearPeakMarker() {
+    if (!hasPeak) return;
+    hasPeak = false;
+    update();
+}
+
+void SpectrumPlotWidget::setDetectedPeaks(const std::vector<SpectrumPeak>& peaks) {
+    if (peaks.empty() && detectedPeaks.empty()) return;
+    detectedPeaks.assign(peaks.begin(), peaks.end());
+    update();
+}
+
+void SpectrumPlotWidget::invalidateStaticLayer() {
+    staticLayerValid = false;
+    update();
+}
+
+void SpectrumPlotWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    staticLayerValid = false;
+}
+
+double SpectrumPlotWidget::toScreenX(double x) const {
+    return plotRect.left() + (x - xMin) / (xMax - xMin) * plotRect.width();
+}
+
+double SpectrumPlotWidget::toScreenY(double y) const {
+    return plotRect.bottom() - (y - yMin) / (yMax - yMin) * plotRect.height();
+}
+
+void SpectrumPlotWidget::renderStaticLayer() {
+    const qreal ratio = devicePixelRatioF();
+    staticLayer = QPixmap(size() * ratio);
+    staticLayer.setDevicePixelRatio(ratio);
+    staticLayer.fill(BackgroundColor);
+
+    plotRect = QRectF(LeftMargin, TopMargin,
+                      std::max(1, width() - LeftMargin - RightMargin),
+                      std::max(1, height() - TopMargin - BottomMargin));
+
+    QPainter painter(&staticLayer);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.fillRect(plotRect, PlotAreaColor);
+
+    QFont titleFont("Arial", 12, QFont::Bold);
+    QFont axisTitleFont("Arial", 10);
+    QFont labelFont("Arial", 8);
+    const QFontMetrics labelMetrics(labelFont);
+
+    painter.setPen(TextColor);
+    painter.setFont(titleFont);
+    painter.drawText(QRectF(0, 0, width(), TopMargin), Qt::AlignCenter, plotTitle);
+
+    // Grid lines and tick labels
+    painter.setFont(labelFont);
+    if (xMax > xMin) {
+        // Ticks at round values of the axis unit, which may run either way
+        // across the pixels; each is placed at its pixel from the table
+        const double first = axisCalibration.valueAt(xMin, axisUnit);
+        const double last = axisCalibration.valueAt(xMax, axisUnit);
+        const double lowest = std::min(first, last);
+        const double highest = std::max(first, last);
+        const double step = tickStep(highest - lowest, std::max(2, static_cast<int>(plotRect.width() / 80)));
+        for (double value = std::ceil(lowest / step) * step; value <= highest; value += step) {
+            const double x = axisUnit == SpectralUnit::Pixel ? value : axisCalibration.pixelAt(value, axisUnit);
+            const double screenX = toScreenX(x);
+            painter.setPen(GridColor);
+            painter.drawLine(QPointF(screenX, plotRect.top()), QPointF(screenX, plotRect.bottom()));
+            painter.setPen(TextColor);
+            painter.drawText(QRectF(screenX - 40, plotRect.bottom() + 4, 80, labelMetrics.height()),
+                             Qt::AlignHCenter | Qt::AlignTop, tickLabel(value, step));
+        }
+    }
+    if (yMax > yMin) {
+        const double step = tickStep(yMax - yMin, std::max(2, static_cast<int>(plotRect.height() / 50)));
+        for (double y = std::ceil(yMin / step) * step; y <= yMax; y += step) {
+            const double screenY = toScreenY(y);
+            painter.setPen(GridColor);
+            painter.drawLine(QPointF(plotRect.left(), screenY), QPointF(plotRect.right(), screenY));
+            painter.setPen(TextColor);
+            painter.drawText(QRectF(0, screenY - labelMetrics.height() / 2.0, LeftMargin - 6, labelMetrics.height()),
+                             Qt::AlignRight | Qt::AlignVCenter, tickLabel(y, step));
+        }
+    }
+
+    painter.setPen(TextColor);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(plotRect);
+
+    painter.setFont(axisTitleFont);
+    painter.drawText(QRectF(plotRect.left(), height() - BottomMargin / 2.0, plotRect.width(), BottomMargin / 2.0),
+                     Qt::AlignCenter, xAxisTitle);
+    painter.save();
+    painter.translate(12, plotRect.center().y());
+    painter.rotate(-90);
+    painter.drawText(QRectF(-plotRect.height() / 2.0, -10, plotRect.height(), 20), Qt::AlignCenter, yAxisTitle);
+    painter.restore();
+
+    staticLayerValid = true;
+}
+
+void SpectrumPlotWidget::drawTrace(QPainter& painter, const Trace& trace) {
+    const std::size_t count = trace.values.size();
+    if (count == 0 || xMax <= xMin || yMax <= yMin) return;
+
+    const auto columns = static_cast<std::size_t>(std::max(1.0, std::floor(plotRect.width())));
+    const double visibleSamples = std::min(xMax, trace.firstX + count - 1) - std::max(xMin, trace.firstX) + 1;
+
+    if (visibleSamples > static_cast<double>(columns)) {
+        // One vertical line per column, spanning that column's samples
+        columnMinimums.resize(columns);
+        columnMaximums.resize(columns);
+        decimateMinMax(trace.values.data(), count, trace.firstX, xMin, xMax, columns,
+                       columnMinimums.data(), columnMaximums.data());
+
+        columnLines.clear();
+        const double columnWidth = columns > 1 ? plotRect.width() / static_cast<double>(columns - 1) : 0.0;
+        for (std::size_t column = 0; column < columns; ++column) {
+            if (columnMinimums[column] > columnMaximums[column]) continue;
+            const double x = plotRect.left() + column * columnWidth;
+            const double top = toScreenY(columnMaximums[column]);
+            // Keep flat stretches at least one device pixel tall
+            const double bottom = std::max(toScreenY(columnMinimums[column]), top + 1.0);
+            columnLines.append(QLineF(x, top, x, bottom));
+        }
+        painter.setPen(QPen(trace.color, 1));
+        painter.drawLines(columnLines);
+        return;
+    }
+
+    tracePoints.resize(static_cast<qsizetype>(count));
+    QPointF* points = tracePoints.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i] = QPointF(toScreenX(trace.firstX + i), toScreenY(trace.values[i]));
+    }
+    painter.setPen(QPen(trace.color, trace.width));
+    painter.drawPolyline(points, static_cast<int>(count));
+}
+
+void SpectrumPlotWidget::drawPeakMarker(QPainter& painter) const {
+    if (peak.x() < xMin || peak.x() > xMax) return;
+
+    // Arrow from the top of the plot down to the peak, as on the chart
+    const QPointF tip(toScreenX(peak.x()), toScreenY(peak.y()));
+    constexpr double ArrowWidth = 6.0;
+    constexpr double ArrowHeight = 10.0;
+
+    painter.setPen(QPen(Qt::red, 2));
+    painter.drawLine(QPointF(tip.x(), plotRect.top()), QPointF(tip.x(), tip.y() - ArrowHeight));
+
+    QPainterPath arrow;
+    arrow.moveTo(tip);
+    arrow.lineTo(tip.x() - ArrowWidth, tip.y() - ArrowHeight);
+    arrow.lineTo(tip.x() + ArrowWidth, tip.y() - ArrowHeight);
+    arrow.closeSubpath();
+    painter.fillPath(arrow, Qt::red);
+}
+
+void SpectrumPlotWidget::drawDetectedPeaks(QPainter& painter) const {
+    constexpr double DotRadius = 3.0;
+    constexpr double TickHeight = 4.0;
+
+    painter.setPen(QPen(DetectedPeakColor, 1.5));
+    for (const SpectrumPeak& detected : detectedPeaks) {
+        if (detected.rightHalf < xMin || detected.leftHalf > xMax) continue;
+
+        const double halfY = toScreenY(detected.height - detected.prominence / 2.0);
+        const double left = toScreenX(detected.leftHalf);
+        const double right = toScreenX(detected.rightHalf);
+        painter.drawLine(QPointF(left, halfY), QPointF(right, halfY));
+        painter.drawLine(QPointF(left, halfY - TickHeight), QPointF(left, halfY + TickHeight));
+        painter.drawLine(QPointF(right, halfY - TickHeight), QPointF(right, halfY + TickHeight));
+
+        painter.setBrush(DetectedPeakColor);
+        painter.drawEllipse(QPointF(toScreenX(detected.centre), toScreenY(detected.height)), DotRadius, DotRadius);
+        painter.setBrush(Qt::NoBrush);
+    }
+}
+
+void SpectrumPlotWidget::paintEvent(QPaintEvent*) {
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    if (!staticLayerValid || staticLayer.size() != size() * devicePixelRatioF()) {
+        renderStaticLayer();
+    }
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, staticLayer);
+
+    painter.setClipRect(plotRect);
+    for (const Trace& stored : storedTraces) {
+        drawTrace(painter, stored);
+    }
+    for (const Trace& overlay : overlayTraces) {
+        drawTrace(painter, overlay);
+    }
+    drawTrace(painter, liveTrace);
+    drawDetectedPeaks(painter);
+    if (hasPeak) {
+        drawPeakMarker(painter);
+    }
+    painter.end();
+
+    timer.record(elapsed.nsecsElapsed());
+}
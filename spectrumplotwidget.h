@@ -0,0 +1,134 @@
+#ifndef SPECTRUMPLOTWIDGET_H
+#define SPECTRUMPLOTWIDGET_H
+
+#include <QtCharts/QChartView>
+#include <QColor>
+#include <QLineF>
+#include <QPixmap>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include <array>
+#include <vector>
+#include "peakdetection.h"
+#include "wavelengthcalibration.h"
+
+// Rolling mean of paint durations, so the two plot renderers can be compared
+class PaintTimer
+{
+public:
+    void record(qint64 nanoseconds);
+    double averageMicroseconds() const;
+    int sampleCount() const { return count; }
+
+private:
+    static constexpr int Samples = 120;
+    std::array<qint64, Samples> durations{};
+    int next = 0;
+    int count = 0;
+};
+
+// QChartView that times its own paints
+class TimedChartView final : public QChartView
+{
+public:
+    using QChartView::QChartView;
+
+    const PaintTimer& paintTimer() const { return timer; }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    PaintTimer timer;
+};
+
+// Raster spectrum plot for the live view. Background, grid, tick labels and
+// titles only change with the axis ranges or the widget size, so they are
+// rendered once into a cached pixmap; a frame only blits that pixmap and
+// draws the traces on top. Traces with more samples than the plot has
+// columns are drawn as one min/max line per column. Painting goes through
+// QPainter on the widget's backing store, so it needs no OpenGL.
+class SpectrumPlotWidget final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumPlotWidget(QWidget* parent = nullptr);
+
+    void setTitle(const QString& title);
+    void setAxisTitles(const QString& xTitle, const QString& yTitle);
+
+    // Changing a range re-renders the cached axes; setting the same one is free
+    void setXRange(double minimum, double maximum);
+    void setYRange(double minimum, double maximum);
+    // The x range and traces stay in pixels; the ticks are placed at round
+    // values of `unit`, found in the calibration's table
+    void setXAxisCalibration(const WavelengthCalibration& calibration, SpectralUnit unit);
+
+    // Points are expected at consecutive pixels, as the live view produces them
+    void setTrace(const QVector<QPointF>& points);
+    void setStoredTraces(const QVector<QVector<QPointF>>& traces);
+    void setTraceColor(const QColor& color);
+    // Further live traces drawn under the main one, one colour each
+    void setOverlayTraces(const QVector<QVector<QPointF>>& traces, const QVector<QColor>& colors);
+    void setPeakMarker(double x, double y);
+    void clearPeakMarker();
+    // A dot on each detected peak's centre and a bar across its FWHM
+    void setDetectedPeaks(const std::vector<SpectrumPeak>& peaks);
+
+    const PaintTimer& paintTimer() const { return timer; }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    struct Trace {
+        double firstX = 0.0;
+        std::vector<float> values;
+        QColor color;
+        qreal width = 2.0;
+    };
+
+    static void assignTrace(Trace& trace, const QVector<QPointF>& points);
+    void invalidateStaticLayer();
+    void renderStaticLayer();
+    void drawTrace(QPainter& painter, const Trace& trace);
+    void drawPeakMarker(QPainter& painter) const;
+    void drawDetectedPeaks(QPainter& painter) const;
+    double toScreenX(double x) const;
+    double toScreenY(double y) const;
+
+    QString plotTitle;
+    QString xAxisTitle;
+    QString yAxisTitle;
+    double xMin = 0.0;
+    double xMax = 1023.0;
+    double yMin = 0.0;
+    double yMax = 65535.0;
+    WavelengthCalibration axisCalibration;
+    SpectralUnit axisUnit = SpectralUnit::Pixel;
+
+    Trace liveTrace;
+    std::vector<Trace> storedTraces;
+    std::vector<Trace> overlayTraces;
+    bool hasPeak = false;
+    QPointF peak;
+    std::vector<SpectrumPeak> detectedPeaks;
+
+    QPixmap staticLayer;
+    bool staticLayerValid = false;
+    QRectF plotRect;
+
+    // Reused between frames
+    std::vector<float> columnMinimums;
+    std::vector<float> columnMaximums;
+    QVector<QLineF> columnLines;
+    QVector<QPointF> tracePoints;
+
+    PaintTimer timer;
+};
+
+#endif // SPECTRUMPLOTWIDGET_H
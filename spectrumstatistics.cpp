@@ -0,0 +1,223 @@
+#include "spectrumstatistics.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "simdsupport.h"
+
+namespace {
+
+constexpr std::size_t BlockSize = 16;
+
+// Running state of the single pass. Each block's sum and squared deviations
+// are exact and cheap to vectorise; blocks are then folded into the running
+// mean and M2 with the pairwise form of Welford's update (Chan et al.).
+struct Accumulator {
+    double mean = 0.0;
+    double m2 = 0.0;
+    std::size_t seen = 0;
+    float minimum = 0.0f;
+    float peak = 0.0f;
+    std::size_t peakBlock = 0;
+
+    void addBlock(double blockSum, double blockM2, std::size_t length) {
+        const std::size_t total = seen + length;
+        const double blockMean = length == BlockSize ? blockSum * (1.0 / BlockSize) : blockSum / static_cast<double>(length);
+        const double delta = blockMean - mean;
+        mean += delta * static_cast<double>(length) / static_cast<double>(total);
+        m2 += blockM2 + delta * delta * static_cast<double>(seen) * static_cast<double>(length) / static_cast<double>(total);
+        seen = total;
+    }
+};
+
+template <typename T>
+void accumulateScalar(const T* block, std::size_t start, std::size_t length, Accumulator& state) {
+    double blockSum = 0.0;
+    float blockPeak = static_cast<float>(block[0]);
+    for (std::size_t i = 0; i < length; ++i) {
+        const auto value = static_cast<float>(block[i]);
+        blockSum += value;
+        state.minimum = std::min(state.minimum, value);
+        blockPeak = std::max(blockPeak, value);
+    }
+    const double blockMean = blockSum / static_cast<double>(length);
+    double blockM2 = 0.0;
+    for (std::size_t i = 0; i < length; ++i) {
+        const double deviation = static_cast<double>(block[i]) - blockMean;
+        blockM2 += deviation * deviation;
+    }
+    if (blockPeak > state.peak) {
+        state.peak = blockPeak;
+        state.peakBlock = start;
+    }
+    state.addBlock(blockSum, blockM2, length);
+}
+
+#ifdef LSV_SIMD_SSE2
+inline float horizontalSum(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+
+inline float horizontalMax(__m128 v) {
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+
+inline void loadBlock(const float* values, __m128 (&v)[4]) {
+    for (int k = 0; k < 4; ++k) {
+        v[k] = _mm_loadu_ps(values + 4 * k);
+    }
+}
+
+inline void loadBlock(const uint16_t* samples, __m128 (&v)[4]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples));
+    const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 8));
+    v[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(first, zero));
+    v[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(first, zero));
+    v[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(second, zero));
+    v[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(second, zero));
+}
+
+// Whole blocks of 16 values in single precision; a block sum of 16 samples
+// is exact and block deviations are small, so nothing is lost before the
+// merge in double precision. Returns how many values were consumed.
+template <typename T>
+std::size_t accumulateSse2(const T* values, std::size_t count, Accumulator& state) {
+    __m128 low = _mm_set1_ps(state.minimum);
+    std::size_t start = 0;
+    for (; start + BlockSize <= count; start += BlockSize) {
+        __m128 v[4];
+        loadBlock(values + start, v);
+
+        low = _mm_min_ps(low, _mm_min_ps(_mm_min_ps(v[0], v[1]), _mm_min_ps(v[2], v[3])));
+        const float blockPeak = horizontalMax(_mm_max_ps(_mm_max_ps(v[0], v[1]), _mm_max_ps(v[2], v[3])));
+        if (blockPeak > state.peak) {
+            state.peak = blockPeak;
+            state.peakBlock = start;
+        }
+
+        const float blockSum = horizontalSum(_mm_add_ps(_mm_add_ps(v[0], v[1]), _mm_add_ps(v[2], v[3])));
+        const __m128 blockMean = _mm_set1_ps(blockSum / static_cast<float>(BlockSize));
+        __m128 squares = _mm_setzero_ps();
+        for (int k = 0; k < 4; ++k) {
+            const __m128 deviation = _mm_sub_ps(v[k], blockMean);
+            squares = _mm_add_ps(squares, _mm_mul_ps(deviation, deviation));
+        }
+        state.addBlock(blockSum, horizontalSum(squares), BlockSize);
+    }
+
+    alignas(16) float lows[4];
+    _mm_store_ps(lows, low);
+    state.minimum = *std::min_element(lows, lows + 4);
+    return start;
+}
+#endif
+
+template <typename T>
+void accumulate(const T* values, std::size_t count, int firstPixel, SpectrumStatistics& stats) {
+    Accumulator state;
+    state.minimum = static_cast<float>(values[0]);
+    state.peak = static_cast<float>(values[0]);
+
+    std::size_t start = 0;
+#ifdef LSV_SIMD_SSE2
+    start = accumulateSse2(values, count, state);
+#endif
+    for (; start < count; start += BlockSize) {
+        accumulateScalar(values + start, start, std::min(BlockSize, count - start), state);
+    }
+
+    // The peak pixel is the first one in the winning block to reach the peak
+    std::size_t peakIndex = state.peakBlock;
+    while (static_cast<float>(values[peakIndex]) != state.peak) {
+        ++peakIndex;
+    }
+
+    stats.count = count;
+    stats.peakPixel = firstPixel + static_cast<int>(peakIndex);
+    stats.peakValue = state.peak;
+    stats.minimum = state.minimum;
+    stats.maximum = state.peak;
+    stats.mean = state.mean;
+    stats.variance = state.m2 / static_cast<double>(count);
+    stats.stdDev = std::sqrt(stats.variance);
+}
+
+double medianBySelection(const float* values, std::size_t count) {
+    thread_local std::vector<float> scratch;
+    scratch.assign(values, values + count);
+
+    const auto upper = scratch.begin() + static_cast<std::ptrdiff_t>(count / 2);
+    std::nth_element(scratch.begin(), upper, scratch.end());
+    if (count % 2 != 0) {
+        return *upper;
+    }
+    // nth_element leaves the lower half below the upper middle value
+    const float lower = *std::max_element(scratch.begin(), upper);
+    return (static_cast<double>(lower) + *upper) / 2.0;
+}
+
+// Median of raw samples: count the high bytes to find the bucket(s)
+// holding the middle rank(s), then count the low bytes within them
+double medianOfSamples(const uint16_t* samples, std::size_t count) {
+    std::array<uint32_t, 256> high{};
+    for (std::size_t i = 0; i < count; ++i) {
+        ++high[samples[i] >> 8];
+    }
+
+    // Both middle ranks usually share a bucket, so its low-byte histogram is
+    // only built once
+    std::array<uint32_t, 256> low{};
+    unsigned lowBucket = 256;
+    const auto valueOfRank = [&](std::size_t rank) {
+        unsigned bucket = 0;
+        while (rank >= high[bucket]) {
+            rank -= high[bucket];
+            ++bucket;
+        }
+        if (bucket != lowBucket) {
+            low.fill(0);
+            for (std::size_t i = 0; i < count; ++i) {
+                if ((samples[i] >> 8) == bucket) {
+                    ++low[samples[i] & 0xFF];
+                }
+            }
+            lowBucket = bucket;
+        }
+        unsigned value = 0;
+        while (rank >= low[value]) {
+            rank -= low[value];
+            ++value;
+        }
+        return static_cast<double>((bucket << 8) | value);
+    };
+
+    const double upper = valueOfRank(count / 2);
+    return count % 2 != 0 ? upper : (valueOfRank(count / 2 - 1) + upper) / 2.0;
+}
+
+} // namespace
+
+SpectrumStatistics computeStatistics(const float* values, std::size_t count, int firstPixel) {
+    SpectrumStatistics stats;
+    if (count == 0) {
+        return stats;
+    }
+    accumulate(values, count, firstPixel, stats);
+    stats.median = medianBySelection(values, count);
+    return stats;
+}
+
+SpectrumStatistics computeStatistics(const uint16_t* samples, std::size_t count, int firstPixel) {
+    SpectrumStatistics stats;
+    if (count == 0) {
+        return stats;
+    }
+    accumulate(samples, count, firstPixel, stats);
+    stats.median = medianOfSamples(samples, count);
+    return stats;
+}
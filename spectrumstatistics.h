@@ -0,0 +1,31 @@
+#ifndef SPECTRUMSTATISTICS_H
+#define SPECTRUMSTATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Everything the live labels, peak marker and auto-range need from one
+// spectrum. Variance is the population variance.
+struct SpectrumStatistics {
+    std::size_t count = 0;
+    int peakPixel = 0;
+    double peakValue = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    double mean = 0.0;
+    double variance = 0.0;
+    double stdDev = 0.0;
+    double median = 0.0;
+};
+
+// Peak, range, mean and variance come from a single pass (Welford's update,
+// merged per block of values so there is one division per block rather than
+// per value); the median comes from a selection instead of a sort. values[0]
+// belongs to pixel firstPixel.
+SpectrumStatistics computeStatistics(const float* values, std::size_t count, int firstPixel = 0);
+
+// Same for raw samples, with the median read from a two-level 8-bit
+// histogram in O(n)
+SpectrumStatistics computeStatistics(const uint16_t* samples, std::size_t count, int firstPixel = 0);
+
+#endif // SPECTRUMSTATISTICS_H
@@ -0,0 +1,110 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Slots are preallocated, so pushing and popping never allocate.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t minCapacity)
+    {
+        std::size_t capacity = 2;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        slots.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side: returns the next free slot to fill in place, or nullptr
+    // when the queue is full. The slot becomes visible on commitPush().
+    T* beginPush()
+    {
+        const std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - cachedHead > mask) {
+            cachedHead = headIndex.load(std::memory_order_acquire);
+            if (tail - cachedHead > mask) {
+                return nullptr;
+            }
+        }
+        return &slots[tail & mask];
+    }
+
+    void commitPush()
+    {
+        tailIndex.store(tailIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPush(const T& value)
+    {
+        T* slot = beginPush();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = value;
+        commitPush();
+        return true;
+    }
+
+    // Consumer side: returns the oldest filled slot, or nullptr when empty.
+    // The slot stays valid until popFront().
+    T* front()
+    {
+        const std::size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tailIndex.load(std::memory_order_acquire);
+            if (head == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[head & mask];
+    }
+
+    void popFront()
+    {
+        headIndex.store(headIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPop(T& value)
+    {
+        T* slot = front();
+        if (slot == nullptr) {
+            return false;
+        }
+        value = *slot;
+        popFront();
+        return true;
+    }
+
+    // Approximate when called concurrently; exact from either side when the
+    // other thread is idle.
+    std::size_t size() const
+    {
+        return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr std::size_t CacheLineSize = 64;
+
+    std::vector<T> slots;
+    std::size_t mask = 0;
+
+    // Producer and consumer indices live on separate cache lines, each next
+    // to the side's cached copy of the other index.
+    alignas(CacheLineSize) std::atomic<std::size_t> tailIndex{0};
+    std::size_t cachedHead = 0;
+    alignas(CacheLineSize) std::atomic<std::size_t> headIndex{0};
+    std::size_t cachedTail = 0;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,77 @@
+#include "tracedecimation.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SampleSpan visibleSamples(std::size_t count, double firstX, double xMin, double xMax) {
+    if (count == 0 || xMax < xMin) {
+        return {};
+    }
+    const double firstVisible = std::max(0.0, std::ceil(xMin - firstX));
+    const double lastVisible = std::min(static_cast<double>(count - 1), std::floor(xMax - firstX));
+    if (lastVisible < firstVisible) {
+        return {};
+    }
+    const auto first = static_cast<std::size_t>(firstVisible);
+    return {first, static_cast<std::size_t>(lastVisible) - first + 1};
+}
+
+void decimateMinMax(const float* values, std::size_t count, double firstX,
+                    double xMin, double xMax, std::size_t columns,
+                    float* minimums, float* maximums) {
+    std::fill(minimums, minimums + columns, std::numeric_limits<float>::max());
+    std::fill(maximums, maximums + columns, std::numeric_limits<float>::lowest());
+    if (columns == 0 || count == 0 || xMax <= xMin) {
+        return;
+    }
+
+    // Only the samples inside [xMin, xMax] are visited
+    const SampleSpan visible = visibleSamples(count, firstX, xMin, xMax);
+    if (visible.count == 0) {
+        return;
+    }
+    const std::size_t first = visible.first;
+    const std::size_t last = visible.first + visible.count - 1;
+
+    // Samples map to columns in order, so keep the running extent of the
+    // current column in registers and store it when the column changes
+    const double scale = static_cast<double>(columns - 1) / (xMax - xMin);
+    const double offset = (firstX - xMin) * scale + 0.5;
+    std::size_t column = static_cast<std::size_t>(offset + static_cast<double>(first) * scale);
+    float minimum = values[first];
+    float maximum = values[first];
+    for (std::size_t i = first + 1; i <= last; ++i) {
+        const auto next = static_cast<std::size_t>(offset + static_cast<double>(i) * scale);
+        if (next != column) {
+            minimums[column] = minimum;
+            maximums[column] = maximum;
+            column = next;
+            minimum = values[i];
+            maximum = values[i];
+        } else {
+            minimum = std::min(minimum, values[i]);
+            maximum = std::max(maximum, values[i]);
+        }
+    }
+    minimums[column] = minimum;
+    maximums[column] = maximum;
+
+    // Join each column to the samples of the previous non-empty one
+    bool havePrevious = false;
+    float previousMinimum = 0.0f;
+    float previousMaximum = 0.0f;
+    for (std::size_t column = 0; column < columns; ++column) {
+        const float minimum = minimums[column];
+        const float maximum = maximums[column];
+        if (minimum > maximum) {
+            continue;
+        }
+        if (havePrevious) {
+            minimums[column] = std::min(minimum, previousMaximum);
+            maximums[column] = std::max(maximum, previousMinimum);
+        }
+        havePrevious = true;
+        previousMinimum = minimum;
+        previousMaximum = maximum;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef TRACEDECIMATION_H
+#define TRACEDECIMATION_H
+
+#include <cstddef>
+
+// Samples of a trace at x = firstX + i that lie within [xMin, xMax]: a
+// contiguous run, found arithmetically instead of by testing every sample
+struct SampleSpan {
+    std::size_t first = 0;
+    std::size_t count = 0;
+};
+
+SampleSpan visibleSamples(std::size_t count, double firstX, double xMin, double xMax);
+
+// Reduces a trace to one vertical extent per screen column, for drawing
+// more samples than there are columns. Sample i sits at x = firstX + i and
+// the columns span [xMin, xMax]; a column receives the minimum and maximum
+// of the samples that fall into it, widened to meet its left neighbour so
+// the drawn extents join into a continuous line. Columns without samples
+// are left with minimum > maximum.
+void decimateMinMax(const float* values, std::size_t count, double firstX,
+                    double xMin, double xMax, std::size_t columns,
+                    float* minimums, float* maximums);
+
+#endif // TRACEDECIMATION_H
@@ -0,0 +1,104 @@
+#include "waterfallimage.h"
+#include <algorithm>
+
+namespace {
+
+// Dark blue through magenta and orange to pale yellow, so intensity reads
+// as brightness
+struct ColorStop {
+    double position;
+    double red;
+    double green;
+    double blue;
+};
+
+constexpr ColorStop ColorMap[] = {
+    {0.00, 0, 0, 4},
+    {0.25, 87, 16, 110},
+    {0.50, 188, 55, 84},
+    {0.75, 249, 142, 9},
+    {1.00, 252, 255, 164},
+};
+
+uint32_t mapColor(double t) {
+    std::size_t stop = 1;
+    while (stop + 1 < std::size(ColorMap) && ColorMap[stop].position < t) {
+        ++stop;
+    }
+    const ColorStop& low = ColorMap[stop - 1];
+    const ColorStop& high = ColorMap[stop];
+    const double f = (t - low.position) / (high.position - low.position);
+    const auto channel = [f](double a, double b) {
+        return static_cast<uint32_t>(a + (b - a) * f + 0.5);
+    };
+    return 0xFF000000u | channel(low.red, high.red) << 16 | channel(low.green, high.green) << 8 |
+           channel(low.blue, high.blue);
+}
+
+} // namespace
+
+WaterfallImage::WaterfallImage(std::size_t depth) {
+    buildColors();
+    setDepth(depth);
+}
+
+void WaterfallImage::setDepth(std::size_t depth) {
+    rows = std::clamp<std::size_t>(depth, 1, MaxDepth);
+    image.assign(rows * Width, colors[0]);
+    image.shrink_to_fit();
+    head = 0;
+    filledRows = 0;
+}
+
+void WaterfallImage::clear() {
+    std::fill(image.begin(), image.end(), colors[0]);
+    head = 0;
+    filledRows = 0;
+}
+
+bool WaterfallImage::setLevels(uint16_t blackLevel, uint16_t whiteLevel) {
+    if (whiteLevel <= blackLevel) {
+        whiteLevel = blackLevel == 65535 ? 65535 : blackLevel + 1;
+        blackLevel = whiteLevel - 1;
+    }
+    if (blackLevel == black && whiteLevel == white) {
+        return false;
+    }
+    black = blackLevel;
+    white = whiteLevel;
+    buildColors();
+    return true;
+}
+
+void WaterfallImage::buildColors() {
+    // Sample the colour map once, then index it per sample value
+    constexpr uint32_t Steps = 1024;
+    std::array<uint32_t, Steps> gradient;
+    for (uint32_t step = 0; step < Steps; ++step) {
+        gradient[step] = mapColor(static_cast<double>(step) / (Steps - 1));
+    }
+
+    // (sample - black) * (Steps - 1) / span in 32.32 fixed point
+    const uint64_t scale = (uint64_t{Steps - 1} << 32) / (static_cast<uint32_t>(white) - black);
+    std::fill(colors.begin(), colors.begin() + black + 1, gradient.front());
+    for (uint32_t sample = black + 1u; sample < white; ++sample) {
+        colors[sample] = gradient[((sample - black) * scale) >> 32];
+    }
+    std::fill(colors.begin() + white, colors.end(), gradient.back());
+}
+
+void WaterfallImage::addFrame(const uint16_t* pixels, const uint16_t* background) {
+    head = (head + rows - 1) % rows;
+    filledRows = std::min(filledRows + 1, rows);
+
+    uint32_t* row = image.data() + head * Width;
+    if (background == nullptr) {
+        for (std::size_t i = 0; i < Width; ++i) {
+            row[i] = colors[pixels[i]];
+        }
+    } else {
+        for (std::size_t i = 0; i < Width; ++i) {
+            row[i] = colors[pixels[i] > background[i] ? pixels[i] - background[i] : 0];
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef WATERFALLIMAGE_H
+#define WATERFALLIMAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "spectrumframe.h"
+
+// History of frames as colour-mapped rows of a fixed-size 32-bit RGB
+// image, for a waterfall display. Rows form a ring: each frame overwrites
+// the oldest row through a 65536-entry colour table, so adding a frame
+// writes one row and nothing is ever shifted. Rows are written towards
+// lower addresses, so from newestRow() to the end of the image and then
+// from row 0 they run newest to oldest, and a viewer draws the image in
+// two pieces without copying it.
+class WaterfallImage
+{
+public:
+    static constexpr std::size_t Width = SpectrumFrame::PixelCount;
+    static constexpr std::size_t MaxDepth = 8192;
+
+    explicit WaterfallImage(std::size_t depth = 600);
+
+    // Discards the history
+    void setDepth(std::size_t depth);
+    std::size_t depth() const { return rows; }
+
+    // Samples at or below black map to the first colour of the colour map,
+    // at or above white to the last one; returns true if the table changed
+    bool setLevels(uint16_t black, uint16_t white);
+    uint16_t blackLevel() const { return black; }
+    uint16_t whiteLevel() const { return white; }
+
+    // Background, if given, is subtracted from the samples first
+    void addFrame(const uint16_t* pixels, const uint16_t* background = nullptr);
+    void clear();
+
+    // Image rows of Width pixels each, 0xFFRRGGBB
+    const uint32_t* data() const { return image.data(); }
+    std::size_t bytesPerLine() const { return Width * sizeof(uint32_t); }
+
+    // Rows holding frames, and the row of the newest one
+    std::size_t rowCount() const { return filledRows; }
+    std::size_t newestRow() const { return head; }
+
+    uint32_t colorOf(uint16_t sample) const { return colors[sample]; }
+
+private:
+    void buildColors();
+
+    std::vector<uint32_t> image;
+    std::array<uint32_t, 65536> colors{};
+    std::size_t rows = 0;
+    std::size_t head = 0;
+    std::size_t filledRows = 0;
+    uint16_t black = 0;
+    uint16_t white = 65535;
+};
+
+#endif // WATERFALLIMAGE_H
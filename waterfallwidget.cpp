@@ -0,0 +1,47 @@
+#include "waterfallwidget.h"
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+
+WaterfallWidget::WaterfallWidget(const WaterfallImage& image, QWidget* parent) :
+    QWidget(parent),
+    waterfall(image)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void WaterfallWidget::setXRange(int minimum, int maximum) {
+    const int last = static_cast<int>(WaterfallImage::Width) - 1;
+    xMin = std::clamp(minimum, 0, last);
+    xMax = std::clamp(maximum, xMin, last);
+    update();
+}
+
+void WaterfallWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(24, 24, 24));
+
+    const int depth = static_cast<int>(waterfall.depth());
+    const int filled = static_cast<int>(waterfall.rowCount());
+    if (filled == 0) return;
+
+    // Read-only view of the ring; QImage does not copy const data
+    const QImage image(reinterpret_cast<const uchar*>(waterfall.data()),
+                       static_cast<int>(WaterfallImage::Width), depth,
+                       static_cast<qsizetype>(waterfall.bytesPerLine()), QImage::Format_RGB32);
+
+    // The whole history depth spans the height, so rows keep their size as
+    // the history fills up
+    const double rowHeight = static_cast<double>(height()) / depth;
+    const int columns = xMax - xMin + 1;
+
+    // Newest row to the end of the image, then the rows wrapped to the start
+    const int head = static_cast<int>(waterfall.newestRow());
+    const int firstPart = std::min(filled, depth - head);
+    painter.drawImage(QRectF(0, 0, width(), firstPart * rowHeight), image,
+                      QRectF(xMin, head, columns, firstPart));
+    if (filled > firstPart) {
+        painter.drawImage(QRectF(0, firstPart * rowHeight, width(), (filled - firstPart) * rowHeight), image,
+                          QRectF(xMin, 0, columns, filled - firstPart));
+    }
+}
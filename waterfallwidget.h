@@ -0,0 +1,29 @@
+#ifndef WATERFALLWIDGET_H
+#define WATERFALLWIDGET_H
+
+#include <QWidget>
+#include "waterfallimage.h"
+
+// Shows a WaterfallImage, newest frame at the top. The image memory is
+// wrapped rather than copied, and the ring is drawn as two blits split at
+// the newest row, so a paint costs the same whatever the history depth.
+class WaterfallWidget final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit WaterfallWidget(const WaterfallImage& image, QWidget* parent = nullptr);
+
+    // Pixel range shown across the width, matching the spectrum plot
+    void setXRange(int minimum, int maximum);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    const WaterfallImage& waterfall;
+    int xMin = 0;
+    int xMax = static_cast<int>(WaterfallImage::Width) - 1;
+};
+
+#endif // WATERFALLWIDGET_H
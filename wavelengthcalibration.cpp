@@ -0,0 +1,264 @@
+#include "wavelengthcalibration.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr int PixelCount = SpectrumFrame::PixelCount;
+
+// Profile keys written by this module
+const char* const CoefficientsKey = "wavelength_coefficients";
+const char* const LaserKey = "laser_wavelength";
+
+// cm^-1 per nm^-1
+constexpr double WavenumberScale = 1.0e7;
+
+} // namespace
+
+const char* spectralUnitTitle(SpectralUnit unit) {
+    switch (unit) {
+    case SpectralUnit::Wavelength: return "Wavelength (nm)";
+    case SpectralUnit::RamanShift: return "Raman Shift (cm-1)";
+    case SpectralUnit::Pixel: break;
+    }
+    return "Pixel";
+}
+
+const char* spectralUnitSymbol(SpectralUnit unit) {
+    switch (unit) {
+    case SpectralUnit::Wavelength: return "nm";
+    case SpectralUnit::RamanShift: return "cm-1";
+    case SpectralUnit::Pixel: break;
+    }
+    return "px";
+}
+
+const char* spectralUnitKey(SpectralUnit unit) {
+    switch (unit) {
+    case SpectralUnit::Wavelength: return "wavelength";
+    case SpectralUnit::RamanShift: return "ramanShift";
+    case SpectralUnit::Pixel: break;
+    }
+    return "pixel";
+}
+
+WavelengthCalibration::WavelengthCalibration() {
+    for (int pixel = 0; pixel < PixelCount; ++pixel) {
+        pixelTable[pixel] = pixel;
+    }
+}
+
+void WavelengthCalibration::setCoefficients(const std::vector<double>& coefficients) {
+    if (coefficients.empty()) {
+        clear();
+        return;
+    }
+
+    // Horner's rule, once per pixel; everything after this is table lookups
+    Table wavelengths;
+    for (int pixel = 0; pixel < PixelCount; ++pixel) {
+        double value = 0.0;
+        for (auto c = coefficients.rbegin(); c != coefficients.rend(); ++c) {
+            value = value * pixel + *c;
+        }
+        if (!std::isfinite(value) || value <= 0.0) {
+            throw std::runtime_error("The calibration gives no valid wavelength at pixel " + std::to_string(pixel));
+        }
+        wavelengths[pixel] = value;
+    }
+    const bool descending = wavelengths[PixelCount - 1] < wavelengths[0];
+    for (int pixel = 1; pixel < PixelCount; ++pixel) {
+        if (descending ? wavelengths[pixel] >= wavelengths[pixel - 1] : wavelengths[pixel] <= wavelengths[pixel - 1]) {
+            throw std::runtime_error("The calibration is not monotonic over the sensor (turns at pixel "
+                                     + std::to_string(pixel) + ")");
+        }
+    }
+
+    polynomial = coefficients;
+    wavelengthTable = wavelengths;
+    rebuildRamanTable();
+}
+
+void WavelengthCalibration::clear() {
+    polynomial.clear();
+    wavelengthTable.fill(0.0);
+    ramanTable.fill(0.0);
+}
+
+void WavelengthCalibration::setLaserWavelength(double nanometres) {
+    if (!std::isfinite(nanometres) || nanometres < 0.0) {
+        throw std::runtime_error("Invalid laser wavelength");
+    }
+    laserNanometres = nanometres;
+    rebuildRamanTable();
+}
+
+void WavelengthCalibration::rebuildRamanTable() {
+    if (!supports(SpectralUnit::RamanShift)) {
+        ramanTable.fill(0.0);
+        return;
+    }
+    // Follows the wavelength table's direction, so it stays monotonic
+    const double laserWavenumber = WavenumberScale / laserNanometres;
+    for (int pixel = 0; pixel < PixelCount; ++pixel) {
+        ramanTable[pixel] = laserWavenumber - WavenumberScale / wavelengthTable[pixel];
+    }
+}
+
+bool WavelengthCalibration::supports(SpectralUnit unit) const {
+    switch (unit) {
+    case SpectralUnit::Pixel: return true;
+    case SpectralUnit::Wavelength: return isCalibrated();
+    case SpectralUnit::RamanShift: return isCalibrated() && laserNanometres > 0.0;
+    }
+    return false;
+}
+
+const WavelengthCalibration::Table& WavelengthCalibration::tableFor(SpectralUnit unit) const {
+    if (!supports(unit)) {
+        return pixelTable;
+    }
+    switch (unit) {
+    case SpectralUnit::Wavelength: return wavelengthTable;
+    case SpectralUnit::RamanShift: return ramanTable;
+    case SpectralUnit::Pixel: break;
+    }
+    return pixelTable;
+}
+
+const double* WavelengthCalibration::table(SpectralUnit unit) const {
+    return tableFor(unit).data();
+}
+
+double WavelengthCalibration::valueAt(int pixel, SpectralUnit unit) const {
+    return tableFor(unit)[std::clamp(pixel, 0, PixelCount - 1)];
+}
+
+double WavelengthCalibration::valueAt(double pixel, SpectralUnit unit) const {
+    const Table& values = tableFor(unit);
+    const int index = std::clamp(static_cast<int>(std::floor(pixel)), 0, PixelCount - 2);
+    return values[index] + (values[index + 1] - values[index]) * (pixel - index);
+}
+
+bool WavelengthCalibration::isDescending(SpectralUnit unit) const {
+    const Table& values = tableFor(unit);
+    return values[PixelCount - 1] < values[0];
+}
+
+double WavelengthCalibration::pixelAt(double value, SpectralUnit unit) const {
+    const Table& values = tableFor(unit);
+    const bool descending = isDescending(unit);
+
+    // First entry at or past the value in the table's own direction
+    const auto past = descending
+        ? std::lower_bound(values.begin(), values.end(), value, std::greater<double>())
+        : std::lower_bound(values.begin(), values.end(), value);
+    if (past == values.begin()) {
+        return 0.0;
+    }
+    if (past == values.end()) {
+        return PixelCount - 1;
+    }
+    const auto index = static_cast<int>(past - values.begin());
+    const double before = values[index - 1];
+    return (index - 1) + (value - before) / (values[index] - before);
+}
+
+std::filesystem::path deviceProfilePath(const std::filesystem::path& directory, const std::string& serialNumber) {
+    return directory / (serialNumber + ".profile");
+}
+
+WavelengthCalibration loadWavelengthCalibration(const std::filesystem::path& path) {
+    WavelengthCalibration calibration;
+    std::ifstream file(path);
+    if (!file) {
+        if (std::filesystem::exists(path)) {
+            throw std::runtime_error("Cannot open " + path.string());
+        }
+        return calibration;
+    }
+
+    std::vector<double> coefficients;
+    double laser = 0.0;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key) || key[0] == '#') {
+            continue;
+        }
+        if (key == CoefficientsKey) {
+            coefficients.clear();
+            for (double coefficient; fields >> coefficient;) {
+                coefficients.push_back(coefficient);
+            }
+        } else if (key == LaserKey) {
+            fields >> laser;
+        } else {
+            continue;
+        }
+        if (fields.fail() && !fields.eof()) {
+            throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": invalid value for " + key);
+        }
+    }
+
+    try {
+        calibration.setCoefficients(coefficients);
+        calibration.setLaserWavelength(laser);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(path.string() + ": " + e.what());
+    }
+    return calibration;
+}
+
+void saveWavelengthCalibration(const std::filesystem::path& path, const std::string& serialNumber,
+                               const WavelengthCalibration& calibration) {
+    // Lines of other settings in the profile are kept as they are
+    std::vector<std::string> otherLines;
+    if (std::ifstream existing(path); existing) {
+        std::string line;
+        while (std::getline(existing, line)) {
+            std::istringstream fields(line);
+            std::string key;
+            fields >> key;
+            if (key != CoefficientsKey && key != LaserKey && key != "serial" && !line.empty() && line[0] != '#') {
+                otherLines.push_back(line);
+            }
+        }
+    }
+
+    if (path.has_parent_path()) {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+    file << "# LaserSpectraVue device profile\n";
+    file << "serial " << serialNumber << '\n';
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+    if (calibration.isCalibrated()) {
+        file << CoefficientsKey;
+        for (double coefficient : calibration.coefficients()) {
+            file << ' ' << coefficient;
+        }
+        file << '\n';
+    }
+    if (calibration.laserWavelength() > 0.0) {
+        file << LaserKey << ' ' << calibration.laserWavelength() << '\n';
+    }
+    for (const std::string& line : otherLines) {
+        file << line << '\n';
+    }
+    file.flush();
+    if (!file) {
+        throw std::runtime_error("Writing " + path.string() + " failed");
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef WAVELENGTHCALIBRATION_H
+#define WAVELENGTHCALIBRATION_H
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "spectrumframe.h"
+
+// Units the spectral axis can be shown in. Raman shift is in cm^-1 relative
+// to the laser line and needs a wavelength calibration as well.
+enum class SpectralUnit { Pixel, Wavelength, RamanShift };
+
+const char* spectralUnitTitle(SpectralUnit unit);   // "Wavelength (nm)"
+const char* spectralUnitSymbol(SpectralUnit unit);  // "nm"
+const char* spectralUnitKey(SpectralUnit unit);     // "wavelength", for JSON keys and file names
+
+// Pixel-to-wavelength calibration of one spectrometer head. The polynomial
+// is expanded once into a table holding every pixel's value in each unit, so
+// drawing, exporting and reporting in nm or cm^-1 costs a lookup per pixel
+// and never evaluates the polynomial per frame. Fractional pixels, such as
+// peak centres, are interpolated between neighbouring table entries; values
+// map back to pixels by binary search, which works because the calibration
+// has to be monotonic over the sensor. Uncalibrated, every unit but Pixel is
+// unavailable.
+class WavelengthCalibration
+{
+public:
+    WavelengthCalibration();
+
+    // lambda(p) = c[0] + c[1] p + c[2] p^2 + ... in nm. Throws
+    // std::runtime_error, leaving the calibration unchanged, when the
+    // polynomial is not strictly monotonic or not positive over the sensor.
+    void setCoefficients(const std::vector<double>& coefficients);
+    const std::vector<double>& coefficients() const { return polynomial; }
+    bool isCalibrated() const { return !polynomial.empty(); }
+    void clear();
+
+    // Excitation wavelength in nm for Raman shift; 0 for none
+    void setLaserWavelength(double nanometres);
+    double laserWavelength() const { return laserNanometres; }
+
+    bool supports(SpectralUnit unit) const;
+
+    // Value of every pixel in `unit`, SpectrumFrame::PixelCount entries
+    const double* table(SpectralUnit unit) const;
+    double valueAt(int pixel, SpectralUnit unit) const;
+    // Fractional pixels are interpolated, and extrapolated past the ends
+    double valueAt(double pixel, SpectralUnit unit) const;
+    // Fractional pixel whose value is `value`, clamped to the sensor
+    double pixelAt(double value, SpectralUnit unit) const;
+    // True when values fall as the pixel index rises
+    bool isDescending(SpectralUnit unit) const;
+
+private:
+    using Table = std::array<double, SpectrumFrame::PixelCount>;
+
+    void rebuildRamanTable();
+    const Table& tableFor(SpectralUnit unit) const;
+
+    std::vector<double> polynomial;
+    double laserNanometres = 0.0;
+    Table pixelTable{};
+    Table wavelengthTable{};
+    Table ramanTable{};
+};
+
+// The calibration is kept in the head's device profile, a small text file
+// of "key values..." lines named after its serial number; keys this version
+// does not know are skipped, so the profile can grow. A missing profile
+// loads as uncalibrated. Both throw std::runtime_error on I/O or format
+// errors.
+std::filesystem::path deviceProfilePath(const std::filesystem::path& directory, const std::string& serialNumber);
+WavelengthCalibration loadWavelengthCalibration(const std::filesystem::path& path);
+void saveWavelengthCalibration(const std::filesystem::path& path, const std::string& serialNumber,
+                               const WavelengthCalibration& calibration);
+
+#endif // WAVELENGTHCALIBRATION_H